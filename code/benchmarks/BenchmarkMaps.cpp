@@ -0,0 +1,104 @@
+#include "BenchmarkMaps.hpp"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <utility>
+
+MapLayout GenerateMaze(std::size_t size, unsigned int seed, float loops_ratio) {
+    const auto cols = size | 1;
+    const auto rows = size | 1;
+    std::vector<std::uint8_t> tiles(cols * rows, 1);
+    std::mt19937 rng(seed);
+
+    std::vector<std::pair<std::size_t, std::size_t>> stack {{1, 1}};
+    tiles[cols + 1] = 0;
+    while (!stack.empty()) {
+        const auto [col, row] = stack.back();
+        std::array<std::pair<int, int>, 4> directions {{{2, 0}, {-2, 0}, {0, 2}, {0, -2}}};
+        std::shuffle(directions.begin(), directions.end(), rng);
+
+        bool did_carve = false;
+        for (const auto& [dx, dy] : directions) {
+            const auto next_col = static_cast<std::size_t>(static_cast<int>(col) + dx);
+            const auto next_row = static_cast<std::size_t>(static_cast<int>(row) + dy);
+            if (next_col == 0 || next_row == 0 || next_col >= cols - 1 || next_row >= rows - 1) continue;
+            if (tiles[next_row * cols + next_col] == 0) continue;
+
+            tiles[(row + next_row) / 2 * cols + (col + next_col) / 2] = 0;
+            tiles[next_row * cols + next_col] = 0;
+            stack.emplace_back(next_col, next_row);
+            did_carve = true;
+            break;
+        }
+        if (!did_carve) stack.pop_back();
+    }
+
+    std::bernoulli_distribution knock_down(loops_ratio);
+    for (std::size_t row = 1; row < rows - 1; ++row) {
+        for (std::size_t col = 1; col < cols - 1; ++col) {
+            auto& tile = tiles[row * cols + col];
+            const bool is_between_cells = ((row % 2) != (col % 2));
+            if (tile == 1 && is_between_cells && knock_down(rng)) tile = 0;
+        }
+    }
+
+    return MapLayout(cols, rows, std::move(tiles));
+}
+
+MapLayout GenerateRandomWalls(std::size_t size, unsigned int seed, float wall_density) {
+    std::vector<std::uint8_t> tiles(size * size, 0);
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution is_wall(wall_density);
+    for (auto& tile : tiles) tile = is_wall(rng) ? 1 : 0;
+    return MapLayout(size, size, std::move(tiles));
+}
+
+void SealPockets(MapLayout& layout, std::size_t pockets_count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> col_distribution(1, layout.cols_count - 2);
+    std::uniform_int_distribution<std::size_t> row_distribution(1, layout.rows_count - 2);
+    for (std::size_t sealed_count = 0, tries = 0; sealed_count < pockets_count && tries < pockets_count * 64; ++tries) {
+        const auto index = row_distribution(rng) * layout.cols_count + col_distribution(rng);
+        if (layout.tiles[index] != 0) continue;
+
+        for (const auto neighbour : {index - 1, index + 1, index - layout.cols_count, index + layout.cols_count}) {
+            layout.tiles[neighbour] = 1;
+        }
+        ++sealed_count;
+    }
+}
+
+double GetWallDensity(const MapLayout& layout) {
+    const auto walls_count = std::count(layout.tiles.begin(), layout.tiles.end(), 1);
+    return static_cast<double>(walls_count) / static_cast<double>(layout.tiles.size());
+}
+
+std::vector<Vec2<int>> GetWalkableCells(const GameMap& map) {
+    std::vector<Vec2<int>> walkable_cells;
+    for (std::size_t i = 0; i < map.GetCellsCount(); ++i) {
+        if (!map.IsWalkable(i)) continue;
+        const auto [row, col] = map.FromIndexToColRow(i);
+        walkable_cells.emplace_back(col, row);
+    }
+    return walkable_cells;
+}
+
+HeadlessRenderer::HeadlessRenderer()
+    : surface_(SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32))
+    , sdl_renderer_(surface_ ? SDL_CreateSoftwareRenderer(surface_) : nullptr) {
+    if (sdl_renderer_) renderer_.emplace(*sdl_renderer_);
+}
+
+HeadlessRenderer::~HeadlessRenderer() {
+    if (sdl_renderer_) SDL_DestroyRenderer(sdl_renderer_);
+    if (surface_) SDL_FreeSurface(surface_);
+}
+
+bool HeadlessRenderer::IsValid() const {
+    return renderer_.has_value();
+}
+
+Renderer& HeadlessRenderer::Get() {
+    return *renderer_;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "utils/Renderer.hpp"
+#include "utils/Vec2.hpp"
+
+#include "GameMap.hpp"
+#include "MapLayout.hpp"
+
+#include <optional>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+// Maps and helpers shared by the headless benchmarks.
+static const float kDefaultLoopsRatio = 0.1f;
+
+// Perfect maze carved on the odd cells, then a ratio of the remaining inner
+// walls knocked down so the maze has loops like the stock one.
+MapLayout GenerateMaze(std::size_t size, unsigned int seed, float loops_ratio = kDefaultLoopsRatio);
+// Open field where each cell is a wall with the given probability: no corridors,
+// and pockets the rest of the map can't reach once the density is high enough.
+MapLayout GenerateRandomWalls(std::size_t size, unsigned int seed, float wall_density);
+// Walls the four neighbours of random walkable cells, so even a perfect maze
+// gets cells the rest of it can't reach.
+void SealPockets(MapLayout& layout, std::size_t pockets_count, unsigned int seed);
+double GetWallDensity(const MapLayout& layout);
+
+std::vector<Vec2<int>> GetWalkableCells(const GameMap& map);
+
+// A software renderer over a 1x1 surface: GameMap needs a Renderer but nothing gets drawn.
+class HeadlessRenderer {
+public:
+    HeadlessRenderer();
+    ~HeadlessRenderer();
+    HeadlessRenderer(const HeadlessRenderer&) = delete;
+    HeadlessRenderer& operator=(const HeadlessRenderer&) = delete;
+
+    bool IsValid() const;
+    Renderer& Get();
+
+private:
+    SDL_Surface* surface_;
+    SDL_Renderer* sdl_renderer_;
+    std::optional<Renderer> renderer_;
+};
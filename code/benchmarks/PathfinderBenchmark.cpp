@@ -0,0 +1,1255 @@
+#include <SDL2/SDL.h>
+
+#include "utils/Renderer.hpp"
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/PathTable.hpp"
+#include "pathfinder/DistanceField.hpp"
+#include "pathfinder/CorridorGraph.hpp"
+#include "pathfinder/ReachabilityIndex.hpp"
+#include "pathfinder/IncrementalPlanner.hpp"
+#include "pathfinder/PathfindingScheduler.hpp"
+#include "pathfinder/BatchPathfinder.hpp"
+#include "pathfinder/BitboardFlood.hpp"
+#include "pathfinder/HierarchicalPathfinder.hpp"
+#include "pathfinder/PathCache.hpp"
+#include "pathfinder/CompressedPathDatabase.hpp"
+
+#include "BenchmarkMaps.hpp"
+
+#include "ChunkedMap.hpp"
+#include "CollectableSpawns.hpp"
+#include "Constants.hpp"
+#include "GameMap.hpp"
+#include "MapAsset.hpp"
+#include "MapFile.hpp"
+#include "MapGeometry.hpp"
+#include "MapLayout.hpp"
+#include "MazeGenerator.hpp"
+#include "StockMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Counts every allocation of the process, so the benchmarks can tell which
+// queries allocate. Every replaceable form goes through the same two functions,
+// so no allocation is missed and every pointer is freed the way it was allocated.
+namespace {
+std::atomic<std::size_t> allocations_count {0};
+
+void* CountAllocation(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    size = std::max<std::size_t>(size, 1);
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* CountAllocationOrThrow(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+    if (void* pointer = CountAllocation(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+}
+
+void* operator new(std::size_t size) { return CountAllocationOrThrow(size); }
+void* operator new[](std::size_t size) { return CountAllocationOrThrow(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountAllocationOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountAllocationOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return CountAllocation(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return CountAllocation(size); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountAllocation(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+// Headless micro-benchmark: measures Pathfinder::FindPath queries per second
+// over a fixed-seed set of (from, to) pairs between walkable cells, for each
+// open list and against the corridor graph and the path table, on the stock
+// maze and on generated mazes. The other sections time the rest of the
+// pathfinders and the map storage; PathfinderTests checks their results.
+namespace {
+static const std::size_t kQueriesCellsBudget = 4096 * 340;
+static const std::size_t kMinQueriesCount = 32;
+static const int kRepetitions = 5;
+static const unsigned int kSeed = 1234;
+static const std::size_t kToggledCellsCount = 64;
+static const std::size_t kReplanningGhostsCount = 4;
+static const int kReplanningTicks = 200;
+static const std::size_t kChasersCount = 256;
+static const int kChaseTicks = 20;
+static const std::size_t kScheduledGhostsCount = 16;
+static const int kScheduledTicks = 60;
+static const int kSchedulerBudgetMicroseconds = 1000;
+static const std::size_t kBatchQueriesCount = 256;
+static const std::size_t kFloodsCellsBudget = 1 << 24;
+static const int kCachedTicks = 240;
+static const int kCachedStepTicks = 4;
+static const std::size_t kNeighbourhoodQueriesCount = 1 << 22;
+static const std::size_t kCacheLineSize = 64;
+static const std::size_t kConversionsCount = 1 << 20;
+static const std::size_t kWalkersCount = 16;
+static const int kWalkTicks = 20000;
+// Pathfinder's search node per cell.
+static const std::size_t kPathfinderNodeBytes = 16;
+static const std::size_t kSharedMapInstancesCount = 256;
+static const std::array<std::pair<std::size_t, std::size_t>, 3> kGeneratedMazeSizes {{{kColsCount, kRowsCount}, {256, 256}, {4096, 4096}}};
+
+using Query = std::pair<Vec2<int>, Vec2<int>>;
+
+struct BenchmarkResult {
+    double seconds;
+    std::size_t path_cells_count;
+};
+
+std::vector<Query> GenerateQueries(const GameMap& map) {
+    const auto walkable_cells = GetWalkableCells(map);
+    const auto queries_count = std::max(kMinQueriesCount, kQueriesCellsBudget / map.GetCellsCount());
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<Query> queries;
+    queries.reserve(queries_count);
+    for (std::size_t i = 0; i < queries_count; ++i) {
+        queries.emplace_back(walkable_cells[distribution(rng)], walkable_cells[distribution(rng)]);
+    }
+    return queries;
+}
+
+template<typename Solver>
+BenchmarkResult RunQueries(Solver& solver, const std::vector<Query>& queries) {
+    BenchmarkResult result {0.0, 0};
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepetitions; ++i) {
+        for (const auto& [from, to] : queries) {
+            result.path_cells_count += solver.FindPath(from, to).size();
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+template<typename Solver>
+double GetAverageExpandedNodes(Solver& solver, const std::vector<Query>& queries) {
+    std::size_t expanded_nodes_count = 0;
+    for (const auto& [from, to] : queries) {
+        solver.FindPath(from, to);
+        expanded_nodes_count += solver.GetExpandedNodesCount();
+    }
+    return static_cast<double>(expanded_nodes_count) / static_cast<double>(queries.size());
+}
+
+// What derived data pays to learn which cells a toggle changed: reading the map's
+// journal, against diffing a walkability snapshot of the whole map as the
+// pathfinders used to.
+void RunMapJournalBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    std::printf("map journal (%zux%zu), %zu toggles\n", map.GetColumnsCount(), map.GetRowsCount(), kToggledCellsCount);
+
+    std::vector<std::uint8_t> walkable_snapshot(map.GetCellsCount());
+    for (std::size_t i = 0; i < walkable_snapshot.size(); ++i) walkable_snapshot[i] = map.IsWalkable(i);
+
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(map.GetColumnsCount()) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(map.GetRowsCount()) - 2);
+    std::vector<std::uint32_t> changed_cells;
+    std::vector<std::uint32_t> snapshot_cells;
+    double seconds_journal = 0.0;
+    double seconds_snapshot = 0.0;
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        const Vec2<int> col_row {cols(rng), rows(rng)};
+        const auto version = map.GetVersion();
+        map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+
+        auto start = std::chrono::steady_clock::now();
+        map.GetChangesSince(version, changed_cells);
+        seconds_journal += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        snapshot_cells.clear();
+        for (std::size_t cell = 0; cell < walkable_snapshot.size(); ++cell) {
+            const std::uint8_t is_walkable = map.IsWalkable(cell);
+            if (walkable_snapshot[cell] == is_walkable) continue;
+
+            walkable_snapshot[cell] = is_walkable;
+            snapshot_cells.push_back(static_cast<std::uint32_t>(cell));
+        }
+        seconds_snapshot += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::printf("  journal %.3f us/sync, snapshot diff %.3f us/sync, %zu KB journal\n",
+        seconds_journal * 1e6 / kToggledCellsCount, seconds_snapshot * 1e6 / kToggledCellsCount,
+        GameMap::kJournalCapacity * sizeof(std::uint32_t) / 1024);
+}
+
+// Toggles inner cells one at a time, each followed by an empty query so the
+// graph repairs itself, against building the whole graph again.
+void RunCorridorGraphRepairs(GameMap& map, CorridorGraph& corridor_graph, const std::vector<Query>& queries) {
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(map.GetColumnsCount()) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(map.GetRowsCount()) - 2);
+    std::vector<Vec2<int>> toggled_cells(kToggledCellsCount);
+    for (auto& col_row : toggled_cells) col_row = Vec2<int>{cols(rng), rows(rng)};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 2; ++i) {
+        for (const auto& col_row : toggled_cells) {
+            map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+            corridor_graph.FindPath(queries.front().first, queries.front().first);
+        }
+    }
+    const auto seconds_repair = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    corridor_graph.Build();
+    const auto seconds_build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("  corridor graph: %.3f us/toggle repaired, %.3f ms full build\n",
+        seconds_repair * 1e6 / (2 * kToggledCellsCount), seconds_build * 1e3);
+}
+
+void PrintResult(const char* solver_name, const BenchmarkResult& result, double queries_count) {
+    std::printf("  %-12s %10.0f queries/s %10.3f us/query (path cells: %zu)\n",
+        solver_name, queries_count / result.seconds, result.seconds * 1e6 / queries_count,
+        result.path_cells_count);
+}
+
+// Targets anywhere on the map, walls included, as the ghost patterns produce
+// them: searching for them directly against resolving them first.
+void RunAnyTargetsBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    const auto queries_count = std::max(kMinQueriesCount, kQueriesCellsBudget / map.GetCellsCount());
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::uniform_int_distribution<int> cols(0, static_cast<int>(map.GetColumnsCount()) - 1);
+    std::uniform_int_distribution<int> rows(0, static_cast<int>(map.GetRowsCount()) - 1);
+    std::vector<Query> queries;
+    for (std::size_t i = 0; i < queries_count; ++i) {
+        queries.emplace_back(walkable_cells[distribution(rng)], Vec2<int>{cols(rng), rows(rng)});
+    }
+
+    Pathfinder pathfinder(map);
+    const auto result_search = RunQueries(pathfinder, queries);
+
+    ReachabilityIndex reachability_index(map);
+    BenchmarkResult result_resolved {0.0, 0};
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepetitions; ++i) {
+        for (auto [from, to] : queries) {
+            if (reachability_index.ResolveTarget(from, to)) {
+                result_resolved.path_cells_count += pathfinder.FindPath(from, to).size();
+            } else {
+                ++result_resolved.path_cells_count;
+            }
+        }
+    }
+    result_resolved.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto total_queries_count = static_cast<double>(queries.size() * kRepetitions);
+    std::printf("any targets on %zux%zu, %zu queries x %d\n",
+        map.GetColumnsCount(), map.GetRowsCount(), queries.size(), kRepetitions);
+    PrintResult("search", result_search, total_queries_count);
+    PrintResult("resolved", result_resolved, total_queries_count);
+    std::printf("  saved floods: %zu (%zu snapped, %zu unreachable)\n",
+        reachability_index.GetSavedFloodsCount(), reachability_index.GetSnappedTargetsCount(),
+        reachability_index.GetUnreachableTargetsCount());
+}
+
+// A few ghosts one step each per tick after a target on a random walk, as
+// in the game: full replans against one incremental planner per ghost. The
+// ghosts move along the full replans so both solvers get the same queries.
+void RunReplanningBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<Vec2<int>> ghosts(kReplanningGhostsCount);
+    for (auto& ghost : ghosts) ghost = walkable_cells[distribution(rng)];
+    auto target = walkable_cells[distribution(rng)];
+
+    Pathfinder pathfinder(map);
+    std::vector<IncrementalPlanner> planners;
+    for (std::size_t i = 0; i < ghosts.size(); ++i) planners.emplace_back(map, pathfinder);
+
+    static const std::array<Vec2<int>, 4> kOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    std::size_t expanded_replans = 0;
+    std::size_t expanded_incremental = 0;
+    std::size_t reused_incremental = 0;
+    double seconds_replans = 0.0;
+    double seconds_incremental = 0.0;
+    Vec2<int> target_direction {0, 0};
+    for (int tick = 0; tick < kReplanningTicks; ++tick) {
+        std::vector<Vec2<int>> moves;
+        for (const auto& offset : kOffsets) {
+            if (map.AreColRowWalkable(target + offset) && offset != target_direction * -1) moves.push_back(offset);
+        }
+        if (moves.empty()) moves.push_back(target_direction * -1);
+        target_direction = moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(rng)];
+        target += target_direction;
+
+        for (std::size_t i = 0; i < ghosts.size(); ++i) {
+            auto start = std::chrono::steady_clock::now();
+            const auto path = pathfinder.FindPath(ghosts[i], target);
+            seconds_replans += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            expanded_replans += pathfinder.GetExpandedNodesCount();
+
+            start = std::chrono::steady_clock::now();
+            planners[i].FindPath(ghosts[i], target);
+            seconds_incremental += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            expanded_incremental += planners[i].GetExpandedNodesCount();
+            reused_incremental += planners[i].GetReusedNodesCount();
+
+            if (path.size() > 1) ghosts[i] = path[1];
+        }
+    }
+
+    std::printf("%zu ghosts replanning on %zux%zu, %d ticks\n",
+        kReplanningGhostsCount, map.GetColumnsCount(), map.GetRowsCount(), kReplanningTicks);
+    std::printf("  %-14s %10.1f expanded/tick %10.3f ms/tick\n", "full replans",
+        static_cast<double>(expanded_replans) / kReplanningTicks, seconds_replans * 1e3 / kReplanningTicks);
+    std::printf("  %-14s %10.1f expanded/tick %10.3f ms/tick (%.1f reused/tick)\n", "incremental",
+        static_cast<double>(expanded_incremental) / kReplanningTicks, seconds_incremental * 1e3 / kReplanningTicks,
+        static_cast<double>(reused_incremental) / kReplanningTicks);
+}
+
+// Many chasers one step each per tick, towards a target that moves every tick:
+// one A* per chaser against one shared distance field flood.
+void RunChasersBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<Vec2<int>> chasers(kChasersCount);
+    std::vector<Vec2<int>> targets(kChaseTicks);
+    for (auto& chaser : chasers) chaser = walkable_cells[distribution(rng)];
+    for (auto& target : targets) target = walkable_cells[distribution(rng)];
+
+    Pathfinder pathfinder(map);
+    std::size_t steps_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& target : targets) {
+        for (const auto& chaser : chasers) {
+            steps_count += pathfinder.FindPath(chaser, target).size() > 1;
+        }
+    }
+    const auto seconds_search = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DistanceField distance_field(map);
+    std::size_t field_steps_count = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& target : targets) {
+        distance_field.Update(target);
+        for (const auto& chaser : chasers) {
+            field_steps_count += distance_field.GetNextStep(chaser) != chaser;
+        }
+    }
+    const auto seconds_field = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%zu chasers on %zux%zu, %d ticks (steps: %zu / %zu)\n",
+        kChasersCount, map.GetColumnsCount(), map.GetRowsCount(), kChaseTicks, steps_count, field_steps_count);
+    std::printf("  %-14s %10.3f ms/tick\n", "A* per chaser", seconds_search * 1e3 / kChaseTicks);
+    std::printf("  %-14s %10.3f ms/tick\n", "distance field", seconds_field * 1e3 / kChaseTicks);
+}
+
+// Every ghost asks for a new random path as soon as its last one landed. Run
+// synchronously each tick pays for every search; the scheduler caps the tick
+// at its budget and spreads the searches over the next ticks.
+void RunSchedulerBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    auto random_cell = [&]() { return walkable_cells[distribution(rng)]; };
+
+    Pathfinder pathfinder(map);
+    double seconds_sync = 0.0;
+    double max_seconds_sync = 0.0;
+    for (int tick = 0; tick < kScheduledTicks; ++tick) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < kScheduledGhostsCount; ++i) {
+            pathfinder.FindPath(random_cell(), random_cell());
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        seconds_sync += seconds;
+        max_seconds_sync = std::max(max_seconds_sync, seconds);
+    }
+
+    PathfindingScheduler scheduler(map, std::chrono::microseconds{kSchedulerBudgetMicroseconds});
+    std::vector<std::uint32_t> requesters;
+    for (std::size_t i = 0; i < kScheduledGhostsCount; ++i) requesters.push_back(scheduler.AddRequester());
+    double seconds_scheduled = 0.0;
+    double max_seconds_scheduled = 0.0;
+    Pathfinder::Path path;
+    for (int tick = 0; tick < kScheduledTicks; ++tick) {
+        const auto start = std::chrono::steady_clock::now();
+        scheduler.Update();
+        for (const auto requester : requesters) {
+            scheduler.TakeResult(requester, path);
+            if (!scheduler.IsPending(requester)) scheduler.Request(requester, random_cell(), random_cell());
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        seconds_scheduled += seconds;
+        max_seconds_scheduled = std::max(max_seconds_scheduled, seconds);
+    }
+
+    std::printf("%zu ghosts searching on %zux%zu, %d ticks, %d us budget\n",
+        kScheduledGhostsCount, map.GetColumnsCount(), map.GetRowsCount(), kScheduledTicks, kSchedulerBudgetMicroseconds);
+    std::printf("  %-14s %10.3f ms/tick %10.3f ms worst tick\n", "synchronous",
+        seconds_sync * 1e3 / kScheduledTicks, max_seconds_sync * 1e3);
+    std::printf("  %-14s %10.3f ms/tick %10.3f ms worst tick (%zu done, latency %.1f avg %llu max ticks, queue %zu max)\n",
+        "scheduled", seconds_scheduled * 1e3 / kScheduledTicks, max_seconds_scheduled * 1e3,
+        scheduler.GetCompletedRequestsCount(), scheduler.GetAverageLatencyTicks(),
+        static_cast<unsigned long long>(scheduler.GetMaxLatencyTicks()), scheduler.GetMaxQueueDepth());
+}
+
+// One batch of queries solved one by one and on pools of workers.
+void RunBatchBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<BatchPathfinder::Query> queries(kBatchQueriesCount);
+    for (auto& query : queries) query = {walkable_cells[distribution(rng)], walkable_cells[distribution(rng)]};
+
+    Pathfinder pathfinder(map);
+    std::vector<IPathfinder::Path> sequential_paths;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& [from, to] : queries) sequential_paths.push_back(pathfinder.FindPath(from, to));
+    const auto seconds_sequential = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%zu queries batched on %zux%zu (%u hardware threads)\n",
+        kBatchQueriesCount, map.GetColumnsCount(), map.GetRowsCount(), std::thread::hardware_concurrency());
+    std::printf("  %-14s %10.3f ms\n", "sequential", seconds_sequential * 1e3);
+    for (const std::size_t workers_count : {1, 2, 4, 8}) {
+        BatchPathfinder batch_pathfinder(map, workers_count);
+        std::vector<IPathfinder::Path> paths;
+        start = std::chrono::steady_clock::now();
+        batch_pathfinder.FindPaths(queries, paths);
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("  %2zu workers     %10.3f ms %6.2fx\n", workers_count, seconds * 1e3, seconds_sequential / seconds);
+    }
+}
+
+// Full floods from random targets, queue based and bitboard based.
+void RunFloodBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    const auto floods_count = std::max<std::size_t>(4, kFloodsCellsBudget / map.GetCellsCount());
+
+    DistanceField scalar_field(map, DistanceField::EFlood::SCALAR);
+    BitboardFlood bitboard_flood(map);
+    std::vector<std::uint32_t> distances;
+    bitboard_flood.Flood(walkable_cells.front(), distances);
+    double seconds_scalar = 0.0;
+    double seconds_bitboard = 0.0;
+    std::size_t levels = 0;
+    std::size_t dense_levels = 0;
+    for (std::size_t i = 0; i < floods_count; ++i) {
+        const auto target = walkable_cells[distribution(rng)];
+        auto start = std::chrono::steady_clock::now();
+        scalar_field.Update(target);
+        seconds_scalar += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        bitboard_flood.Flood(target, distances);
+        seconds_bitboard += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        levels += bitboard_flood.GetLevelsCount();
+        dense_levels += bitboard_flood.GetDenseLevelsCount();
+    }
+
+    std::printf("%zu floods on %zux%zu (%s)\n", floods_count, map.GetColumnsCount(), map.GetRowsCount(),
+#if defined(__AVX2__)
+        "avx2");
+#else
+        "scalar words");
+#endif
+    std::printf("  %-14s %10.3f ms/flood\n", "queue", seconds_scalar * 1e3 / floods_count);
+    std::printf("  %-14s %10.3f ms/flood %6.2fx (%.0f levels, %.0f dense)\n", "bitboard",
+        seconds_bitboard * 1e3 / floods_count, seconds_scalar / seconds_bitboard,
+        static_cast<double>(levels) / floods_count, static_cast<double>(dense_levels) / floods_count);
+}
+
+// HPA* refining only the first segments, as ghosts use it, and refining whole
+// paths to measure how far they are from the shortest ones. Then cells are
+// toggled and each repair is timed.
+void RunHierarchicalBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    const auto queries_count = static_cast<double>(queries.size() * kRepetitions);
+    std::printf("hierarchical (%zux%zu), %zu queries x %d\n",
+        map.GetColumnsCount(), map.GetRowsCount(), queries.size(), kRepetitions);
+
+    Pathfinder pathfinder(map);
+    HierarchicalPathfinder hierarchical(map, pathfinder);
+    hierarchical.Build();
+    PrintResult("grid A*", RunQueries(pathfinder, queries), queries_count);
+    PrintResult("HPA* lazy", RunQueries(hierarchical, queries), queries_count);
+    hierarchical.SetRefinedSegmentsCount(0);
+    PrintResult("HPA* full", RunQueries(hierarchical, queries), queries_count);
+
+    std::size_t grid_cells = 0;
+    std::size_t hierarchical_cells = 0;
+    for (const auto& [from, to] : queries) {
+        grid_cells += pathfinder.FindPath(from, to).size();
+        hierarchical_cells += hierarchical.FindPath(from, to).size();
+    }
+    std::printf("  %zu clusters, %zu nodes, %.2f%% longer than the shortest paths\n",
+        hierarchical.GetClustersCount(), hierarchical.GetNodesCount(),
+        100.0 * (static_cast<double>(hierarchical_cells) / static_cast<double>(grid_cells) - 1.0));
+
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(map.GetColumnsCount()) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(map.GetRowsCount()) - 2);
+    std::size_t rebuilt_clusters = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        const Vec2<int> col_row {cols(rng), rows(rng)};
+        map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+        hierarchical.FindPath(queries.front().first, queries.front().first);
+        rebuilt_clusters += hierarchical.GetRebuiltClustersCount();
+    }
+    const auto seconds_repair = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("  %.3f us/toggle repaired (%.1f clusters)\n",
+        seconds_repair * 1e6 / kToggledCellsCount, static_cast<double>(rebuilt_clusters) / kToggledCellsCount);
+}
+
+// Four ghosts asking every tick while they only move every few ticks: two chase
+// the same moving target and two head to fixed cells, as chasing and scattering
+// ghosts do. Each capacity replays the same ticks.
+void RunPathCacheBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::array<Vec2<int>, 4> first_ghosts;
+    for (auto& ghost : first_ghosts) ghost = walkable_cells[distribution(rng)];
+    const std::array<Vec2<int>, 2> fixed_targets {walkable_cells[distribution(rng)], walkable_cells[distribution(rng)]};
+    std::vector<Vec2<int>> player_cells {walkable_cells[distribution(rng)]};
+    static const std::array<Vec2<int>, 4> kOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    for (int step = 0; step < kCachedTicks / kCachedStepTicks; ++step) {
+        auto player = player_cells.back();
+        for (const auto& offset : kOffsets) {
+            if (map.AreColRowWalkable(player + offset) &&
+                (player_cells.size() < 2 || player + offset != player_cells[player_cells.size() - 2])) {
+                player += offset;
+                break;
+            }
+        }
+        player_cells.push_back(player);
+    }
+
+    Pathfinder pathfinder(map);
+    std::printf("Path cache on %zux%zu, %zu ghosts, %d ticks\n",
+        map.GetColumnsCount(), map.GetRowsCount(), first_ghosts.size(), kCachedTicks);
+    for (const std::size_t capacity : {0, 4, 16, 64}) {
+        PathCache path_cache(map, pathfinder, capacity);
+        auto ghosts = first_ghosts;
+        IPathfinder::Path path;
+        std::size_t path_cells_count = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < kCachedTicks; ++tick) {
+            const auto player = player_cells[static_cast<std::size_t>(tick / kCachedStepTicks)];
+            for (std::size_t i = 0; i < ghosts.size(); ++i) {
+                const auto target = (i < 2) ? player : fixed_targets[i - 2];
+                path_cache.FindPath(ghosts[i], target, path);
+                path_cells_count += path.size();
+                if ((tick + static_cast<int>(i)) % kCachedStepTicks == 0 && path.size() > 1) ghosts[i] = path[1];
+            }
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto queries_count = path_cache.GetHitsCount() + path_cache.GetMissesCount();
+        std::printf("  capacity %-5zu %6.1f%% hits %10.3f ms/tick (path cells: %zu)\n", capacity,
+            queries_count ? 100.0 * static_cast<double>(path_cache.GetHitsCount()) / static_cast<double>(queries_count) : 0.0,
+            seconds * 1e3 / kCachedTicks, path_cells_count);
+    }
+}
+
+// Allocations per query once every solver is warm, returning a fresh path
+// against writing into one buffer kept by the caller.
+void RunAllocationsBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    Pathfinder pathfinder(map);
+    CorridorGraph corridor_graph(map, pathfinder);
+    HierarchicalPathfinder hierarchical(map, pathfinder);
+    hierarchical.Build();
+    IncrementalPlanner planner(map, pathfinder);
+
+    std::printf("Allocations per query on %zux%zu (%zu queries)\n",
+        map.GetColumnsCount(), map.GetRowsCount(), queries.size());
+    const auto run = [&queries](const char* name, IPathfinder& solver) {
+        IPathfinder::Path path;
+        for (const auto& [from, to] : queries) solver.FindPath(from, to, path);
+
+        auto first_count = allocations_count.load();
+        for (const auto& [from, to] : queries) solver.FindPath(from, to);
+        const auto returned_allocations = allocations_count.load() - first_count;
+
+        first_count = allocations_count.load();
+        for (const auto& [from, to] : queries) solver.FindPath(from, to, path);
+        const auto reused_allocations = allocations_count.load() - first_count;
+
+        std::printf("  %-14s returned %6.2f   reused %6.2f\n", name,
+            static_cast<double>(returned_allocations) / queries.size(),
+            static_cast<double>(reused_allocations) / queries.size());
+    };
+    run("A*", pathfinder);
+    run("corridor graph", corridor_graph);
+    run("hierarchical", hierarchical);
+    run("incremental", planner);
+}
+
+// Builds the path database, saves it and maps it back, then answers first moves
+// and whole paths from the mapped file, and how often a first move is the very
+// step Pathfinder takes.
+void RunPathDatabaseBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    const auto queries_count = static_cast<double>(queries.size() * kRepetitions);
+    const auto file_path = (std::filesystem::temp_directory_path() /
+        ("pathfinder-benchmark-" + std::to_string(map.GetColumnsCount()) + ".cpd")).string();
+    std::printf("path database (%zux%zu), %zu queries x %d\n",
+        map.GetColumnsCount(), map.GetRowsCount(), queries.size(), kRepetitions);
+
+    Pathfinder pathfinder(map);
+    CompressedPathDatabase database(map, pathfinder);
+    const auto workers_count = std::max(1u, std::thread::hardware_concurrency());
+    database.Build(workers_count);
+    const auto walkable_cells_count = GetWalkableCells(map).size();
+    std::printf("  built in %.3f s on %u workers: %zu runs (%.1f per source), %.1f KB on disk, all pairs table %.1f KB\n",
+        database.GetBuildSeconds(), workers_count, database.GetRunsCount(),
+        static_cast<double>(database.GetRunsCount()) / walkable_cells_count,
+        database.GetFileSize() / 1024.0, map.GetCellsCount() * map.GetCellsCount() * 3 / 1024.0);
+
+    database.Save(file_path);
+    const auto start_load = std::chrono::steady_clock::now();
+    const bool is_loaded = database.Load(file_path);
+    const auto seconds_load = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_load).count();
+    std::printf("  mapped in %.3f ms%s\n", seconds_load * 1e3, is_loaded ? "" : " (load failed)");
+
+    std::size_t moves_count = 0;
+    const auto start_moves = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepetitions; ++i) {
+        for (const auto& [from, to] : queries) {
+            moves_count += (database.GetFirstMove(from, to) != CompressedPathDatabase::EMove::NONE);
+        }
+    }
+    const auto seconds_moves = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_moves).count();
+    std::printf("  %-14s %10.3f us/query (%zu moves)\n", "first move", seconds_moves * 1e6 / queries_count, moves_count);
+    PrintResult("A*", RunQueries(pathfinder, queries), queries_count);
+    PrintResult("database", RunQueries(database, queries), queries_count);
+
+    static const std::array<Vec2<int>, 4> kMoveOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    std::size_t same_first_steps = 0;
+    std::size_t first_steps = 0;
+    for (const auto& [from, to] : queries) {
+        const auto path = pathfinder.FindPath(from, to);
+        const auto move = database.GetFirstMove(from, to);
+        if (path.size() < 2 || move == CompressedPathDatabase::EMove::NONE) continue;
+
+        ++first_steps;
+        if (from + kMoveOffsets[static_cast<std::size_t>(move)] == path[1]) ++same_first_steps;
+    }
+    std::printf("  first steps: %.1f%% the Pathfinder one\n",
+        first_steps ? 100.0 * static_cast<double>(same_first_steps) / static_cast<double>(first_steps) : 0.0);
+    std::filesystem::remove(file_path);
+}
+
+// Loads the same map from its text and from its compiled file: parsing grows with
+// the cells, mapping doesn't. Building the GameMap from the view is timed apart.
+void RunMapFileBenchmark(Renderer& renderer, const MapLayout& layout) {
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto name = "pathfinder-benchmark-" + std::to_string(layout.cols_count);
+    const auto text_file_path = (directory / (name + ".map")).string();
+    const auto binary_file_path = MapFile::GetBinaryFilePath(text_file_path);
+    MapFile::SaveText(layout, text_file_path);
+    MapFile::SaveBinary(layout, binary_file_path);
+    std::printf("map files (%zux%zu), text %.1f KB, binary %.1f KB\n", layout.cols_count, layout.rows_count,
+        std::filesystem::file_size(text_file_path) / 1024.0, std::filesystem::file_size(binary_file_path) / 1024.0);
+
+    MapFile map_file;
+    for (const auto& file_path : {text_file_path, binary_file_path}) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRepetitions; ++i) map_file.Load(file_path);
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("  %-14s %10.3f ms/load\n", (file_path == text_file_path) ? "text" : "binary", seconds * 1e3 / kRepetitions);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, map_file.GetView());
+    const auto seconds_map = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %-14s %10.3f ms\n", "GameMap init", seconds_map * 1e3);
+
+    map_file.Load(MapLayout::CreateDefault());
+    std::filesystem::remove(text_file_path);
+    std::filesystem::remove(binary_file_path);
+}
+
+// The cell array GameMap used to store, one struct per cell.
+struct ArrayCell {
+    std::size_t cell_index;
+    Vec2<float> position;
+    Vec2<float> center;
+    std::size_t row;
+    std::size_t col;
+    bool is_walkable;
+};
+
+// Walkability of a cell and its four neighbours at random cells, against the old
+// cell array. Cache lines are counted per neighbourhood from the addresses each
+// layout reads, as a cache miss estimate that doesn't need hardware counters.
+void RunMapStorageBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    std::vector<ArrayCell> array_cells;
+    array_cells.reserve(map.GetCellsCount());
+    for (const auto& cell : map.GetCells()) {
+        array_cells.push_back({cell.cell_index, cell.position, cell.center, cell.row, cell.col, cell.is_walkable});
+    }
+
+    const auto cols_count = static_cast<int>(map.GetColumnsCount());
+    const auto rows_count = static_cast<int>(map.GetRowsCount());
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, cols_count - 2);
+    std::uniform_int_distribution<int> rows(1, rows_count - 2);
+    std::vector<Vec2<int>> cells(kNeighbourhoodQueriesCount);
+    for (auto& col_row : cells) col_row = {cols(rng), rows(rng)};
+
+    static const std::array<Vec2<int>, 5> kNeighbourhood {
+        Vec2<int>{0, 0}, Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    const auto run = [&cells](const auto& is_walkable) {
+        std::size_t walkable_count = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto col_row : cells) {
+            for (const auto offset : kNeighbourhood) walkable_count += is_walkable(col_row + offset);
+        }
+        return std::make_pair(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), walkable_count);
+    };
+    const auto [seconds_array, walkable_array] = run([&](Vec2<int> col_row) {
+        return array_cells[col_row.y * cols_count + col_row.x].is_walkable;
+    });
+    const auto [seconds_bitset, walkable_bitset] = run([&](Vec2<int> col_row) {
+        return map.AreColRowWalkable(col_row);
+    });
+
+    // 8x8 blocks of 8 bytes, row of blocks after row of blocks.
+    const auto blocks_per_row = (map.GetColumnsCount() + 7) / 8;
+    std::size_t array_lines = 0;
+    std::size_t bitset_lines = 0;
+    for (const auto col_row : cells) {
+        std::array<std::size_t, 5> array_addresses;
+        std::array<std::size_t, 5> bitset_addresses;
+        for (std::size_t i = 0; i < kNeighbourhood.size(); ++i) {
+            const auto [col, row] = col_row + kNeighbourhood[i];
+            array_addresses[i] = ((row * cols_count + col) * sizeof(ArrayCell) + offsetof(ArrayCell, is_walkable)) / kCacheLineSize;
+            bitset_addresses[i] = ((row / 8) * blocks_per_row + col / 8) * sizeof(std::uint64_t) / kCacheLineSize;
+        }
+        for (auto* addresses : {&array_addresses, &bitset_addresses}) {
+            std::sort(addresses->begin(), addresses->end());
+            const auto lines = static_cast<std::size_t>(std::unique(addresses->begin(), addresses->end()) - addresses->begin());
+            (addresses == &array_addresses ? array_lines : bitset_lines) += lines;
+        }
+    }
+
+    const auto queries_count = static_cast<double>(cells.size());
+    std::printf("map storage (%zux%zu), %zu neighbourhoods (walkable: %zu / %zu)\n", map.GetColumnsCount(), map.GetRowsCount(),
+        cells.size(), walkable_array, walkable_bitset);
+    std::printf("  %-14s %10.1f KB %6.2f bytes/cell %8.2f ns/neighbourhood %5.2f lines/neighbourhood\n", "cell array",
+        array_cells.capacity() * sizeof(ArrayCell) / 1024.0, static_cast<double>(sizeof(ArrayCell)),
+        seconds_array * 1e9 / queries_count, static_cast<double>(array_lines) / queries_count);
+    std::printf("  %-14s %10.1f KB %6.2f bytes/cell %8.2f ns/neighbourhood %5.2f lines/neighbourhood\n", "block bitset",
+        map.GetMemoryUsage() / 1024.0, static_cast<double>(map.GetMemoryUsage()) / map.GetCellsCount(),
+        seconds_bitset * 1e9 / queries_count, static_cast<double>(bitset_lines) / queries_count);
+}
+
+// Index and pixel conversions at random cells: division by the runtime columns
+// count and cell size, the runtime geometry, and on the stock maze the compile-time
+// one.
+void RunMapGeometryBenchmark(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto& geometry = map.GetGeometry();
+    const auto cols_count = map.GetColumnsCount();
+    const auto cell_size_int = map.GetCellSizeInt();
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> indices(0, map.GetCellsCount() - 1);
+    std::vector<std::size_t> cells(kConversionsCount);
+    for (auto& index : cells) index = indices(rng);
+
+    const auto run = [&cells, cell_size_int](const auto& from_index, const auto& from_pixels) {
+        std::size_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRepetitions; ++i) {
+            for (const auto index : cells) {
+                const auto [row, col] = from_index(index);
+                const auto pixels = Vec2{col * cell_size_int + i, row * cell_size_int + i};
+                const auto col_row = from_pixels(pixels);
+                checksum += static_cast<std::size_t>(col_row.x * 3 + col_row.y);
+            }
+        }
+        return std::make_pair(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), checksum);
+    };
+    const auto conversions_count = static_cast<double>(cells.size() * kRepetitions);
+    const auto print = [conversions_count](const char* name, const std::pair<double, std::size_t>& result) {
+        std::printf("  %-14s %8.2f ns/conversion (checksum %zu)\n", name, result.first * 1e9 / conversions_count, result.second);
+    };
+
+    std::printf("map geometry (%zux%zu), %zu conversions x %d\n", map.GetColumnsCount(), map.GetRowsCount(), cells.size(), kRepetitions);
+    print("division", run(
+        [cols_count](std::size_t index) { return Vec2{static_cast<int>(index / cols_count), static_cast<int>(index % cols_count)}; },
+        [cell_size_int](Vec2<int> pixels) { return Vec2{pixels.x / cell_size_int, pixels.y / cell_size_int}; }));
+    print("runtime", run(
+        [&geometry](std::size_t index) { return geometry.FromIndexToColRow(index); },
+        [&geometry](Vec2<int> pixels) { return geometry.FromPixelsToColRow(pixels); }));
+
+    if (map.GetColumnsCount() != kColsCount || map.GetRowsCount() != kRowsCount) return;
+
+    print("compile time", run(
+        [](std::size_t index) { return StockMapGeometry::FromIndexToColRow(index); },
+        [](Vec2<int> pixels) { return StockMapGeometry::FromPixelsToColRow(pixels); }));
+}
+
+// Generated Pac-Man mazes at the stock size and up, straight into a GameMap and
+// the collectables CollectableManager would spawn.
+void RunMazeGeneratorBenchmark(Renderer& renderer, std::size_t cols_count, std::size_t rows_count) {
+    auto start = std::chrono::steady_clock::now();
+    const auto maze = MazeGenerator(cols_count, rows_count, kSeed).Generate();
+    const auto seconds_generate = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, maze.layout);
+    map.SetHouseDoor(maze.house_door_col_row);
+    const auto seconds_map = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t spawns_count = 0;
+    std::size_t power_pellets_count = 0;
+    ForEachCollectableSpawn(map.GetGeometry(), maze.layout.collectables, [&](const CollectableSpawn& spawn) {
+        ++spawns_count;
+        power_pellets_count += (spawn.type == 2);
+    });
+
+    std::printf("generated maze (%zux%zu), walls %.1f%%, %zu spawns (%zu power pellets), door %d,%d\n",
+        cols_count, rows_count, GetWallDensity(maze.layout) * 100.0, spawns_count, power_pellets_count,
+        maze.house_door_col_row.x, maze.house_door_col_row.y);
+    std::printf("  %-14s %10.3f ms\n", "generate", seconds_generate * 1e3);
+    std::printf("  %-14s %10.3f ms\n", "GameMap init", seconds_map * 1e3);
+}
+
+// Peak resident memory since the last reset, from /proc on Linux. 0 elsewhere.
+std::size_t GetPeakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+// Restarts the peak from the current resident memory, on Linux 4.0 and later.
+bool ResetPeakResidentBytes() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    return static_cast<bool>(clear_refs);
+}
+
+// Walkers wandering a chunked map, which keeps the chunks around them resident.
+// Maps small enough to also load dense run A* over both first. The memory figures
+// are the map's and the walkers' only: no pathfinder runs on the big map, since
+// their per-cell arrays aren't chunked.
+void RunChunkedMapBenchmark(Renderer& renderer, std::size_t size) {
+    const auto file_path = (std::filesystem::temp_directory_path() / ("pathfinder-benchmark-" + std::to_string(size) + ".pchunks")).string();
+    {
+        const auto maze = MazeGenerator(size, size, kSeed).Generate();
+        if (!ChunkedMap::Save(maze.layout, file_path)) return;
+
+        if (size <= 1024) {
+            GameMap dense_map(renderer, Vec2{0.f, 0.f}, kCellSize, maze.layout);
+            GameMap chunked_map(renderer, Vec2{0.f, 0.f}, kCellSize, MapLayout::CreateDefault());
+            if (!chunked_map.InitChunked(file_path)) return;
+
+            const auto queries = GenerateQueries(dense_map);
+            Pathfinder dense_pathfinder(dense_map);
+            Pathfinder chunked_pathfinder(chunked_map);
+            const auto dense_result = RunQueries(dense_pathfinder, queries);
+            const auto chunked_result = RunQueries(chunked_pathfinder, queries);
+            std::printf("chunked map (%zux%zu), %zu queries x %d\n", size, size, queries.size(), kRepetitions);
+            const auto queries_count = static_cast<double>(queries.size() * kRepetitions);
+            PrintResult("A* dense", dense_result, queries_count);
+            PrintResult("A* chunked", chunked_result, queries_count);
+        }
+    }
+
+    // Only what the chunked map costs from here: the maze and its layout are gone.
+    const auto resident_bytes_before = GetPeakResidentBytes();
+    const bool is_peak_reset = ResetPeakResidentBytes();
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, MapLayout::CreateDefault());
+    if (!map.InitChunked(file_path)) return;
+    const auto* chunked_map = map.GetChunkedMap();
+
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cells(0, static_cast<int>(size) - 1);
+    std::vector<Vec2<int>> walkers;
+    std::vector<std::uint8_t> walker_directions;
+    while (walkers.size() < kWalkersCount) {
+        const Vec2<int> col_row {cells(rng), cells(rng)};
+        if (map.GetEntityExits(col_row) == 0) continue;
+        walkers.push_back(col_row);
+        walker_directions.push_back(0);
+    }
+
+    // Straight on when they can, otherwise a random turn, never back.
+    static const std::array<Vec2<int>, 4> kOffsets {Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    static const std::array<std::uint8_t, 4> kReverse {1, 0, 3, 2};
+    std::size_t resident_chunks_peak = 0;
+    std::size_t memory_peak = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < kWalkTicks; ++tick) {
+        map.UpdateResidency(walkers);
+        resident_chunks_peak = std::max(resident_chunks_peak, chunked_map->GetResidentChunksCount());
+        memory_peak = std::max(memory_peak, map.GetMemoryUsage());
+        for (std::size_t walker = 0; walker < walkers.size(); ++walker) {
+            auto exits = map.GetEntityExits(walkers[walker]);
+            const auto direction = walker_directions[walker];
+            if (exits & ~(1 << kReverse[direction])) exits &= ~(1 << kReverse[direction]);
+            if (!(exits & (1 << direction))) {
+                std::array<std::uint8_t, 4> choices;
+                std::size_t choices_count = 0;
+                for (std::uint8_t choice = 0; choice < 4; ++choice) {
+                    if (exits & (1 << choice)) choices[choices_count++] = choice;
+                }
+                if (choices_count == 0) continue;
+                walker_directions[walker] = choices[rng() % choices_count];
+            }
+            walkers[walker] += kOffsets[walker_directions[walker]];
+        }
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto peak_resident_bytes = GetPeakResidentBytes();
+
+    const auto cells_count = static_cast<double>(size) * static_cast<double>(size);
+    std::printf("chunked map (%zux%zu), %zu chunks of %zux%zu, file %.1f MB\n", size, size,
+        chunked_map->GetChunksCount(), ChunkedMap::kChunkSize, ChunkedMap::kChunkSize, chunked_map->GetFileSize() / 1048576.0);
+    std::printf("  %-14s %10.1f MB\n", "cell array", cells_count * sizeof(ArrayCell) / 1048576.0);
+    std::printf("  %-14s %10.1f MB\n", "dense GameMap", cells_count * (1.0 + 1.0 / 8.0) / 1048576.0);
+    std::printf("  %-14s %10.1f MB heap peak, %zu resident chunks peak\n", "chunked map", memory_peak / 1048576.0, resident_chunks_peak);
+    std::printf("  %-14s %10.1f MB, not chunked\n", "A* nodes", cells_count * kPathfinderNodeBytes / 1048576.0);
+    std::printf("  %zu walkers x %d ticks: %.2f us/tick\n", kWalkersCount, kWalkTicks, seconds * 1e6 / kWalkTicks);
+    if (is_peak_reset && peak_resident_bytes > 0) {
+        std::printf("  peak RSS %.1f MB while walking, without pathfinders (%.1f MB before, while generating)\n",
+            peak_resident_bytes / 1048576.0, resident_bytes_before / 1048576.0);
+    } else {
+        std::printf("  peak RSS not available on this system\n");
+    }
+    std::filesystem::remove(file_path);
+}
+
+// Heap in use, from glibc's allocator. 0 elsewhere.
+std::size_t GetHeapBytes() {
+#if defined(__GLIBC__)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// The map state of a game instance, as GameScene holds it.
+struct MapInstance {
+    GameMap map;
+    Pathfinder pathfinder;
+    CorridorGraph corridor_graph;
+    PathTable path_table;
+
+    MapInstance(Renderer& renderer, std::shared_ptr<const MapAsset> asset, std::shared_ptr<const PathTable::Rows> rows)
+        : map(renderer, Vec2{0.f, 0.f}, std::move(asset))
+        , pathfinder(map)
+        , corridor_graph(map, pathfinder)
+        , path_table(map, corridor_graph, kPathTableMaxCellsCount, std::move(rows)) {}
+};
+
+// Game instances playing the same maze in one process, each with its own asset and
+// path table, and then sharing them. The collected spawns bitset is the rest of a
+// game's map state. Toggles on a shared instance make it own its cells.
+void RunSharedMapBenchmark(Renderer& renderer, const MapLayout& layout) {
+    std::printf("shared map (%zux%zu), %zu instances\n", layout.cols_count, layout.rows_count, kSharedMapInstancesCount);
+    if (GetHeapBytes() == 0) {
+        std::printf("  heap usage not available on this system\n");
+        return;
+    }
+
+    std::shared_ptr<const MapAsset> shared_asset;
+    std::vector<std::unique_ptr<MapInstance>> instances;
+    for (const bool is_shared : {false, true}) {
+        shared_asset.reset();
+        const auto heap_bytes_before = GetHeapBytes();
+        const auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<const PathTable::Rows> shared_rows;
+        for (std::size_t i = 0; i < kSharedMapInstancesCount; ++i) {
+            if (!is_shared || !shared_asset) shared_asset = MapAsset::Create(layout, kCellSize);
+            instances.push_back(std::make_unique<MapInstance>(renderer, shared_asset, shared_rows));
+            if (is_shared && !shared_rows) shared_rows = instances.back()->path_table.ShareRows();
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto heap_bytes = GetHeapBytes() - heap_bytes_before;
+        std::printf("  %-8s %10.1f KB/instance, %8.3f ms/instance (map %zu B, path table %zu KB own)\n",
+            is_shared ? "shared" : "own", heap_bytes / 1024.0 / kSharedMapInstancesCount, seconds * 1e3 / kSharedMapInstancesCount,
+            instances.back()->map.GetOwnedMemoryUsage(), instances.back()->path_table.GetMemoryUsage() / 1024);
+        if (!is_shared) instances.clear();
+    }
+
+    const auto spawns_count = shared_asset->GetCollectableSpawns().size();
+    std::printf("  asset %.1f KB shared, collected spawns %zu B/instance for %zu spawns\n",
+        shared_asset->GetMemoryUsage() / 1024.0, (spawns_count + 63) / 64 * sizeof(std::uint64_t), spawns_count);
+
+    auto& changed = *instances.front();
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(changed.map.GetColumnsCount()) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(changed.map.GetRowsCount()) - 2);
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        const Vec2<int> col_row {cols(rng), rows(rng)};
+        changed.map.SetIsWalkable(col_row, !changed.map.AreColRowWalkable(col_row));
+    }
+    std::printf("  %zu toggles on one instance: %zu B owned after\n", kToggledCellsCount, changed.map.GetOwnedMemoryUsage());
+}
+
+void RunBenchmark(Renderer& renderer, const std::string& name, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    const auto queries_count = static_cast<double>(queries.size() * kRepetitions);
+
+    std::printf("%s (%zux%zu), %zu queries x %d\n",
+        name.c_str(), map.GetColumnsCount(), map.GetRowsCount(), queries.size(), kRepetitions);
+
+    const std::array<std::pair<const char*, Pathfinder::EOpenList>, 2> open_lists {{
+        {"binary heap", Pathfinder::EOpenList::BINARY_HEAP},
+        {"bucket queue", Pathfinder::EOpenList::BUCKET_QUEUE}}};
+    for (const auto& [open_list_name, open_list] : open_lists) {
+        Pathfinder pathfinder(map, open_list);
+        PrintResult(open_list_name, RunQueries(pathfinder, queries), queries_count);
+    }
+
+    Pathfinder pathfinder(map);
+    CorridorGraph corridor_graph(map, pathfinder);
+    PrintResult("corridors", RunQueries(corridor_graph, queries), queries_count);
+    std::printf("  expanded nodes/query: grid %.1f, corridors %.1f (%zu junctions, %zu segments)\n",
+        GetAverageExpandedNodes(pathfinder, queries), GetAverageExpandedNodes(corridor_graph, queries),
+        corridor_graph.GetJunctionsCount(), corridor_graph.GetSegmentsCount());
+
+    PathTable path_table(map, pathfinder, kPathTableMaxCellsCount);
+    if (path_table.IsEnabled()) {
+        PrintResult("path table", RunQueries(path_table, queries), queries_count);
+        std::printf("  path table memory: %zu KB\n", path_table.GetMemoryUsage() / 1024);
+    }
+
+    RunCorridorGraphRepairs(map, corridor_graph, queries);
+}
+
+void RunGridSection(Renderer& renderer) {
+    RunBenchmark(renderer, "stock maze", MapLayout::CreateDefault());
+    for (const std::size_t size : {128, 512, 1024}) {
+        RunBenchmark(renderer, "generated maze", GenerateMaze(size, kSeed));
+    }
+}
+
+void RunAnyTargetsSection(Renderer& renderer) {
+    RunAnyTargetsBenchmark(renderer, MapLayout::CreateDefault());
+    RunAnyTargetsBenchmark(renderer, GenerateMaze(512, kSeed));
+}
+
+void RunReplanningSection(Renderer& renderer) {
+    RunReplanningBenchmark(renderer, MapLayout::CreateDefault());
+    RunReplanningBenchmark(renderer, GenerateMaze(256, kSeed));
+}
+
+void RunChasersSection(Renderer& renderer) {
+    RunChasersBenchmark(renderer, MapLayout::CreateDefault());
+    RunChasersBenchmark(renderer, GenerateMaze(256, kSeed));
+    RunChasersBenchmark(renderer, MazeGenerator(256, 256, kSeed).Generate().layout);
+}
+
+void RunSchedulerSection(Renderer& renderer) {
+    RunSchedulerBenchmark(renderer, MapLayout::CreateDefault());
+    RunSchedulerBenchmark(renderer, GenerateMaze(1024, kSeed));
+}
+
+void RunBatchSection(Renderer& renderer) {
+    RunBatchBenchmark(renderer, GenerateMaze(512, kSeed));
+}
+
+void RunFloodSection(Renderer& renderer) {
+    for (const std::size_t size : {64, 512, 2048}) {
+        RunFloodBenchmark(renderer, GenerateMaze(size, kSeed));
+    }
+}
+
+void RunHierarchicalSection(Renderer& renderer) {
+    RunHierarchicalBenchmark(renderer, MapLayout::CreateDefault());
+    RunHierarchicalBenchmark(renderer, GenerateRandomWalls(64, kSeed, 0.0f));
+    for (const std::size_t size : {512, 1024}) {
+        RunHierarchicalBenchmark(renderer, GenerateMaze(size, kSeed));
+    }
+}
+
+void RunPathCacheSection(Renderer& renderer) {
+    RunPathCacheBenchmark(renderer, MapLayout::CreateDefault());
+    RunPathCacheBenchmark(renderer, GenerateMaze(512, kSeed));
+}
+
+void RunAllocationsSection(Renderer& renderer) {
+    RunAllocationsBenchmark(renderer, MapLayout::CreateDefault());
+    RunAllocationsBenchmark(renderer, GenerateMaze(512, kSeed));
+}
+
+void RunPathDatabaseSection(Renderer& renderer) {
+    RunPathDatabaseBenchmark(renderer, MapLayout::CreateDefault());
+    for (const std::size_t size : {128, 256}) {
+        RunPathDatabaseBenchmark(renderer, GenerateMaze(size, kSeed));
+    }
+}
+
+void RunMapFileSection(Renderer& renderer) {
+    RunMapFileBenchmark(renderer, MapLayout::CreateDefault());
+    for (const std::size_t size : {1024, 2048}) {
+        RunMapFileBenchmark(renderer, GenerateMaze(size, kSeed));
+    }
+}
+
+void RunMapStorageSection(Renderer& renderer) {
+    RunMapStorageBenchmark(renderer, MapLayout::CreateDefault());
+    for (const std::size_t size : {512, 2048}) {
+        RunMapStorageBenchmark(renderer, GenerateMaze(size, kSeed));
+    }
+}
+
+void RunMapGeometrySection(Renderer& renderer) {
+    RunMapGeometryBenchmark(renderer, MapLayout::CreateDefault());
+    RunMapGeometryBenchmark(renderer, GenerateMaze(2048, kSeed));
+}
+
+void RunMazeGeneratorSection(Renderer& renderer) {
+    for (const auto& [cols_count, rows_count] : kGeneratedMazeSizes) RunMazeGeneratorBenchmark(renderer, cols_count, rows_count);
+}
+
+void RunChunkedMapSection(Renderer& renderer) {
+    for (const std::size_t size : {1024, 16384}) RunChunkedMapBenchmark(renderer, size);
+}
+
+void RunMapJournalSection(Renderer& renderer) {
+    RunMapJournalBenchmark(renderer, MapLayout::CreateDefault());
+    for (const std::size_t size : {512, 2048}) RunMapJournalBenchmark(renderer, GenerateMaze(size, kSeed));
+}
+
+void RunSharedMapSection(Renderer& renderer) {
+    RunSharedMapBenchmark(renderer, MapLayout::CreateDefault());
+    RunSharedMapBenchmark(renderer, MazeGenerator(256, 256, kSeed).Generate().layout);
+}
+
+// Slow sections only run when named or with --all.
+struct Section {
+    const char* name;
+    bool is_slow;
+    void (*run)(Renderer& renderer);
+};
+
+static const std::array<Section, 18> kSections {{
+    {"grid", false, RunGridSection},
+    {"any-targets", false, RunAnyTargetsSection},
+    {"replanning", false, RunReplanningSection},
+    {"chasers", false, RunChasersSection},
+    {"scheduler", false, RunSchedulerSection},
+    {"batch", false, RunBatchSection},
+    {"flood", false, RunFloodSection},
+    {"hierarchical", false, RunHierarchicalSection},
+    {"path-cache", false, RunPathCacheSection},
+    {"allocations", false, RunAllocationsSection},
+    {"path-database", true, RunPathDatabaseSection},
+    {"map-file", false, RunMapFileSection},
+    {"map-storage", false, RunMapStorageSection},
+    {"map-geometry", false, RunMapGeometrySection},
+    {"maze-generator", true, RunMazeGeneratorSection},
+    {"chunked-map", true, RunChunkedMapSection},
+    {"map-journal", false, RunMapJournalSection},
+    {"shared-map", false, RunSharedMapSection}}};
+
+void PrintUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [--list] [--all] [section...]\n", program);
+    std::fprintf(stderr, "Runs the named sections, or every section but the slow ones.\n");
+}
+}
+
+int main(int argc, char* argv[]) {
+    bool is_all = false;
+    std::vector<const Section*> sections;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--list") == 0) {
+            for (const auto& section : kSections) std::printf("%s%s\n", section.name, section.is_slow ? " (slow)" : "");
+            return 0;
+        }
+        if (std::strcmp(argv[i], "--all") == 0) {
+            is_all = true;
+            continue;
+        }
+
+        const auto section = std::find_if(kSections.begin(), kSections.end(),
+            [name = argv[i]](const Section& section) { return std::strcmp(section.name, name) == 0; });
+        if (section == kSections.end()) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        sections.push_back(&*section);
+    }
+    if (sections.empty()) {
+        for (const auto& section : kSections) {
+            if (is_all || !section.is_slow) sections.push_back(&section);
+        }
+    }
+
+    HeadlessRenderer headless_renderer;
+    if (!headless_renderer.IsValid()) {
+        std::fprintf(stderr, "Error creating the software renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    for (const auto* section : sections) section->run(headless_renderer.Get());
+    return 0;
+}
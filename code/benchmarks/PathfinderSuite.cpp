@@ -0,0 +1,361 @@
+#include <SDL2/SDL.h>
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+
+#include "Constants.hpp"
+#include "GameMap.hpp"
+#include "MapLayout.hpp"
+#include "MazeGenerator.hpp"
+
+#include "BenchmarkMaps.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Pathfinder::FindPath throughput over the stock maze and generated maps of a
+// few sizes and wall densities, for fixed-seed query sets:
+//   short        targets at most kShortHopRadius cells away, reachable.
+//   cross        from the first columns of the map to its last ones, reachable.
+//   unreachable  walkable targets in another part of the map.
+//   wall         wall targets.
+// Results go out as JSON, one result per line, so a run can be stored as a
+// baseline and later runs compared against it with --baseline.
+//
+// Usage: PathfinderSuite [--quick] [--output results.json] [--baseline baseline.json]
+namespace {
+static const unsigned int kSeed = 1234;
+static const int kRepetitions = 3;
+// Cells times queries per set, so bigger maps get fewer queries.
+static const std::size_t kQueriesCellsBudget = 1 << 22;
+static const std::size_t kMinQueriesCount = 16;
+static const std::size_t kMaxQueriesCount = 2048;
+static const int kShortHopRadius = 8;
+static const std::size_t kCrossMapBandDivisor = 10;
+static const std::size_t kSealedPocketsCount = 16;
+static const std::size_t kMaxTriesPerQuery = 256;
+static const std::array<std::size_t, 3> kSizes {64, 256, 1024};
+static const std::array<std::size_t, 2> kQuickSizes {64, 256};
+static const std::array<float, 3> kLoopsRatios {0.f, .1f, .3f};
+static const std::array<float, 3> kWallDensities {.1f, .25f, .4f};
+
+using Query = std::pair<Vec2<int>, Vec2<int>>;
+
+enum class EQueries {
+    SHORT,
+    CROSS,
+    UNREACHABLE,
+    WALL
+};
+
+static const std::array<std::pair<EQueries, const char*>, 4> kQueriesNames {{
+    {EQueries::SHORT, "short"},
+    {EQueries::CROSS, "cross"},
+    {EQueries::UNREACHABLE, "unreachable"},
+    {EQueries::WALL, "wall"}}};
+
+struct SuiteMap {
+    std::string family;
+    float parameter;
+    MapLayout layout;
+};
+
+struct SuiteResult {
+    std::string id;
+    const SuiteMap* map;
+    const char* queries_name;
+    std::size_t queries_count;
+    double us_per_query;
+    double expanded_nodes_per_query;
+    double path_cells_per_query;
+};
+
+// Connected part of the map each walkable cell is in, kNoComponent for walls.
+static const std::uint32_t kNoComponent = 0xFFFFFFFF;
+
+std::vector<std::uint32_t> LabelComponents(const MapLayout& layout) {
+    const auto cols = layout.cols_count;
+    const auto rows = layout.rows_count;
+    std::vector<std::uint32_t> components(layout.tiles.size(), kNoComponent);
+    std::vector<std::size_t> queue;
+    std::uint32_t component = 0;
+    for (std::size_t first = 0; first < layout.tiles.size(); ++first) {
+        if (layout.tiles[first] != 0 || components[first] != kNoComponent) continue;
+
+        components[first] = component;
+        queue.assign(1, first);
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const auto index = queue[head];
+            const auto col = index % cols;
+            const auto row = index / cols;
+            const std::array<std::pair<bool, std::size_t>, 4> neighbours {{
+                {col + 1 < cols, index + 1}, {col > 0, index - 1},
+                {row > 0, index - cols}, {row + 1 < rows, index + cols}}};
+            for (const auto& [is_inside, neighbour] : neighbours) {
+                if (!is_inside || layout.tiles[neighbour] != 0 || components[neighbour] != kNoComponent) continue;
+                components[neighbour] = component;
+                queue.push_back(neighbour);
+            }
+        }
+        ++component;
+    }
+    return components;
+}
+
+bool HasSeveralComponents(const std::vector<std::uint32_t>& components) {
+    std::uint32_t first_component = kNoComponent;
+    for (const auto component : components) {
+        if (component == kNoComponent) continue;
+        if (first_component == kNoComponent) first_component = component;
+        if (component != first_component) return true;
+    }
+    return false;
+}
+
+std::size_t GetQueriesCount(EQueries queries, std::size_t cells_count) {
+    if (queries == EQueries::SHORT) return kMaxQueriesCount;
+    return std::clamp(kQueriesCellsBudget / cells_count, kMinQueriesCount, kMaxQueriesCount);
+}
+
+// Fewer queries than asked when the map has no cells that fit, none at all
+// for unreachable queries on a single connected map.
+std::vector<Query> GenerateQueries(const MapLayout& layout, EQueries queries_type) {
+    const auto components = LabelComponents(layout);
+    const auto cols = static_cast<int>(layout.cols_count);
+    const auto rows = static_cast<int>(layout.rows_count);
+    const auto component_of = [&](Vec2<int> col_row) {
+        return components[static_cast<std::size_t>(col_row.y * cols + col_row.x)];
+    };
+
+    std::vector<Vec2<int>> walkable_cells;
+    std::vector<Vec2<int>> wall_cells;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            auto& cells = (layout.tiles[static_cast<std::size_t>(row * cols + col)] == 0) ? walkable_cells : wall_cells;
+            cells.emplace_back(col, row);
+        }
+    }
+
+    // Unreachable queries start in the biggest part of the map, as the ghosts do,
+    // so the search floods it all.
+    std::vector<std::size_t> component_sizes;
+    for (const auto component : components) {
+        if (component == kNoComponent) continue;
+        if (component >= component_sizes.size()) component_sizes.resize(component + 1, 0);
+        ++component_sizes[component];
+    }
+    const auto main_component = static_cast<std::uint32_t>(
+        std::max_element(component_sizes.begin(), component_sizes.end()) - component_sizes.begin());
+    std::vector<Vec2<int>> main_cells;
+    std::vector<Vec2<int>> other_cells;
+    for (const auto& cell : walkable_cells) {
+        (component_of(cell) == main_component ? main_cells : other_cells).push_back(cell);
+    }
+
+    std::vector<Query> queries;
+    if (walkable_cells.empty()) return queries;
+    if (queries_type == EQueries::UNREACHABLE && other_cells.empty()) return queries;
+
+    std::mt19937 rng(kSeed);
+    const auto pick = [&rng](const std::vector<Vec2<int>>& cells) {
+        return cells[std::uniform_int_distribution<std::size_t>(0, cells.size() - 1)(rng)];
+    };
+    const auto band = std::max(1, cols / static_cast<int>(kCrossMapBandDivisor));
+    std::uniform_int_distribution<int> hop(-kShortHopRadius, kShortHopRadius);
+    const auto queries_count = GetQueriesCount(queries_type, layout.tiles.size());
+    for (std::size_t tries = 0; queries.size() < queries_count && tries < queries_count * kMaxTriesPerQuery; ++tries) {
+        const auto from = pick(queries_type == EQueries::UNREACHABLE ? main_cells : walkable_cells);
+        Vec2<int> to = from;
+        bool is_valid = false;
+        switch (queries_type) {
+            case EQueries::SHORT:
+                to = from + Vec2<int>{hop(rng), hop(rng)};
+                is_valid = (to != from && to.x >= 0 && to.y >= 0 && to.x < cols && to.y < rows &&
+                            component_of(to) == component_of(from));
+                break;
+            case EQueries::CROSS:
+                to = pick(walkable_cells);
+                is_valid = (from.x < band && to.x >= cols - band && component_of(to) == component_of(from));
+                break;
+            case EQueries::UNREACHABLE:
+                to = pick(other_cells);
+                is_valid = true;
+                break;
+            case EQueries::WALL:
+                if (wall_cells.empty()) return queries;
+                to = pick(wall_cells);
+                is_valid = true;
+                break;
+        }
+        if (is_valid) queries.emplace_back(from, to);
+    }
+    return queries;
+}
+
+SuiteResult RunQueries(
+    Renderer& renderer,
+    const SuiteMap& suite_map,
+    const MapLayout& layout,
+    EQueries queries_type,
+    const char* queries_name) {
+    SuiteResult result {"", &suite_map, queries_name, 0, 0.0, 0.0, 0.0};
+    char id[96];
+    std::snprintf(id, sizeof(id), "%s-%.2f-%zux%zu-%s", suite_map.family.c_str(), suite_map.parameter,
+        layout.cols_count, layout.rows_count, queries_name);
+    result.id = id;
+
+    const auto queries = GenerateQueries(layout, queries_type);
+    result.queries_count = queries.size();
+    if (queries.empty()) return result;
+
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    Pathfinder pathfinder(map);
+    Pathfinder::Path path;
+    std::size_t expanded_nodes_count = 0;
+    std::size_t path_cells_count = 0;
+    for (const auto& [from, to] : queries) {
+        pathfinder.FindPath(from, to, path);
+        expanded_nodes_count += pathfinder.GetExpandedNodesCount();
+        path_cells_count += path.size();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepetitions; ++i) {
+        for (const auto& [from, to] : queries) pathfinder.FindPath(from, to, path);
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto queries_count = static_cast<double>(queries.size());
+    result.us_per_query = seconds * 1e6 / (queries_count * kRepetitions);
+    result.expanded_nodes_per_query = static_cast<double>(expanded_nodes_count) / queries_count;
+    result.path_cells_per_query = static_cast<double>(path_cells_count) / queries_count;
+    return result;
+}
+
+void WriteJson(std::FILE* file, const std::vector<SuiteResult>& results) {
+    std::fprintf(file, "{\n  \"suite\": \"pathfinder\",\n  \"seed\": %u,\n  \"repetitions\": %d,\n  \"results\": [\n",
+        kSeed, kRepetitions);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        const auto& layout = result.map->layout;
+        std::fprintf(file,
+            "    {\"id\": \"%s\", \"family\": \"%s\", \"parameter\": %.2f, \"cols\": %zu, \"rows\": %zu, "
+            "\"wall_density\": %.4f, \"queries\": \"%s\", \"queries_count\": %zu, \"us_per_query\": %.3f, "
+            "\"queries_per_second\": %.1f, \"expanded_nodes_per_query\": %.1f, \"path_cells_per_query\": %.1f}%s\n",
+            result.id.c_str(), result.map->family.c_str(), result.map->parameter, layout.cols_count, layout.rows_count,
+            GetWallDensity(layout), result.queries_name, result.queries_count, result.us_per_query,
+            result.us_per_query > 0.0 ? 1e6 / result.us_per_query : 0.0,
+            result.expanded_nodes_per_query, result.path_cells_per_query,
+            (i + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+}
+
+// Reads back the id and us_per_query of every result line this suite wrote.
+std::map<std::string, double> ReadBaseline(const char* file_path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(file_path);
+    std::string line;
+    while (std::getline(file, line)) {
+        static const std::string kIdKey = "\"id\": \"";
+        static const std::string kTimeKey = "\"us_per_query\": ";
+        const auto id_position = line.find(kIdKey);
+        const auto time_position = line.find(kTimeKey);
+        if (id_position == std::string::npos || time_position == std::string::npos) continue;
+
+        const auto id_start = id_position + kIdKey.size();
+        const auto id_end = line.find('"', id_start);
+        baseline[line.substr(id_start, id_end - id_start)] = std::strtod(line.c_str() + time_position + kTimeKey.size(), nullptr);
+    }
+    return baseline;
+}
+
+void PrintComparison(const std::map<std::string, double>& baseline, const std::vector<SuiteResult>& results) {
+    std::fprintf(stderr, "%-40s %12s %12s %8s\n", "against the baseline", "before us/q", "after us/q", "speedup");
+    for (const auto& result : results) {
+        const auto it = baseline.find(result.id);
+        if (it == baseline.end() || it->second <= 0.0 || result.us_per_query <= 0.0) continue;
+        std::fprintf(stderr, "%-40s %12.3f %12.3f %7.2fx\n",
+            result.id.c_str(), it->second, result.us_per_query, it->second / result.us_per_query);
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    bool is_quick = false;
+    const char* output_path = nullptr;
+    const char* baseline_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            is_quick = true;
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: %s [--quick] [--output results.json] [--baseline baseline.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    HeadlessRenderer headless_renderer;
+    if (!headless_renderer.IsValid()) {
+        std::fprintf(stderr, "Error creating the software renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::vector<SuiteMap> suite_maps;
+    suite_maps.push_back({"stock", 0.f, MapLayout::CreateDefault()});
+    std::vector<std::size_t> sizes(kSizes.begin(), kSizes.end());
+    if (is_quick) sizes.assign(kQuickSizes.begin(), kQuickSizes.end());
+    for (const auto size : sizes) {
+        for (const auto loops_ratio : kLoopsRatios) {
+            suite_maps.push_back({"maze", loops_ratio, GenerateMaze(size, kSeed, loops_ratio)});
+        }
+        for (const auto loops_ratio : kLoopsRatios) {
+            MazeGenerator generator(size, size, kSeed);
+            generator.SetLoopsRatio(loops_ratio);
+            suite_maps.push_back({"pacman", loops_ratio, generator.Generate().layout});
+        }
+        for (const auto wall_density : kWallDensities) {
+            suite_maps.push_back({"random", wall_density, GenerateRandomWalls(size, kSeed, wall_density)});
+        }
+    }
+
+    std::vector<SuiteResult> results;
+    for (const auto& suite_map : suite_maps) {
+        for (const auto& [queries_type, queries_name] : kQueriesNames) {
+            // Single connected maps get pockets sealed off for the unreachable queries only.
+            auto layout = suite_map.layout;
+            if (queries_type == EQueries::UNREACHABLE && !HasSeveralComponents(LabelComponents(layout))) {
+                SealPockets(layout, kSealedPocketsCount, kSeed);
+            }
+
+            results.push_back(RunQueries(headless_renderer.Get(), suite_map, layout, queries_type, queries_name));
+            const auto& result = results.back();
+            std::fprintf(stderr, "%-40s %6zu queries %12.3f us/query\n",
+                result.id.c_str(), result.queries_count, result.us_per_query);
+        }
+    }
+
+    std::FILE* output = output_path ? std::fopen(output_path, "w") : stdout;
+    if (!output) {
+        std::fprintf(stderr, "Error opening %s\n", output_path);
+        return 1;
+    }
+    WriteJson(output, results);
+    if (output != stdout) std::fclose(output);
+
+    if (baseline_path) PrintComparison(ReadBaseline(baseline_path), results);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "utils/MemoryMappedFile.hpp"
+#include "utils/Vec2.hpp"
+
+#include "MapLayout.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Walkability and exits of a map too big to keep expanded, in square chunks of
+// kChunkSize cells. The chunks near the live entities are resident: a byte per
+// cell with its exits, like GameMap's. The rest stay in a memory-mapped file as
+// bitsets of a bit per cell, and chunks all walls or all floor take no bytes at
+// all; their exits are worked out on every query. Queries and changes work on
+// any cell, resident or not, so callers never see the residency.
+//
+// The file is native endian. It's read only: chunks changed while loaded keep
+// their bitset on the heap once evicted.
+class ChunkedMap {
+public:
+    static constexpr std::size_t kChunkSize = 64;
+
+    ChunkedMap();
+
+    static bool Save(const MapView& map, const std::string& file_path);
+    // False when the file is missing or corrupt.
+    bool Load(const std::string& file_path);
+    bool IsLoaded() const;
+
+    // Chunks within radius chunks of any of the cells are expanded, every other
+    // chunk is evicted.
+    void UpdateResidency(std::span<const Vec2<int>> col_rows, std::size_t radius = 1);
+
+    // The cells must be inside the map.
+    bool IsWalkable(std::size_t col, std::size_t row) const;
+    void SetIsWalkable(std::size_t col, std::size_t row, bool is_walkable);
+    // GameMap's exit bits, to the walkable neighbours. 0 in a wall.
+    std::uint8_t GetExits(std::size_t col, std::size_t row) const;
+
+    std::size_t GetColumnsCount() const;
+    std::size_t GetRowsCount() const;
+    std::size_t GetChunksCount() const;
+    std::size_t GetResidentChunksCount() const;
+    std::size_t GetFileSize() const;
+    // Heap only: resident chunks, changed bitsets and the chunk tables. The file
+    // pages the queries touch aren't counted.
+    std::size_t GetMemoryUsage() const;
+
+private:
+    using Bitset = std::array<std::uint64_t, kChunkSize>;
+
+    enum class ESource : std::uint8_t {
+        WALLS,
+        FLOOR,
+        FILE,
+        CHANGED
+    };
+
+    struct FileHeader {
+        std::uint32_t magic;
+        std::uint32_t format_version;
+        std::uint32_t columns_count;
+        std::uint32_t rows_count;
+        std::uint32_t chunk_size;
+        std::uint32_t chunks_count;
+        std::uint64_t bitsets_count;
+    };
+
+    static constexpr std::uint32_t kNotResident = 0xFFFFFFFF;
+
+    std::size_t columns_count_;
+    std::size_t rows_count_;
+    std::size_t chunks_per_row_;
+    std::size_t chunks_per_column_;
+
+    // Where each chunk's bitset is when it isn't resident, and which one.
+    std::vector<ESource> sources_;
+    std::vector<std::uint32_t> source_bitsets_;
+    std::span<const Bitset> file_bitsets_;
+    std::vector<Bitset> changed_bitsets_;
+    MemoryMappedFile file_;
+
+    // A slot of kChunkSize^2 exit bytes per resident chunk, slots reused once freed.
+    std::vector<std::uint32_t> resident_slots_;
+    std::vector<std::uint8_t> is_changed_;
+    std::vector<std::uint8_t> resident_exits_;
+    std::vector<std::uint32_t> free_slots_;
+    std::vector<std::uint32_t> resident_chunks_;
+    std::vector<std::uint32_t> wanted_stamps_;
+    std::uint32_t stamp_;
+
+    void Clear();
+    std::size_t GetChunk(std::size_t col, std::size_t row) const;
+    std::uint8_t* GetResidentExits(std::uint32_t slot);
+    const std::uint8_t* GetResidentExits(std::uint32_t slot) const;
+    bool IsWalkableInSource(std::size_t chunk, std::size_t col, std::size_t row) const;
+    std::uint8_t ComputeExits(std::size_t col, std::size_t row) const;
+    // Recomputes a cell's exits when its chunk is resident.
+    void RefreshExits(int col, int row);
+    void Expand(std::size_t chunk);
+    void Evict(std::size_t chunk);
+};
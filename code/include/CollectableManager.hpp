@@ -6,26 +6,29 @@
 #include "utils/TextureManager.hpp"
 #include "utils/Renderer.hpp"
 
+#include "CollectableSpawns.hpp"
 #include "GameMap.hpp"
-#include "Types.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <vector>
-#include <memory>
 
 enum class ECollectableType {
     SMALL,
     BIG
 };
 
+// Built on demand from the map's spawns: nothing stores it.
 struct Collectable {
+    std::size_t spawn_index;
     ECollectableType type;
     unsigned int score;
-    const SDL_FRect hitbox;
-    bool is_marked_for_destroy;
-    Collectable(ECollectableType type_, unsigned int score_, SDL_FRect hitbox_)
-        : type(type_), score(score_), hitbox(hitbox_), is_marked_for_destroy(false) {}
+    SDL_FRect hitbox;
 };
 
+// The collectables are the spawns of the map's asset, shared by every game on the
+// same maze. A game only keeps which ones were collected, a bit each.
 class CollectableManager {
 public:
     CollectableManager(
@@ -33,20 +36,33 @@ public:
         TextureManager& texture_manager,
         const GameMap& game_map);
 
+    // Every spawn of the map becomes a collectable again.
     void CreateCollectables();
-    void RemoveCollectablesMarkedForDestroy();
+    void Collect(const Collectable& collectable);
+    void CollectAll();
     void Render();
-    void MarkAllForDestroy();
     bool DidCollectAll() const;
-    CollectableList& GetCollectableList();
     unsigned int GetAllCollectableScores() const;
-    
+
+    // The collectables left, in spawn order.
+    template<typename OnCollectable>
+    void ForEachCollectable(OnCollectable&& on_collectable) const {
+        for (std::size_t spawn_index = 0; spawn_index < spawns_.size(); ++spawn_index) {
+            if (!IsCollected(spawn_index)) on_collectable(GetCollectable(spawn_index));
+        }
+    }
+
+    std::size_t GetMemoryUsage() const;
+
 private:
     Renderer& renderer_;
     TextureManager& texture_manager_;
     const GameMap& game_map_;
-    CollectableList collectables_;
+    std::span<const CollectableSpawn> spawns_;
+    std::vector<std::uint64_t> collected_spawns_;
+    std::size_t collectables_count_;
     SDL_Texture* texture_;
 
-    void AddCollectable(ECollectableType type, unsigned int score, float size, float x, float y);
+    bool IsCollected(std::size_t spawn_index) const;
+    Collectable GetCollectable(std::size_t spawn_index) const;
 };
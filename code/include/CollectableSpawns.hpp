@@ -0,0 +1,39 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// A collectable a map spawns, from the map's top left corner. Types are the map
+// collectables values: 1 a pellet, 2 a power pellet.
+struct CollectableSpawn {
+    Vec2<float> center;
+    std::uint8_t type;
+};
+
+// One spawn at the center of each cell with a collectable, and a pellet half a
+// cell right and half a cell down when the next cell that way has one too. Takes
+// either geometry, so the stock maze's spawns are computed at compile time.
+template<typename Geometry, typename Collectables, typename OnSpawn>
+constexpr void ForEachCollectableSpawn(const Geometry& geometry, const Collectables& collectables, OnSpawn&& on_spawn) {
+    const auto cols_count = geometry.GetColumnsCount();
+    const auto rows_count = geometry.GetRowsCount();
+    const auto half_cell_size = static_cast<float>(geometry.GetCellSize()) / 2.f;
+    std::size_t index = 0;
+    for (std::size_t row = 0; row < rows_count; ++row) {
+        for (std::size_t col = 0; col < cols_count; ++col, ++index) {
+            const auto type = static_cast<std::uint8_t>(collectables[index]);
+            if (type == 0) continue;
+
+            const auto center = geometry.GetCellCenter(Vec2{static_cast<int>(col), static_cast<int>(row)});
+            on_spawn(CollectableSpawn{center, type});
+            if (col + 1 < cols_count && collectables[index + 1]) {
+                on_spawn(CollectableSpawn{center + Vec2{half_cell_size, 0.f}, 1});
+            }
+            if (row + 1 < rows_count && collectables[index + cols_count]) {
+                on_spawn(CollectableSpawn{center + Vec2{0.f, half_cell_size}, 1});
+            }
+        }
+    }
+}
@@ -33,7 +33,7 @@ private:
     std::size_t sound_collect_index_;
     std::array<Mix_Chunk*, 2> sounds_collect_ {nullptr, nullptr};
 
-    void OnCollisionWithCollectable(Collectable& collectable_type, GameScene& game_scene);
+    void OnCollisionWithCollectable(const Collectable& collectable, GameScene& game_scene);
     void OnCollisionWithGhost(Ghost& ghost, GameScene& game_scene);
 
     void LoadSounds();
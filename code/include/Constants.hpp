@@ -21,6 +21,8 @@ static const Uint64 kFrameDelay = 1000 / kTargetFPS; // Frame delay in milliseco
 static const std::string kAssetsFolderImages = "assets/images/";
 static const std::string kAssetsFolderFonts = "assets/fonts/";
 static const std::string kAssetsFolderSounds = "assets/sounds/";
+static const std::string kAssetsFolderMaps = "assets/maps/";
+static const std::string kMapFileName = "default.map"; // Compiled next to itself into a .pmap on first load.
 
 static const std::size_t kCellSize = 16 * 2;
 static const int kCellSizeInt = static_cast<int>(kCellSize);
@@ -28,10 +30,17 @@ static const int kGamePaddingX = 100;
 static const int kGamePaddingY = 100;
 static const std::size_t kColsCount = 17;
 static const std::size_t kRowsCount = 20;
+static constexpr Vec2<int> kHousesDoorColRow {8, 6}; // Entities can't go down from it.
 static const int kGameWidth = kCellSizeInt * static_cast<int>(kColsCount); // 80 cols
 static const int kGameHeight = kCellSizeInt * static_cast<int>(kRowsCount); // 60 rows
 
-static const std::array<std::array<unsigned int, kColsCount>, kRowsCount> kMapCollectables {{
+// Pathfinding
+static const std::size_t kPathTableMaxCellsCount = 2048; // Bigger maps fall back to A* (table grows with cells^2).
+static const int kPathfindingBudgetMicroseconds = 1000; // Per fixed update for those searches, 0 runs them synchronously.
+static const bool kUseHierarchicalPathfinder = false; // HPA* behind the path table instead of the corridor graph.
+static const std::size_t kPathCacheCapacity = 64; // Recent (from, to) paths on maps without the path table, 0 disables it.
+
+static constexpr std::array<std::array<unsigned int, kColsCount>, kRowsCount> kMapCollectables {{
     {1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1},
     {1, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1},
     {1, 2, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 2, 1},
@@ -54,7 +63,7 @@ static const std::array<std::array<unsigned int, kColsCount>, kRowsCount> kMapCo
     {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}
 }};
 
-static const std::array<std::array<unsigned int, kColsCount>, kRowsCount> kMapTiles {{
+static constexpr std::array<std::array<unsigned int, kColsCount>, kRowsCount> kMapTiles {{
     {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0},
     {0, 1, 1, 0, 1, 1, 1, 0, 0, 0, 1, 1, 1, 0, 1, 1, 0},
     {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0},
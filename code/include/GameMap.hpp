@@ -3,11 +3,65 @@
 #include "utils/Vec2.hpp"
 #include "utils/Renderer.hpp"
 
-#include <vector>
+#include "MapGeometry.hpp"
+#include "MapLayout.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
 #include <utility>
+#include <vector>
+
+class ChunkedMap;
+class MapAsset;
 
+// Walkability is a bitset of 8x8 cell blocks, one 64-bit word each, so a cell and
+// its neighbours are almost always in the same word and at worst in four words of
+// two rows of blocks. Every cell also has a byte of exit masks, kept up to date on
+// every change, so movement and pathfinding read a cell's ways out at once. The
+// rest of a cell is computed from its index.
+//
+// Both are read from a MapAsset that maps of the same maze share. The first change
+// to a map copies them into its own overlay, which it changes from then on: until
+// then a map owns next to nothing of its own.
+//
+// Maps too big for that load as a ChunkedMap instead, behind the same interface:
+// callers don't see which chunks are resident. Only the map itself is chunked,
+// though. Pathfinder, CorridorGraph, DistanceField and PathTable still keep arrays
+// over every cell, so a chunked map serves cell queries and entities walking it,
+// and GameScene never loads one.
 class GameMap {
 public:
+    // Exit mask bits, in the pathfinding neighbours order.
+    static constexpr std::uint8_t kExitEast = 1 << 0;
+    static constexpr std::uint8_t kExitWest = 1 << 1;
+    static constexpr std::uint8_t kExitNorth = 1 << 2;
+    static constexpr std::uint8_t kExitSouth = 1 << 3;
+    static constexpr std::uint8_t kExitsAll = 0xF;
+    // Walkability changes the journal remembers, the oldest dropped first.
+    static constexpr std::size_t kJournalCapacity = 4096;
+
+    // A cell's exits given the walkability around it, usable at compile time.
+    template<typename AreColRowWalkable>
+    static constexpr std::uint8_t ComputeExits(Vec2<int> col_row, const AreColRowWalkable& are_col_row_walkable) {
+        if (!are_col_row_walkable(col_row)) return 0;
+
+        return (are_col_row_walkable(col_row + Vec2<int>{1, 0}) ? kExitEast : 0) |
+               (are_col_row_walkable(col_row + Vec2<int>{-1, 0}) ? kExitWest : 0) |
+               (are_col_row_walkable(col_row + Vec2<int>{0, -1}) ? kExitNorth : 0) |
+               (are_col_row_walkable(col_row + Vec2<int>{0, 1}) ? kExitSouth : 0);
+    }
+
+    // Nowhere in a wall, anywhere but down on the house door.
+    static constexpr std::uint8_t ComputeEntityMoves(bool is_walkable, bool is_house_door) {
+        if (!is_walkable) return 0;
+
+        return is_house_door ? (kExitsAll & ~kExitSouth) : kExitsAll;
+    }
+
+    // Built on demand: nothing stores it.
     struct Cell {
         std::size_t cell_index;
         Vec2<float> position;
@@ -19,6 +73,7 @@ public:
             : cell_index(cell_index_), position(position_), center(center_), row(row_), col(col_), is_walkable(is_walkable_) {}
     };
 
+    // An open floor of width x height pixels, rounded down to whole cells.
     GameMap(
         Renderer& renderer,
         float width,
@@ -26,10 +81,57 @@ public:
         Vec2<float> padding,
         std::size_t cell_size);
 
-    void Init();
+    GameMap(
+        Renderer& renderer,
+        Vec2<float> padding,
+        std::size_t cell_size,
+        const MapView& map);
+
+    // Shares the asset, which gives the cell size and the house door as well.
+    GameMap(
+        Renderer& renderer,
+        Vec2<float> padding,
+        std::shared_ptr<const MapAsset> asset);
+
+    ~GameMap();
+
+    // The map takes the size of the new one. Loading a map bumps the version as well.
+    void Init(const MapView& map);
+    void Init(std::shared_ptr<const MapAsset> asset);
+    // Same for a file ChunkedMap::Save() wrote. False, with the map unchanged, when
+    // it can't be loaded.
+    bool InitChunked(const std::string& file_path);
+    bool IsChunked() const;
+    // Keeps the chunks around the cells expanded, the cells of the live entities.
+    // Nothing to do on maps that aren't chunked.
+    void UpdateResidency(std::span<const Vec2<int>> col_rows);
+    // Null unless the map is chunked.
+    const ChunkedMap* GetChunkedMap() const;
+    // What the map was loaded from, null when it's chunked.
+    const std::shared_ptr<const MapAsset>& GetAsset() const;
     void Render();
 
+    // Bumps the map version when the cell changes, so derived data can tell it's stale,
+    // and records the cell in the journal.
     void SetIsWalkable(Vec2<int> col_row, bool is_walkable);
+    std::uint64_t GetVersion() const;
+    // The cells changed after the version, each once in index order, so derived data
+    // repairs only around them. False when the journal doesn't go back that far or the
+    // map was loaded since: the data has to be built again.
+    bool GetChangesSince(std::uint64_t version, std::vector<std::uint32_t>& changed_cells) const;
+    // The version the map was loaded at, when it was just its asset.
+    std::uint64_t GetLoadedVersion() const;
+
+    // Entities can't go down from the house door, pathfinding can. None by default.
+    void SetHouseDoor(Vec2<int> col_row);
+    bool IsHouseDoor(Vec2<int> col_row) const;
+    // The walkable neighbours, what pathfinding expands. 0 outside the map.
+    std::uint8_t GetExits(std::size_t index) const;
+    // The exits entities can take from the cell center: down from the house door isn't one.
+    std::uint8_t GetEntityExits(Vec2<int> col_row) const;
+    // Where entities can move inside the cell, towards its center or an exit: nowhere
+    // in a wall, anywhere but down on the house door.
+    std::uint8_t GetEntityMoves(Vec2<int> col_row) const;
     bool AreColRowWalkable(Vec2<int> col_row) const;
     bool IsWalkable(std::size_t index) const;
     bool AreCoordsWalkable(Vec2<float> coords) const;
@@ -42,6 +144,8 @@ public:
     Vec2<int> FromCoordsToColRow(Vec2<float> coords) const;
     Vec2<float> FromCoordsToCenterCellCoords(Vec2<float> coords) const;
 
+    // The runtime-sized geometry behind the conversions, without the padding.
+    const MapGeometry& GetGeometry() const;
     std::size_t GetRowsCount() const;
     std::size_t GetColumnsCount() const;
     std::size_t GetCellsCount() const;
@@ -52,9 +156,46 @@ public:
     bool AreColRowInsideBoundaries(Vec2<int> col_row) const;
     bool AreCoordsInsideBoundaries(Vec2<float> coords) const;
 
-    const Cell& GetCell(Vec2<int> col_row) const;
-    const Cell& GetCell(Vec2<float> coords) const;
-    const std::vector<Cell>& GetCells() const;
+    // Every cell in index order, built while iterating.
+    class CellsView {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Cell;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator(const GameMap& map, std::size_t index) : map_(&map), index_(index) {}
+
+            Cell operator*() const { return map_->GetCell(index_); }
+            Iterator& operator++() { ++index_; return *this; }
+            Iterator operator++(int) { auto copy = *this; ++index_; return copy; }
+            bool operator==(const Iterator& other) const { return index_ == other.index_; }
+
+        private:
+            const GameMap* map_;
+            std::size_t index_;
+        };
+
+        explicit CellsView(const GameMap& map) : map_(map) {}
+
+        Iterator begin() const { return Iterator(map_, 0); }
+        Iterator end() const { return Iterator(map_, map_.GetCellsCount()); }
+        std::size_t size() const { return map_.GetCellsCount(); }
+
+    private:
+        const GameMap& map_;
+    };
+
+    Cell GetCell(std::size_t index) const;
+    Cell GetCell(Vec2<int> col_row) const;
+    Cell GetCell(Vec2<float> coords) const;
+    CellsView GetCells() const;
+
+    // The walkability bitset, the exit masks and the journal, or the chunked map's heap.
+    std::size_t GetMemoryUsage() const;
+    // The same without the shared asset: what each more map of the maze costs.
+    std::size_t GetOwnedMemoryUsage() const;
 
 private:
     Renderer& renderer_;
@@ -69,8 +210,31 @@ private:
     int rows_count_int_;
     int cols_count_int_;
     std::size_t cells_count_;
+    MapGeometry geometry_;
 
-    std::vector<Cell> cells_;
+    std::shared_ptr<const MapAsset> asset_;
+    std::size_t blocks_per_row_;
+    // The asset's until the map changes, the overlay's after. Exits in the low
+    // nibble, entity moves in the high one.
+    const std::uint64_t* walkable_blocks_;
+    const std::uint8_t* exits_;
+    std::vector<std::uint64_t> overlay_walkable_blocks_;
+    std::vector<std::uint8_t> overlay_exits_;
+    Vec2<int> house_door_;
+    std::uint64_t version_;
+    // The cell changed at each version after journal_start_version_, in a ring.
+    std::vector<std::uint32_t> journal_;
+    std::uint64_t journal_start_version_;
+    std::unique_ptr<ChunkedMap> chunked_map_;
 
     bool IsInsideBoundaries(std::size_t index) const;
+    bool IsWalkableInside(std::size_t col, std::size_t row) const;
+    void SetIsWalkableInside(std::size_t col, std::size_t row, bool is_walkable);
+    void SetDimensions(std::size_t cols_count, std::size_t rows_count);
+    // Copies the asset's walkability and exits the first time the map changes.
+    void MakeOverlay();
+    // Exits in the low nibble, entity moves in the high one, as exits_ has them.
+    std::uint8_t GetExitsAndMoves(Vec2<int> col_row) const;
+    void UpdateExits(Vec2<int> col_row);
+    void RecordChange(std::size_t col, std::size_t row);
 };
@@ -12,6 +12,7 @@
 #include "Level.hpp"
 
 #include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/DistanceField.hpp"
 
 #include <string>
 #include <string_view>
@@ -42,7 +43,6 @@ public:
         Renderer& renderer,
         TextureManager& texture_manager,
         const GameMap& game_map,
-        Pathfinder& pathfinder,
         const Level& level,
         std::string name,
         EType type,
@@ -76,7 +76,6 @@ private:
     const static unsigned int kScoreBase = 200;
 
     TextureManager& texture_manager_;
-    Pathfinder& pathfinder_;
     const Level& level_;
     const std::string name_;
     EType type_;
@@ -97,6 +96,13 @@ private:
     bool is_moving_between_tiles_;
     Pathfinder::Path path_;
     std::size_t path_index_;
+    // The pattern writes here, then it's swapped with path_, so chasing reuses both buffers.
+    Pathfinder::Path next_path_;
+
+    // Eyes follow the home field one cell at a time back to the house cell.
+    Vec2<int> col_row_house_;
+    DistanceField home_field_;
+    Vec2<int> col_row_eyes_;
     std::size_t last_visited_cell_index_ {0};
     
     CountdownTimer animation_timer_;
@@ -111,6 +117,9 @@ private:
     void UpdateStateFrightened(float dt, GameScene& game_scene);
     void UpdateStateEyes(float dt,  GameScene& game_scene);
 
+    // Whether the ghost stands on the cell before the one path_ leads to next.
+    bool IsOnPath(Vec2<int> col_row) const;
+    bool StepToCell(float dt, Vec2<int> col_row);
     EDirection ChooseRandomDirection() const;
     int GetSpriteIndexByDirection() const;
 };
@@ -1,16 +1,32 @@
 #pragma once
 
 #include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/IncrementalPlanner.hpp"
+#include "pathfinder/PathfinderStats.hpp"
 
 #include "utils/Vec2.hpp"
 
 #include <functional>
+#include <string>
 
 class GameScene;
+class GameMap;
 
-using PathfindingPattern = std::function<Pathfinder::Path(Vec2<int>, GameScene&)>;
+// Writes the ghost's path into the last argument, reusing its storage.
+using PathfindingPattern = std::function<void(Vec2<int>, GameScene&, Pathfinder::Path&)>;
+// The cell a ghost heads to from its current cell.
+using TargetPattern = std::function<Vec2<int>(const Vec2<int>&, GameScene&)>;
 
-Pathfinder::Path FindPathPatternInky(const Vec2<int>& col_row_ghost, GameScene& game);
-Pathfinder::Path FindPathPatternBlinky(const Vec2<int>& col_row_ghost, GameScene& game);
-Pathfinder::Path FindPathPatternPinky(const Vec2<int>& col_row_ghost, GameScene& game);
-Pathfinder::Path FindPathPatternClyde(const Vec2<int>& col_row_ghost, GameScene& game);
+Vec2<int> FindTargetPatternInky(const Vec2<int>& col_row_ghost, GameScene& game);
+Vec2<int> FindTargetPatternBlinky(const Vec2<int>& col_row_ghost, GameScene& game);
+Vec2<int> FindTargetPatternPinky(const Vec2<int>& col_row_ghost, GameScene& game);
+Vec2<int> FindTargetPatternClyde(const Vec2<int>& col_row_ghost, GameScene& game);
+
+// Paths towards the target pattern's cell. Each pattern owns its IncrementalPlanner
+// and scheduler requester, so one per ghost keeps its search between calls. An
+// empty path means no new path yet. The name labels the ghost's pathfinding stats.
+PathfindingPattern MakePathfindingPattern(
+    std::string name,
+    TargetPattern target_pattern,
+    const GameMap& map,
+    IPathfinder& fallback);
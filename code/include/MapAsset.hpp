@@ -0,0 +1,54 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "CollectableSpawns.hpp"
+#include "MapGeometry.hpp"
+#include "MapLayout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// The read-only part of a map, built once from its tiles: the geometry, the
+// walkability, every cell's exits and the collectable spawns. Maps hold it through
+// a shared_ptr to const, so any number of game instances playing the same maze
+// share a single copy and keep only what they change on top of it.
+//
+// Walkability is a bitset of kBlockSize x kBlockSize cell blocks, one 64-bit word
+// each, and every cell has a byte with GameMap's exits in the low nibble and the
+// moves entities can make inside it in the high one.
+class MapAsset {
+public:
+    static constexpr std::size_t kBlockSize = 8;
+    static constexpr std::size_t kBlockShift = 3;
+    static constexpr std::size_t kBlockMask = kBlockSize - 1;
+    static constexpr std::uint8_t kEntityMovesShift = 4;
+
+    // No house door at {-1, -1}.
+    MapAsset(const MapView& map, std::size_t cell_size, Vec2<int> house_door_col_row = {-1, -1});
+
+    static std::shared_ptr<const MapAsset> Create(const MapView& map, std::size_t cell_size, Vec2<int> house_door_col_row = {-1, -1});
+
+    const MapGeometry& GetGeometry() const;
+    Vec2<int> GetHouseDoor() const;
+    std::size_t GetBlocksPerRow() const;
+    std::span<const std::uint64_t> GetWalkableBlocks() const;
+    std::span<const std::uint8_t> GetExitsAndMoves() const;
+    // From the map's top left corner, without the padding.
+    std::span<const CollectableSpawn> GetCollectableSpawns() const;
+
+    std::size_t GetMemoryUsage() const;
+
+private:
+    MapGeometry geometry_;
+    Vec2<int> house_door_;
+    std::size_t blocks_per_row_;
+    std::vector<std::uint64_t> walkable_blocks_;
+    std::vector<std::uint8_t> exits_and_moves_;
+    std::vector<CollectableSpawn> collectable_spawns_;
+
+    bool IsWalkable(Vec2<int> col_row) const;
+};
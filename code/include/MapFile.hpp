@@ -0,0 +1,43 @@
+#pragma once
+
+#include "utils/MemoryMappedFile.hpp"
+
+#include "MapLayout.hpp"
+
+#include <optional>
+#include <string>
+
+// A map loaded at runtime, in one of two formats:
+// - Text (.map), to edit by hand: one line per row, all of the same length, with
+//   '#' for a wall, '.' a pellet, 'o' a power pellet and ' ' an empty floor.
+//   Lines starting with ';' are comments.
+// - Binary (.pmap), compiled from the text: a header and then the tiles and the
+//   collectables as MapLayout stores them. The file is mapped and read in place,
+//   so loading doesn't grow with the map.
+//
+// Views over the map stay valid until the next load.
+class MapFile {
+public:
+    // .pmap files are mapped, any other file is parsed as text.
+    bool Load(const std::string& file_path);
+    // Maps the binary next to a text map, compiling it first when it's missing or older.
+    bool LoadOrCompile(const std::string& text_file_path);
+    // A map that comes from no file, like the built-in one.
+    void Load(MapLayout layout);
+
+    bool IsLoaded() const;
+    MapView GetView() const;
+
+    static bool SaveText(const MapView& map, const std::string& file_path);
+    static bool SaveBinary(const MapView& map, const std::string& file_path);
+    static std::string GetBinaryFilePath(const std::string& text_file_path);
+
+private:
+    std::optional<MapLayout> layout_;
+    MemoryMappedFile file_;
+    MapView view_ {0, 0, {}, {}};
+
+    bool LoadText(const std::string& file_path);
+    bool LoadBinary(const std::string& file_path);
+    void Clear();
+};
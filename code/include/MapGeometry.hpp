@@ -0,0 +1,115 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Conversions between cell indices, columns and rows, and pixels from the map's top
+// left corner. FromIndexToColRow returns {row, col}, as GameMap does.
+//
+// StaticMapGeometry has its dimensions as template arguments: every division is by
+// a constant, which the compiler turns into a multiplication or a shift, and all of
+// it works in constant expressions. MapGeometry is the runtime-sized one for loaded
+// maps: it divides indices with a precomputed reciprocal of the columns count, exact
+// for maps under 2^31 cells, and pixels with a shift when the cell size is a power
+// of two.
+template<std::size_t ColsCount, std::size_t RowsCount, std::size_t CellSize>
+class StaticMapGeometry {
+    static_assert(ColsCount > 0 && RowsCount > 0 && CellSize > 0, "A map has at least a cell of a pixel");
+public:
+    static constexpr std::size_t GetColumnsCount() { return ColsCount; }
+    static constexpr std::size_t GetRowsCount() { return RowsCount; }
+    static constexpr std::size_t GetCellsCount() { return ColsCount * RowsCount; }
+    static constexpr std::size_t GetCellSize() { return CellSize; }
+
+    static constexpr bool AreColRowInsideBoundaries(Vec2<int> col_row) {
+        return (col_row.x >= 0 && col_row.x < static_cast<int>(ColsCount) &&
+                col_row.y >= 0 && col_row.y < static_cast<int>(RowsCount));
+    }
+
+    static constexpr std::size_t FromColRowToIndex(Vec2<int> col_row) {
+        return static_cast<std::size_t>(col_row.y) * ColsCount + static_cast<std::size_t>(col_row.x);
+    }
+
+    static constexpr Vec2<int> FromIndexToColRow(std::size_t index) {
+        return {static_cast<int>(index / ColsCount), static_cast<int>(index % ColsCount)};
+    }
+
+    // Rounds towards zero, as the runtime division did.
+    static constexpr Vec2<int> FromPixelsToColRow(Vec2<int> pixels) {
+        return {pixels.x / static_cast<int>(CellSize), pixels.y / static_cast<int>(CellSize)};
+    }
+
+    static constexpr Vec2<float> GetCellCenter(Vec2<int> col_row) {
+        constexpr auto kCellSizeFloat = static_cast<float>(CellSize);
+        return {static_cast<float>(col_row.x) * kCellSizeFloat + kCellSizeFloat / 2.f,
+                static_cast<float>(col_row.y) * kCellSizeFloat + kCellSizeFloat / 2.f};
+    }
+};
+
+class MapGeometry {
+public:
+    // An empty map divides by one column.
+    MapGeometry(std::size_t cols_count, std::size_t rows_count, std::size_t cell_size)
+        : cols_count_(cols_count)
+        , rows_count_(rows_count)
+        , cell_size_(cell_size)
+        , cell_size_int_(static_cast<int>(cell_size))
+        , cell_size_shift_(std::has_single_bit(cell_size) ? std::countr_zero(cell_size) : kNoShift)
+        , cols_shift_(kIndexBits + std::bit_width(std::max<std::size_t>(cols_count, 1) - 1))
+        , cols_reciprocal_((std::uint64_t{1} << cols_shift_) / std::max<std::size_t>(cols_count, 1) + 1) {}
+
+    std::size_t GetColumnsCount() const { return cols_count_; }
+    std::size_t GetRowsCount() const { return rows_count_; }
+    std::size_t GetCellsCount() const { return cols_count_ * rows_count_; }
+    std::size_t GetCellSize() const { return cell_size_; }
+
+    bool AreColRowInsideBoundaries(Vec2<int> col_row) const {
+        return (col_row.x >= 0 && static_cast<std::size_t>(col_row.x) < cols_count_ &&
+                col_row.y >= 0 && static_cast<std::size_t>(col_row.y) < rows_count_);
+    }
+
+    std::size_t FromColRowToIndex(Vec2<int> col_row) const {
+        return static_cast<std::size_t>(col_row.y) * cols_count_ + static_cast<std::size_t>(col_row.x);
+    }
+
+    Vec2<int> FromIndexToColRow(std::size_t index) const {
+        const auto row = (static_cast<std::uint64_t>(index) * cols_reciprocal_) >> cols_shift_;
+        return {static_cast<int>(row), static_cast<int>(index - static_cast<std::size_t>(row) * cols_count_)};
+    }
+
+    Vec2<int> FromPixelsToColRow(Vec2<int> pixels) const {
+        return {DivideByCellSize(pixels.x), DivideByCellSize(pixels.y)};
+    }
+
+    Vec2<float> GetCellCenter(Vec2<int> col_row) const {
+        const auto cell_size_float = static_cast<float>(cell_size_);
+        return {static_cast<float>(col_row.x) * cell_size_float + cell_size_float / 2.f,
+                static_cast<float>(col_row.y) * cell_size_float + cell_size_float / 2.f};
+    }
+
+private:
+    // With the reciprocal rounded up, index * reciprocal >> shift is the quotient
+    // for indices under 2^kIndexBits, and the product fits in 64 bits.
+    static constexpr int kIndexBits = 31;
+    static constexpr int kNoShift = -1;
+
+    std::size_t cols_count_;
+    std::size_t rows_count_;
+    std::size_t cell_size_;
+    int cell_size_int_;
+    int cell_size_shift_;
+    int cols_shift_;
+    std::uint64_t cols_reciprocal_;
+
+    int DivideByCellSize(int pixels) const {
+        if (cell_size_shift_ == kNoShift) return pixels / cell_size_int_;
+
+        // Rounds towards zero like the division.
+        const auto bias = (pixels < 0) ? cell_size_int_ - 1 : 0;
+        return (pixels + bias) >> cell_size_shift_;
+    }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Tiles of a maze, row by row. 0 is a walkable cell and 1 a wall, as in kMapTiles.
+// Collectables use the kMapCollectables values: 0 none, 1 a pellet, 2 a power pellet.
+struct MapLayout {
+    std::size_t cols_count;
+    std::size_t rows_count;
+    std::vector<std::uint8_t> tiles;
+    std::vector<std::uint8_t> collectables;
+
+    // Without collectables the map gets none.
+    MapLayout(std::size_t cols_count_, std::size_t rows_count_, std::vector<std::uint8_t> tiles_, std::vector<std::uint8_t> collectables_ = {})
+        : cols_count(cols_count_), rows_count(rows_count_), tiles(std::move(tiles_)), collectables(std::move(collectables_)) {
+        collectables.resize(tiles.size(), 0);
+    }
+
+    static MapLayout CreateDefault();
+};
+
+// The same data without owning it, over a MapLayout or straight over a mapped map file.
+struct MapView {
+    std::size_t cols_count;
+    std::size_t rows_count;
+    std::span<const std::uint8_t> tiles;
+    std::span<const std::uint8_t> collectables;
+
+    MapView(std::size_t cols_count_, std::size_t rows_count_, std::span<const std::uint8_t> tiles_, std::span<const std::uint8_t> collectables_)
+        : cols_count(cols_count_), rows_count(rows_count_), tiles(tiles_), collectables(collectables_) {}
+    MapView(const MapLayout& layout)
+        : cols_count(layout.cols_count), rows_count(layout.rows_count), tiles(layout.tiles), collectables(layout.collectables) {}
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "MapLayout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GeneratedMaze {
+    MapLayout layout;
+    // {-1, -1} when the map is too small for a ghost house.
+    Vec2<int> house_door_col_row;
+};
+
+// Seeded Pac-Man style mazes of any size: corridors on a lattice, mirrored left to
+// right, without dead ends, around a ghost house in the middle with its door on
+// top. Every corridor line gets pellets, and the four corridors nearest the
+// corners a power pellet. The same seed and settings give the same maze.
+//
+// The lattice has a cell per corridor width plus a wall, so a map that isn't a
+// whole number of them gets thicker outer walls: split between the left and
+// right edges, at the bottom edge.
+class MazeGenerator {
+public:
+    MazeGenerator(std::size_t cols_count, std::size_t rows_count, unsigned int seed);
+
+    // Share of the walls left between corridors that are opened into extra loops.
+    void SetLoopsRatio(float loops_ratio);
+    // Odd, so the maze has a middle column to mirror around: even widths round up.
+    void SetCorridorWidth(std::size_t corridor_width);
+
+    GeneratedMaze Generate() const;
+
+private:
+    std::size_t cols_count_;
+    std::size_t rows_count_;
+    unsigned int seed_;
+    float loops_ratio_;
+    std::size_t corridor_width_;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "utils/Renderer.hpp"
+#include "utils/TextManager.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/PathfinderStats.hpp"
+
+// Debug view of the pathfinding stats: the cells explored by the searches behind
+// the ghosts' last paths, and per ghost and per source averages over the stats
+// ring buffer.
+class PathfinderOverlay {
+public:
+    PathfinderOverlay(Renderer& renderer, TextManager& text_manager);
+
+    // Under the sprites, at the map's cell size.
+    void RenderCells(const PathfinderStats& stats, const Pathfinder& scheduler_pathfinder);
+    void RenderStats(const PathfinderStats& stats);
+
+private:
+    Renderer& renderer_;
+    TTF_Font* font_;
+
+    void RenderLine(const char* name, const PathfinderStats::Totals& totals, std::size_t ticks_count, int y);
+};
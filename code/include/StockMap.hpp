@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CollectableSpawns.hpp"
+#include "Constants.hpp"
+#include "GameMap.hpp"
+#include "MapGeometry.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The built-in maze of kMapTiles and kMapCollectables, checked and precomputed at
+// compile time: a broken edit of the tables fails the build instead of the game.
+using StockMapGeometry = StaticMapGeometry<kColsCount, kRowsCount, kCellSize>;
+
+constexpr bool IsStockMapColRowWalkable(Vec2<int> col_row) {
+    return StockMapGeometry::AreColRowInsideBoundaries(col_row) && kMapTiles[col_row.y][col_row.x] == 0;
+}
+
+// Row by row, as MapLayout has them.
+static constexpr auto kStockMapTiles = [] {
+    std::array<std::uint8_t, StockMapGeometry::GetCellsCount()> tiles {};
+    for (std::size_t index = 0; index < tiles.size(); ++index) {
+        const auto [row, col] = StockMapGeometry::FromIndexToColRow(index);
+        tiles[index] = static_cast<std::uint8_t>(kMapTiles[row][col]);
+    }
+    return tiles;
+}();
+
+static constexpr auto kStockMapCollectables = [] {
+    std::array<std::uint8_t, StockMapGeometry::GetCellsCount()> collectables {};
+    for (std::size_t index = 0; index < collectables.size(); ++index) {
+        const auto [row, col] = StockMapGeometry::FromIndexToColRow(index);
+        collectables[index] = static_cast<std::uint8_t>(kMapCollectables[row][col]);
+    }
+    return collectables;
+}();
+
+// What GameMap::GetExits() returns for the stock maze.
+static constexpr auto kStockMapExits = [] {
+    std::array<std::uint8_t, StockMapGeometry::GetCellsCount()> exits {};
+    for (std::size_t index = 0; index < exits.size(); ++index) {
+        const auto [row, col] = StockMapGeometry::FromIndexToColRow(index);
+        exits[index] = GameMap::ComputeExits(Vec2{col, row}, IsStockMapColRowWalkable);
+    }
+    return exits;
+}();
+
+// From the map's top left corner, without the padding.
+static constexpr auto kStockMapCellCenters = [] {
+    std::array<Vec2<float>, StockMapGeometry::GetCellsCount()> centers {};
+    for (std::size_t index = 0; index < centers.size(); ++index) {
+        const auto [row, col] = StockMapGeometry::FromIndexToColRow(index);
+        centers[index] = StockMapGeometry::GetCellCenter(Vec2{col, row});
+    }
+    return centers;
+}();
+
+static constexpr std::size_t kStockMapCollectableSpawnsCount = [] {
+    std::size_t spawns_count = 0;
+    ForEachCollectableSpawn(StockMapGeometry{}, kStockMapCollectables, [&spawns_count](const CollectableSpawn&) { ++spawns_count; });
+    return spawns_count;
+}();
+
+static constexpr auto kStockMapCollectableSpawns = [] {
+    std::array<CollectableSpawn, kStockMapCollectableSpawnsCount> spawns {};
+    std::size_t spawns_count = 0;
+    ForEachCollectableSpawn(StockMapGeometry{}, kStockMapCollectables, [&](const CollectableSpawn& spawn) { spawns[spawns_count++] = spawn; });
+    return spawns;
+}();
+
+constexpr bool AreStockMapTilesValid() {
+    for (const auto tile : kStockMapTiles) {
+        if (tile > 1) return false;
+    }
+    return true;
+}
+
+constexpr bool AreStockMapCollectablesValid() {
+    for (std::size_t index = 0; index < kStockMapCollectables.size(); ++index) {
+        if (kStockMapCollectables[index] > 2) return false;
+        if (kStockMapCollectables[index] != 0 && kStockMapTiles[index] != 0) return false;
+    }
+    return true;
+}
+
+// Every walkable cell is reachable from every other one, through the exits.
+constexpr bool IsStockMapConnected() {
+    std::array<bool, StockMapGeometry::GetCellsCount()> is_reached {};
+    std::array<std::size_t, StockMapGeometry::GetCellsCount()> queue {};
+    std::size_t queue_size = 0;
+    for (std::size_t index = 0; index < kStockMapTiles.size() && queue_size == 0; ++index) {
+        if (kStockMapTiles[index] != 0) continue;
+        is_reached[index] = true;
+        queue[queue_size++] = index;
+    }
+
+    constexpr std::array<Vec2<int>, 4> kOffsets {Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    for (std::size_t head = 0; head < queue_size; ++head) {
+        const auto [row, col] = StockMapGeometry::FromIndexToColRow(queue[head]);
+        for (std::size_t exit = 0; exit < kOffsets.size(); ++exit) {
+            if (!(kStockMapExits[queue[head]] & (1 << exit))) continue;
+
+            const auto neighbour = StockMapGeometry::FromColRowToIndex(Vec2{col, row} + kOffsets[exit]);
+            if (is_reached[neighbour]) continue;
+            is_reached[neighbour] = true;
+            queue[queue_size++] = neighbour;
+        }
+    }
+
+    for (std::size_t index = 0; index < kStockMapTiles.size(); ++index) {
+        if (kStockMapTiles[index] == 0 && !is_reached[index]) return false;
+    }
+    return true;
+}
+
+static_assert(AreStockMapTilesValid(), "kMapTiles holds 0 for a walkable cell and 1 for a wall");
+static_assert(AreStockMapCollectablesValid(), "kMapCollectables holds 0, 1 or 2, and only on walkable cells");
+static_assert(IsStockMapColRowWalkable(kHousesDoorColRow), "kHousesDoorColRow must be a walkable cell of kMapTiles");
+static_assert(IsStockMapConnected(), "Every walkable cell of kMapTiles must be reachable");
+static_assert(kStockMapCollectableSpawnsCount > 0, "kMapCollectables has nothing to collect");
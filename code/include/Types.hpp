@@ -6,9 +6,6 @@
 #include <optional>
 
 class Ghost;
-class Collectable;
 
 using GhostList = std::array<std::unique_ptr<Ghost>, 4>;
-using OptionalGhostReference = std::optional<std::reference_wrapper<const Ghost>>;
-
-using CollectableList = std::vector<std::unique_ptr<Collectable>>;
\ No newline at end of file
+using OptionalGhostReference = std::optional<std::reference_wrapper<const Ghost>>;
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+#include "pathfinder/Pathfinder.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class GameMap;
+
+// Solves a batch of (from, to) queries on a pool of workers. Every worker owns
+// a Pathfinder, so only the map is shared and it's only read: it must not change
+// while a batch runs. The calling thread works on the batch as well.
+//
+// A path only depends on its query, so the results are the same as solving the
+// queries one by one with a Pathfinder, whatever the workers count.
+class BatchPathfinder {
+public:
+    using Query = std::pair<Vec2<int>, Vec2<int>>;
+
+    // Zero workers takes one per hardware thread.
+    explicit BatchPathfinder(const GameMap& map, std::size_t workers_count = 0);
+    ~BatchPathfinder();
+
+    BatchPathfinder(const BatchPathfinder&) = delete;
+    BatchPathfinder& operator=(const BatchPathfinder&) = delete;
+
+    // Blocks until every query is solved; paths[i] answers queries[i].
+    void FindPaths(std::span<const Query> queries, std::vector<IPathfinder::Path>& paths);
+
+    // The calling thread included.
+    std::size_t GetWorkersCount() const;
+
+private:
+    // Queries a worker claims at once, so the shared counter isn't hit per query.
+    static constexpr std::size_t kQueriesPerClaim = 8;
+
+    std::vector<Pathfinder> pathfinders_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable batch_ready_;
+    std::condition_variable batch_done_;
+    std::uint64_t batch_;
+    std::size_t busy_workers_count_;
+    bool is_stopping_;
+
+    std::span<const Query> queries_;
+    std::vector<IPathfinder::Path>* paths_;
+    std::atomic<std::size_t> next_query_;
+
+    void RunWorker(std::size_t worker);
+    void SolveQueries(Pathfinder& pathfinder);
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class GameMap;
+
+// Breadth-first flood over the map walkability packed one bit per cell into
+// 64-bit words, row by row. Each level grows the frontier a whole word at a time
+// with shifts and masks, so 64 cells cost one expansion instead of 64 queue pops.
+// Sparse frontiers only expand the words around the current one; wide ones sweep
+// the rows they span, with AVX2 when the build has it.
+//
+// The distances are the same as a scalar BFS from the target.
+class BitboardFlood {
+public:
+    static constexpr std::uint32_t kUnreachable = 0xFFFFFFFF;
+
+    explicit BitboardFlood(const GameMap& map);
+
+    // Distance from the target to every cell, kUnreachable for walls and cells
+    // it can't reach.
+    void Flood(Vec2<int> col_row_target, std::vector<std::uint32_t>& distances);
+
+    // Levels expanded by the last flood, and how many of them swept whole rows.
+    std::size_t GetLevelsCount() const;
+    std::size_t GetDenseLevelsCount() const;
+
+private:
+    const GameMap& map_;
+    bool is_built_;
+    std::uint64_t version_;
+
+    std::size_t columns_count_;
+    std::size_t rows_count_;
+    // Every row has at least one padding bit at its end, so the shifts carrying
+    // bits across words never carry from one row into the next.
+    std::size_t words_per_row_;
+    // Index of row 0's first word: a zero row goes before the map, another one
+    // after it, so neighbour words can be read without bound checks.
+    std::size_t first_word_;
+
+    std::vector<std::uint64_t> walkable_;
+    std::vector<std::uint64_t> visited_;
+    std::vector<std::uint64_t> frontier_;
+    std::vector<std::uint64_t> next_frontier_;
+    // Words with bits set in frontier_ and next_frontier_, the rest are zero.
+    std::vector<std::uint32_t> frontier_words_;
+    std::vector<std::uint32_t> next_frontier_words_;
+    std::vector<std::uint32_t> word_marks_;
+    std::uint32_t word_mark_;
+
+    std::size_t levels_count_;
+    std::size_t dense_levels_count_;
+
+    void Sync();
+    void Build();
+    void ExpandSparse(std::uint32_t level, std::vector<std::uint32_t>& distances);
+    void ExpandDense(std::size_t first_word, std::size_t last_word, std::uint32_t level, std::vector<std::uint32_t>& distances);
+    std::uint64_t ExpandWord(std::size_t word) const;
+    void AddNextWord(std::size_t word, std::uint64_t bits, std::uint32_t level, std::vector<std::uint32_t>& distances);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Dial's bucket queue for small integer priorities, as A* gets with unit
+// edge costs and a consistent heuristic. Every queued priority has to stay
+// within [lowest queued priority, lowest queued priority + kBucketsCount).
+//
+// Each bucket is a two-level bitset over node ids, so Pop() returns the lowest
+// id among the lowest priority: the same order as an IndexedHeap keyed by
+// (priority, id), without comparing keys.
+class BucketQueue {
+public:
+    static constexpr std::uint32_t kBucketsCount = 4;
+
+    void Reserve(std::size_t capacity);
+    void Clear();
+
+    bool Empty() const;
+    std::size_t Size() const;
+    bool Contains(std::uint32_t id) const;
+
+    void Push(std::uint32_t id, std::uint32_t priority);
+    void DecreaseKey(std::uint32_t id, std::uint32_t priority);
+    std::uint32_t Pop();
+
+private:
+    struct Bucket {
+        std::vector<std::uint64_t> words;
+        std::vector<std::uint64_t> summary;
+        std::size_t size {0};
+        std::size_t first_summary_word {std::numeric_limits<std::size_t>::max()};
+    };
+
+    std::array<Bucket, kBucketsCount> buckets_;
+    std::vector<std::uint32_t> priorities_;
+    std::size_t size_ {0};
+    std::uint32_t lowest_priority_ {0};
+
+    Bucket& GetBucket(std::uint32_t priority);
+    const Bucket& GetBucket(std::uint32_t priority) const;
+
+    void Insert(Bucket& bucket, std::uint32_t id);
+    void Erase(Bucket& bucket, std::uint32_t id);
+    std::uint32_t PopLowestId(Bucket& bucket);
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "utils/MemoryMappedFile.hpp"
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class GameMap;
+
+// Compressed path database: the first move of a shortest path from every walkable
+// cell to every walkable cell, without the cells^2 memory of PathTable.
+//
+// Targets are numbered in depth-first order, so cells close in the maze get close
+// numbers and share first moves. Each source row stores runs of (first target,
+// move) over that order. A target usually has several optimal first moves, and a
+// run goes on while one move is optimal for all its targets; walls and targets the
+// source can't reach fit any run. Lookups binary search the source's runs.
+//
+// Building takes a BFS per walkable cell, so it's done offline on a pool of
+// workers and saved next to the map. Loading maps the file instead of reading it:
+// only the rows the queries touch get paged in. The file is native endian and
+// only loads against the walkability it was built for.
+//
+// Moves are optimal but ties don't always break the way Pathfinder's do: paths
+// have the length of the Pathfinder ones, not always the same cells.
+class CompressedPathDatabase : public IPathfinder {
+public:
+    // Same order as the Pathfinder neighbours: east, west, north, south.
+    enum class EMove : std::uint8_t {
+        EAST = 0,
+        WEST = 1,
+        NORTH = 2,
+        SOUTH = 3,
+        NONE = 0xFF
+    };
+
+    CompressedPathDatabase(const GameMap& map, IPathfinder& fallback);
+
+    // Zero workers takes one per hardware thread, the calling thread included.
+    void Build(std::size_t workers_count = 0);
+    // False when the file is missing, corrupt or built for other walls.
+    bool Load(const std::string& file_path);
+    bool Save(const std::string& file_path) const;
+    // Loads the file, or builds and saves it when it can't be loaded.
+    bool LoadOrBuild(const std::string& file_path, std::size_t workers_count = 0);
+    // Built or loaded, and the map still has the walls it was built for.
+    bool IsValid();
+
+    using IPathfinder::FindPath;
+    // Walls, unreachable targets and a changed map go through the fallback.
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+    // NONE when the cells are the same, walls, not connected, or the database isn't valid.
+    EMove GetFirstMove(Vec2<int> col_row_from, Vec2<int> col_row_to);
+
+    double GetBuildSeconds() const;
+    std::size_t GetRunsCount() const;
+    // What Save() writes, header included.
+    std::size_t GetFileSize() const;
+    // Heap owned by a built database; a loaded one lives in the mapped file.
+    std::size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::uint32_t kNoPosition = 0xFFFFFFFF;
+    // A run packs its first target position over the move's 2 bits.
+    static constexpr std::uint32_t kMaxPositionsCount = 1u << 30;
+
+    struct FileHeader {
+        std::uint32_t magic;
+        std::uint32_t format_version;
+        std::uint32_t columns_count;
+        std::uint32_t rows_count;
+        std::uint64_t map_hash;
+        std::uint32_t positions_count;
+        std::uint32_t padding;
+        std::uint64_t runs_count;
+    };
+
+    const GameMap& map_;
+    IPathfinder& fallback_;
+    bool is_valid_;
+    double build_seconds_;
+
+    // The map the database answers for, checked again when its version changes.
+    std::uint64_t version_;
+    std::uint64_t map_hash_;
+    std::size_t columns_count_;
+    std::size_t rows_count_;
+
+    // Views over the built vectors or over the mapped file.
+    std::span<const std::uint64_t> row_offsets_;
+    std::span<const std::uint32_t> cell_positions_;
+    std::span<const std::uint32_t> components_;
+    std::span<const std::uint32_t> runs_;
+
+    std::vector<std::uint64_t> built_row_offsets_;
+    std::vector<std::uint32_t> built_cell_positions_;
+    std::vector<std::uint32_t> built_components_;
+    std::vector<std::uint32_t> built_runs_;
+    MemoryMappedFile file_;
+
+    void Sync();
+    void Clear();
+    std::uint64_t HashMap() const;
+    bool AreTablesValid() const;
+    // Depth-first numbering of the walkable cells, one component after the other.
+    std::vector<std::uint32_t> NumberCells(std::vector<std::uint32_t>& components) const;
+    EMove LookUpMove(std::uint32_t from_position, std::uint32_t to_position) const;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+#include "pathfinder/IndexedHeap.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class GameMap;
+
+// The maze collapsed into a weighted graph: junctions are the walkable cells
+// without exactly two walkable neighbours (crossings, T's and dead ends), and
+// segments are the corridors of two-neighbour cells between them, weighted by
+// their length. A* runs over the junctions only and the result is expanded back
+// into cells. Wall targets and unreachable targets go through the fallback.
+//
+// When the map version changes only the segments and junctions around the
+// toggled cells are rebuilt.
+class CorridorGraph : public IPathfinder {
+public:
+    CorridorGraph(const GameMap& map, IPathfinder& fallback);
+
+    void Build();
+
+    using IPathfinder::FindPath;
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+
+    std::size_t GetJunctionsCount() const;
+    std::size_t GetSegmentsCount() const;
+    // Junctions taken out of the open list by the last search.
+    std::size_t GetExpandedNodesCount() const;
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = IndexedHeap<std::uint64_t>::kInvalidId;
+
+    struct Junction {
+        std::uint32_t cell_index {kInvalidIndex};
+        // Segment leaving through each neighbour, in east, west, north, south order.
+        std::array<std::uint32_t, 4> segments {kInvalidIndex, kInvalidIndex, kInvalidIndex, kInvalidIndex};
+    };
+
+    struct Segment {
+        std::uint32_t from_junction {kInvalidIndex};
+        std::uint32_t to_junction {kInvalidIndex};
+        std::uint8_t from_direction {0};
+        std::uint8_t to_direction {0};
+        // Corridor cells in order from from_junction, the junctions excluded.
+        std::vector<std::uint32_t> cells;
+
+        std::uint32_t GetWeight() const { return static_cast<std::uint32_t>(cells.size()) + 1; }
+    };
+
+    struct SearchNode {
+        std::uint32_t generation {0};
+        std::uint32_t parent {kInvalidIndex};
+        std::uint32_t parent_segment {kInvalidIndex};
+        std::uint32_t g {0};
+    };
+
+    const GameMap& map_;
+    IPathfinder& fallback_;
+
+    std::vector<Junction> junctions_;
+    std::vector<Segment> segments_;
+    std::vector<std::uint32_t> free_junctions_;
+    std::vector<std::uint32_t> free_segments_;
+    std::size_t junctions_count_;
+    std::size_t segments_count_;
+
+    // Per cell: the junction on it, or the segment it belongs to and its 1-based
+    // position inside it (the distance from the segment's from_junction).
+    std::vector<std::uint32_t> cell_junctions_;
+    std::vector<std::uint32_t> cell_segments_;
+    std::vector<std::uint32_t> cell_offsets_;
+
+    // The map version the graph was built against.
+    std::uint64_t version_;
+
+    // One node per junction slot plus the goal, which stands for the target cell.
+    std::vector<SearchNode> search_nodes_;
+    IndexedHeap<std::uint64_t> open_nodes_;
+    std::uint32_t generation_;
+    std::size_t expanded_nodes_count_;
+    // Junctions of the last path, from the target back to the start.
+    std::vector<std::uint32_t> path_junctions_;
+
+    void Sync();
+    void Repair(const std::vector<std::uint32_t>& changed_cells);
+    void TraceMissingSegments(const std::vector<std::uint32_t>& cells);
+
+    bool IsJunctionCell(std::uint32_t cell_index) const;
+    std::uint32_t GetNeighbourIndex(std::uint32_t cell_index, std::size_t direction) const;
+    std::uint32_t AddJunction(std::uint32_t cell_index);
+    // Both append the cells that need tracing again: the released corridor cells
+    // and the junctions left with an open direction.
+    void RemoveJunction(std::uint32_t junction, std::vector<std::uint32_t>& released_cells);
+    void RemoveSegment(std::uint32_t segment, std::vector<std::uint32_t>& released_cells);
+    void TraceSegment(std::uint32_t junction, std::size_t direction);
+
+    bool Search(std::uint32_t from_index, std::uint32_t to_index);
+    bool Relax(std::uint32_t node, std::uint32_t parent, std::uint32_t parent_segment, std::uint32_t g, std::uint32_t h);
+    int Heuristic(std::uint32_t cell_index, Vec2<int> col_row_to) const;
+    std::uint32_t GetSegmentCell(const Segment& segment, std::uint32_t offset) const;
+    void AppendSegmentCells(Path& path, std::uint32_t segment, std::uint32_t from_offset, std::uint32_t to_offset) const;
+    void ExpandPath(std::uint32_t from_index, std::uint32_t to_index, Path& path);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/BitboardFlood.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class GameMap;
+
+// BFS distance from one target cell to every cell of the map. It floods again
+// only when the target changes cell or the map version changes, and then any
+// number of chasers follow its gradient in O(1) per step.
+class DistanceField {
+public:
+    static constexpr std::uint32_t kUnreachable = std::numeric_limits<std::uint32_t>::max();
+    static_assert(kUnreachable == BitboardFlood::kUnreachable);
+
+    enum class EFlood {
+        AUTO,      // With AVX2, bitboard from kBitboardMinCellsCount cells on. Scalar otherwise.
+        SCALAR,
+        BITBOARD
+    };
+
+    DistanceField(const GameMap& map, EFlood flood = EFlood::AUTO);
+
+    void Update(Vec2<int> col_row_target);
+
+    bool IsReachable(Vec2<int> col_row) const;
+    std::uint32_t GetDistance(Vec2<int> col_row) const;
+    // Walkable neighbour one step closer to the target. The cell itself when it's
+    // the target or it can't reach it.
+    Vec2<int> GetNextStep(Vec2<int> col_row) const;
+    // {col_row_from, next step}, or just {col_row_from} at the target.
+    void FindPath(Vec2<int> col_row_from, Pathfinder::Path& path) const;
+
+    Vec2<int> GetTarget() const;
+    std::size_t GetFloodsCount() const;
+
+    // Takes effect on the next flood.
+    void SetFlood(EFlood flood);
+    EFlood GetFlood() const;
+
+private:
+    // Below this the queue is about as fast and the bitboards aren't worth their memory.
+    static constexpr std::size_t kBitboardMinCellsCount = 64 * 64;
+
+    const GameMap& map_;
+    EFlood flood_;
+    BitboardFlood bitboard_flood_;
+    Vec2<int> col_row_target_;
+    std::uint64_t version_;
+    bool is_flooded_;
+    std::size_t floods_count_;
+    std::vector<std::uint32_t> distances_;
+    std::vector<std::uint32_t> queue_;
+
+    void Flood();
+    void FloodScalar();
+};
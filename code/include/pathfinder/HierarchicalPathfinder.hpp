@@ -0,0 +1,142 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+#include "pathfinder/IndexedHeap.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class GameMap;
+
+// HPA*: the map is cut into square clusters, and every run of walkable cells
+// along a border between two clusters gets an entrance, one node on each side.
+// Nodes of the same cluster are linked by their distance inside it, and nodes
+// of an entrance by a single step. Queries link the start and target to the
+// nodes of their clusters, search that abstract graph, and refine only its first
+// segments back into cells; ghosts ask again from their next cell anyway.
+//
+// Paths are close to the shortest, not always the shortest. Wall targets and
+// unreachable targets go through the fallback. When the map version changes only
+// the clusters holding the cells in the map's journal, and their neighbours'
+// entrances, are rebuilt.
+class HierarchicalPathfinder : public IPathfinder {
+public:
+    static constexpr std::size_t kDefaultClusterSize = 16;
+
+    HierarchicalPathfinder(const GameMap& map, IPathfinder& fallback, std::size_t cluster_size = kDefaultClusterSize);
+
+    void Build();
+
+    // The path ends where the refinement stopped, when there are more segments.
+    using IPathfinder::FindPath;
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+
+    // Abstract segments turned into cells per query, 0 refines the whole path.
+    void SetRefinedSegmentsCount(std::size_t refined_segments_count);
+    std::size_t GetRefinedSegmentsCount() const;
+
+    std::size_t GetClustersCount() const;
+    std::size_t GetNodesCount() const;
+    // Abstract nodes taken out of the open list by the last search.
+    std::size_t GetExpandedNodesCount() const;
+    // Clusters whose nodes and edges the last map change rebuilt.
+    std::size_t GetRebuiltClustersCount() const;
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = IndexedHeap<std::uint64_t>::kInvalidId;
+    static constexpr std::size_t kRefinedSegmentsCount = 2;
+
+    struct Edge {
+        std::uint32_t to_node;
+        std::uint32_t weight;
+    };
+
+    struct Node {
+        std::uint32_t cell_index {kInvalidIndex};
+        std::vector<Edge> edges;
+    };
+
+    // A pair of facing cells, inner_cell in this cluster and outer_cell in its
+    // east or south neighbour.
+    struct Entrance {
+        std::uint32_t inner_cell;
+        std::uint32_t outer_cell;
+    };
+
+    struct Cluster {
+        std::vector<std::uint32_t> nodes;
+        std::vector<Entrance> east_entrances;
+        std::vector<Entrance> south_entrances;
+    };
+
+    struct SearchNode {
+        std::uint32_t generation {0};
+        std::uint32_t parent {kInvalidIndex};
+        std::uint32_t g {0};
+    };
+
+    // A node of a cluster and its distance inside it to the start or the target.
+    struct Link {
+        std::uint32_t node;
+        std::uint32_t distance;
+    };
+
+    const GameMap& map_;
+    IPathfinder& fallback_;
+    const std::size_t cluster_size_;
+    std::size_t refined_segments_count_;
+
+    std::size_t cluster_columns_count_;
+    std::size_t cluster_rows_count_;
+    std::vector<Cluster> clusters_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> free_nodes_;
+    std::size_t nodes_count_;
+    std::vector<std::uint32_t> cell_nodes_;
+
+    // The map version the clusters were built against.
+    std::uint64_t version_;
+    std::size_t rebuilt_clusters_count_;
+
+    // Breadth-first search inside one cluster, indexed by the cell offset in it.
+    std::vector<std::uint32_t> local_generations_;
+    std::vector<std::uint32_t> local_distances_;
+    std::vector<std::uint32_t> local_parents_;
+    std::vector<std::uint32_t> local_queue_;
+    std::uint32_t local_generation_;
+
+    // One node per node slot plus the goal, which stands for the target cell.
+    std::vector<SearchNode> search_nodes_;
+    IndexedHeap<std::uint64_t> open_nodes_;
+    std::uint32_t generation_;
+    std::vector<Link> start_links_;
+    std::vector<Link> goal_links_;
+    std::vector<std::uint32_t> abstract_path_;
+    std::size_t expanded_nodes_count_;
+
+    void Sync();
+    void Rebuild(const std::vector<std::uint32_t>& dirty_clusters);
+    void FindEntrances(std::uint32_t cluster);
+    void AddBorderEntrances(std::vector<Entrance>& entrances, std::uint32_t first_cell, std::uint32_t step, std::uint32_t across, std::size_t length);
+    void RebuildNodes(std::uint32_t cluster);
+    void RebuildEdges(std::uint32_t cluster);
+    template <typename Visitor>
+    void ForEachBorderEntrance(std::uint32_t cluster, Visitor&& visitor) const;
+
+    std::uint32_t GetCluster(std::uint32_t cell_index) const;
+    // {col, row} of the cluster's first cell and {cols, rows} of its size.
+    std::pair<Vec2<int>, Vec2<int>> GetClusterBounds(std::uint32_t cluster) const;
+    void FloodCluster(std::uint32_t cluster, std::uint32_t from_cell);
+    std::uint32_t GetLocalIndex(std::uint32_t cell_index) const;
+    std::uint32_t GetLocalDistance(std::uint32_t cell_index) const;
+    void LinkCell(std::uint32_t cell_index, std::vector<Link>& links);
+    bool AppendLocalPath(Path& path, std::uint32_t cluster, std::uint32_t from_cell, std::uint32_t to_cell);
+
+    bool Search(std::uint32_t from_index, std::uint32_t to_index);
+    void Relax(std::uint32_t node, std::uint32_t parent, std::uint32_t g, std::uint32_t h);
+    std::uint32_t Heuristic(std::uint32_t cell_index, std::uint32_t to_index) const;
+    void RefinePath(std::uint32_t from_index, std::uint32_t to_index, Path& path);
+};
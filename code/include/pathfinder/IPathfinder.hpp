@@ -0,0 +1,24 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include <vector>
+
+class IPathfinder {
+public:
+    using Path = std::vector<Vec2<int>>;
+
+    virtual ~IPathfinder() = default;
+
+    // Cells from col_row_from to col_row_to, both included. When the target can't be
+    // reached the path ends at the closest reachable cell. The path is overwritten
+    // and its storage reused, so callers keeping one buffer don't allocate.
+    virtual void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) = 0;
+
+    // Same, into a new vector.
+    Path FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to) {
+        Path path;
+        FindPath(col_row_from, col_row_to, path);
+        return path;
+    }
+};
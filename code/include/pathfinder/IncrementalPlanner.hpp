@@ -0,0 +1,83 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+#include "pathfinder/IndexedHeap.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class GameMap;
+class Renderer;
+
+// A* for one chaser that keeps its search tree between calls. When the chaser
+// moves to a cell inside the tree, the subtree under that cell is kept with its
+// g-values rebased (they're still exact) and the rest is dropped; when the target
+// moves, the search goes on from the fringe of the kept cells with the heuristic
+// towards the new target. Only cells outside the kept tree are expanded again.
+//
+// Any other start move or a map version change searches from scratch. Wall start
+// or target cells and unreachable targets go through the fallback.
+class IncrementalPlanner : public IPathfinder {
+public:
+    IncrementalPlanner(const GameMap& map, IPathfinder& fallback);
+
+    using IPathfinder::FindPath;
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+
+    // Drops the search tree, the next query searches from scratch.
+    void Reset();
+
+    // Cells taken out of the open list by the last call, and by every call.
+    std::size_t GetExpandedNodesCount() const;
+    std::size_t GetTotalExpandedNodesCount() const;
+    // Cells kept from the previous search tree by the last call.
+    std::size_t GetReusedNodesCount() const;
+    // Largest open list of the last call, only tracked with PACMAN_PATHFINDER_STATS.
+    std::size_t GetOpenNodesPeakCount() const;
+
+    // Closed and open cells of the current tree, then its start and goal.
+    void Render(Renderer& renderer) const;
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = IndexedHeap<std::uint64_t>::kInvalidId;
+
+    struct SearchNode {
+        std::uint32_t generation {0};
+        std::uint32_t parent {kInvalidIndex};
+        std::uint32_t g {0};
+        bool is_closed {false};
+    };
+
+    const GameMap& map_;
+    IPathfinder& fallback_;
+    bool is_initialized_;
+    std::uint64_t version_;
+
+    std::vector<SearchNode> nodes_;
+    // Closed cells in the order they were closed, so parents come before children.
+    std::vector<std::uint32_t> closed_cells_;
+    IndexedHeap<std::uint64_t> open_nodes_;
+    // Cells of the previous tree that may border the kept subtree.
+    std::vector<std::uint32_t> fringe_candidates_;
+    std::uint32_t generation_;
+    std::uint32_t start_index_;
+    std::uint32_t goal_index_;
+
+    std::size_t expanded_nodes_count_;
+    std::size_t total_expanded_nodes_count_;
+    std::size_t reused_nodes_count_;
+    std::size_t open_nodes_peak_count_;
+
+    void Restart(std::uint32_t start_index);
+    void Rebase(std::uint32_t start_index);
+    bool Search();
+    void Relax(std::uint32_t index, std::uint32_t parent, std::uint32_t g);
+    bool IsVisited(std::uint32_t index) const;
+    bool IsClosed(std::uint32_t index) const;
+    bool NextGeneration();
+    std::uint32_t Heuristic(std::uint32_t index) const;
+    std::uint32_t GetNeighbourIndex(std::uint32_t index, std::size_t direction) const;
+    void ReconstructPath(Path& path) const;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Binary min-heap of node ids in [0, capacity) with O(log n) decrease-key.
+// Positions are validated against the heap itself, so Clear() is O(1).
+template<typename Key>
+class IndexedHeap {
+public:
+    static constexpr std::uint32_t kInvalidId = std::numeric_limits<std::uint32_t>::max();
+
+    void Reserve(std::size_t capacity);
+    void Clear();
+
+    bool Empty() const;
+    std::size_t Size() const;
+    bool Contains(std::uint32_t id) const;
+    // Ids in heap order, not sorted.
+    std::uint32_t GetId(std::size_t position) const;
+
+    void Push(std::uint32_t id, Key key);
+    void DecreaseKey(std::uint32_t id, Key key);
+    std::uint32_t Pop();
+
+private:
+    struct Entry {
+        Key key;
+        std::uint32_t id;
+    };
+
+    std::vector<Entry> heap_;
+    std::vector<std::uint32_t> positions_;
+
+    void SiftUp(std::size_t position);
+    void SiftDown(std::size_t position);
+    void Place(std::size_t position, Entry entry);
+};
+
+template<typename Key>
+void IndexedHeap<Key>::Reserve(std::size_t capacity) {
+    positions_.resize(capacity, kInvalidId);
+    heap_.reserve(capacity);
+}
+
+template<typename Key>
+void IndexedHeap<Key>::Clear() {
+    heap_.clear();
+}
+
+template<typename Key>
+bool IndexedHeap<Key>::Empty() const {
+    return heap_.empty();
+}
+
+template<typename Key>
+std::size_t IndexedHeap<Key>::Size() const {
+    return heap_.size();
+}
+
+template<typename Key>
+bool IndexedHeap<Key>::Contains(std::uint32_t id) const {
+    const auto position = positions_[id];
+    return (position < heap_.size() && heap_[position].id == id);
+}
+
+template<typename Key>
+std::uint32_t IndexedHeap<Key>::GetId(std::size_t position) const {
+    return heap_[position].id;
+}
+
+template<typename Key>
+void IndexedHeap<Key>::Push(std::uint32_t id, Key key) {
+    heap_.push_back({key, id});
+    positions_[id] = static_cast<std::uint32_t>(heap_.size() - 1);
+    SiftUp(heap_.size() - 1);
+}
+
+template<typename Key>
+void IndexedHeap<Key>::DecreaseKey(std::uint32_t id, Key key) {
+    const auto position = positions_[id];
+    heap_[position].key = key;
+    SiftUp(position);
+}
+
+template<typename Key>
+std::uint32_t IndexedHeap<Key>::Pop() {
+    const auto id = heap_.front().id;
+    const auto last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        Place(0, last);
+        SiftDown(0);
+    }
+
+    return id;
+}
+
+template<typename Key>
+void IndexedHeap<Key>::SiftUp(std::size_t position) {
+    const auto entry = heap_[position];
+    while (position > 0) {
+        const auto parent = (position - 1) / 2;
+        if (!(entry.key < heap_[parent].key)) break;
+
+        Place(position, heap_[parent]);
+        position = parent;
+    }
+    Place(position, entry);
+}
+
+template<typename Key>
+void IndexedHeap<Key>::SiftDown(std::size_t position) {
+    const auto entry = heap_[position];
+    const auto size = heap_.size();
+    while (true) {
+        auto child = position * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heap_[child + 1].key < heap_[child].key) ++child;
+        if (!(heap_[child].key < entry.key)) break;
+
+        Place(position, heap_[child]);
+        position = child;
+    }
+    Place(position, entry);
+}
+
+template<typename Key>
+void IndexedHeap<Key>::Place(std::size_t position, Entry entry) {
+    heap_[position] = entry;
+    positions_[entry.id] = static_cast<std::uint32_t>(position);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class GameMap;
+
+// Least recently used paths in front of a solver, keyed by their start and target
+// cells. Ghosts often ask again for the path they just got, or for the one another
+// ghost on the same cell got, within a tick or across a few.
+//
+// Every path is dropped when the map version changes. Entries keep their path
+// storage when they're evicted, so a full cache doesn't allocate either.
+class PathCache : public IPathfinder {
+public:
+    PathCache(const GameMap& map, IPathfinder& solver, std::size_t capacity);
+
+    using IPathfinder::FindPath;
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+
+    // The cached path, for callers running their own search on a miss.
+    bool Lookup(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path);
+    void Insert(Vec2<int> col_row_from, Vec2<int> col_row_to, const Path& path);
+    void Clear();
+
+    // Drops every path. A zero capacity disables the cache.
+    void SetCapacity(std::size_t capacity);
+    std::size_t GetCapacity() const;
+    std::size_t GetSize() const;
+
+    std::size_t GetHitsCount() const;
+    std::size_t GetMissesCount() const;
+    std::size_t GetEvictionsCount() const;
+    void ResetCounters();
+
+private:
+    static constexpr std::uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+    struct Entry {
+        std::uint64_t key {0};
+        std::uint32_t previous {kInvalidIndex};
+        std::uint32_t next {kInvalidIndex};
+        Path path;
+    };
+
+    const GameMap& map_;
+    IPathfinder& solver_;
+    std::size_t capacity_;
+    std::uint64_t version_;
+
+    std::vector<Entry> entries_;
+    std::unordered_map<std::uint64_t, std::uint32_t> slots_;
+    // Most recently used first.
+    std::uint32_t head_;
+    std::uint32_t tail_;
+
+    std::size_t hits_count_;
+    std::size_t misses_count_;
+    std::size_t evictions_count_;
+
+    void Sync();
+    bool GetKey(Vec2<int> col_row_from, Vec2<int> col_row_to, std::uint64_t& key) const;
+    void Unlink(std::uint32_t entry);
+    void PushFront(std::uint32_t entry);
+};
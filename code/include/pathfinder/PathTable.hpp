@@ -0,0 +1,88 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/IPathfinder.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class GameMap;
+
+// All-pairs next-hop and distance table over the map cells. Paths become table
+// walks instead of searches. Each row holds the first move and the distance from
+// one source cell to every cell, so the table grows with cells^2: maps above
+// max_cells_count, wall targets and unreachable targets go through the fallback.
+//
+// Rows are rebuilt lazily: when the map version changes only the rows that could
+// reach the cells in the map's journal are marked dirty, and they're rebuilt on
+// first use.
+//
+// Tables over maps of the same MapAsset can share their rows: built once, against
+// the asset, and copied by a table before it changes them.
+class PathTable : public IPathfinder {
+public:
+    struct Rows;
+
+    // Rows shared by another table are taken instead of building them when they were
+    // built against the map's asset. The map's changes since are repaired as usual.
+    PathTable(const GameMap& map, IPathfinder& fallback, std::size_t max_cells_count, std::shared_ptr<const Rows> rows = nullptr);
+
+    void Build();
+    bool IsEnabled() const;
+
+    using IPathfinder::FindPath;
+    void FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) override;
+    // kUnreachable when there is no path or the table is disabled.
+    std::uint16_t GetDistance(Vec2<int> col_row_from, Vec2<int> col_row_to);
+
+    // Null when the table is disabled or the rows were built after the map changed.
+    // From then on the table copies the rows before changing them.
+    std::shared_ptr<const Rows> ShareRows();
+
+    // Shared rows aren't counted.
+    std::size_t GetMemoryUsage() const;
+    std::size_t GetDirtyRowsCount() const;
+
+    static constexpr std::uint16_t kUnreachable = 0xFFFF;
+
+private:
+    // Same order as the Pathfinder neighbours: east, west, north, south.
+    enum class EHop : std::uint8_t {
+        EAST = 0,
+        WEST = 1,
+        NORTH = 2,
+        SOUTH = 3,
+        NONE = 0xFF
+    };
+
+    const GameMap& map_;
+    IPathfinder& fallback_;
+    const std::size_t max_cells_count_;
+    bool is_enabled_;
+
+    std::size_t cells_count_;
+    std::shared_ptr<const Rows> rows_;
+    // Null while the rows are shared.
+    Rows* owned_rows_;
+    const EHop* next_hops_;
+    const std::uint16_t* distances_;
+    std::vector<std::uint8_t> dirty_rows_;
+    std::size_t dirty_rows_count_;
+
+    // The map version the rows were built against.
+    std::uint64_t version_;
+    std::vector<std::uint32_t> changed_cells_;
+
+    std::vector<std::uint32_t> queue_;
+
+    bool AdoptRows(std::shared_ptr<const Rows> rows);
+    Rows& GetOwnedRows();
+    void Sync();
+    void InvalidateCell(std::size_t cell_index);
+    void MarkRowDirty(std::size_t row_index);
+    void BuildRow(std::size_t row_index);
+    void EnsureRow(std::size_t row_index);
+    std::size_t GetNeighbourIndex(std::size_t cell_index, EHop hop) const;
+};
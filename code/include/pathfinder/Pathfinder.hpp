@@ -2,71 +2,97 @@
 
 #include "utils/Vec2.hpp"
 
+#include "pathfinder/IPathfinder.hpp"
+#include "pathfinder/IndexedHeap.hpp"
+#include "pathfinder/BucketQueue.hpp"
+
 #include <string>
 #include <vector>
 #include <array>
-#include <set>
-
-#include <SDL2/SDL.h>
+#include <cstdint>
 
 class GameMap;
+class Renderer;
 
-class Pathfinder {
+class Pathfinder : public IPathfinder {
+    static constexpr std::uint32_t kInvalidIndex = IndexedHeap<std::uint64_t>::kInvalidId;
+
+    // Nodes persist between queries. A node whose generation differs from
+    // the pathfinder's one hasn't been touched yet by the current query.
     struct MapNode {
-            std::size_t map_index;
-            int g; // distance from starting_node
-            int h; // heuristic (distance from target node)
-            bool is_open, is_closed;
-            MapNode* parent;
-
-            MapNode(std::size_t map_idx)
-                : map_index(map_idx), g(0), h(0), is_open(false), is_closed(false), parent(nullptr) {}
-
-            int FCost() const { return g + h; }
-
-            void Print() {
-                SDL_Log("MapNode {map_index: %zu, g: %d, h: %d}", map_index, g, h);
-            }
-
-            struct Comparator {
-                int operator()(const MapNode* n1, const MapNode* n2) const {
-                    if (n1->FCost() == n2->FCost()) {
-                        return n1->map_index < n2->map_index;
-                    }
-
-                    return (n1->FCost() < n2->FCost());
-                }
-            };
-        };
+        std::uint32_t generation {0};
+        std::uint32_t parent {kInvalidIndex};
+        std::int32_t g {0}; // distance from starting_node
+        std::int32_t h {0}; // heuristic (distance from target node)
+    };
+
 public:
-    using Path = std::vector<Vec2<int>>;
-    Pathfinder(GameMap& map);
+    enum class EOpenList {
+        AUTO,         // Bucket queue while every edge costs the same, binary heap otherwise.
+        BINARY_HEAP,
+        BUCKET_QUEUE
+    };
 
-    Path FindPath(
+    Pathfinder(const GameMap& map, EOpenList open_list = EOpenList::AUTO);
+
+    using IPathfinder::FindPath;
+    void FindPath(
         Vec2<int> col_row_from,
-        Vec2<int> col_row_to);
+        Vec2<int> col_row_to,
+        Path& path) override;
 
     void Step();
-    void Render(SDL_Renderer& renderer);
+    // Cells the last search closed and left open, then its start and target.
+    void Render(Renderer& renderer) const;
     void Reset(Vec2<int> col_row_from = {}, Vec2<int> col_row_to = {});
     bool DidFinish() const;
+    // Path of the last search once it finished, see IPathfinder::FindPath.
+    void GetPath(Path& path) const;
+
+    // Takes effect on the next Reset().
+    void SetOpenList(EOpenList open_list);
+    EOpenList GetOpenList() const;
+
+    // Nodes taken out of the open list by the last search.
+    std::size_t GetExpandedNodesCount() const;
+    // Largest open list of the last search, only tracked with PACMAN_PATHFINDER_STATS.
+    std::size_t GetOpenNodesPeakCount() const;
 
 private:
-    GameMap& map_;
+    // Every move on the grid costs the same.
+    static constexpr int kEdgeCost = 1;
+    static constexpr bool kHasUniformEdgeCosts = true;
+
+    const GameMap& map_;
     std::vector<MapNode> map_nodes_;
-    std::set<MapNode*, MapNode::Comparator> open_nodes_;
-    std::size_t target_nodes_count_;
+    // Both open lists pop by f-cost first and map index second.
+    EOpenList open_list_;
+    bool is_using_bucket_queue_;
+    IndexedHeap<std::uint64_t> open_nodes_;
+    BucketQueue open_nodes_buckets_;
+    std::uint32_t generation_;
 
-    std::size_t target_index_;
-    Pathfinder::MapNode* target_node_;
+    std::uint32_t target_index_;
+    std::uint32_t target_node_;
 
-    using Neighbours = std::array<MapNode*, 4>;
-    Neighbours GetNeighbours(std::size_t node_index);
+    using Neighbours = std::array<std::uint32_t, 4>;
+    Neighbours GetNeighbours(std::uint32_t node_index) const;
 
     Vec2<int> col_row_from_;
     Vec2<int> col_row_to_;
     bool did_finish_;
+    std::size_t expanded_nodes_count_;
+    std::size_t open_nodes_peak_count_;
 
+    bool IsVisited(const MapNode& node) const;
     int Heuristic(Vec2<int> col_row_left, Vec2<int> col_row_right) const;
-    Path ReconstructPath() const;
+    std::uint64_t MakeOpenKey(const MapNode& node, std::uint32_t node_index) const;
+
+    bool IsUsingBucketQueue() const;
+    bool IsOpenEmpty() const;
+    bool IsOpen(std::uint32_t node_index) const;
+    void PushOpen(std::uint32_t node_index);
+    void DecreaseOpen(std::uint32_t node_index);
+    std::uint32_t PopOpen();
+    void ReconstructPath(Path& path) const;
 };
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class IncrementalPlanner;
+
+// Per-query pathfinding work, summed per ghost and per path source for every
+// update, over the last kTicksCount updates. Only builds with
+// PACMAN_PATHFINDER_STATS record anything; the others never call it.
+class PathfinderStats {
+public:
+    static constexpr std::size_t kTicksCount = 120;
+    static constexpr std::size_t kMaxGhostsCount = 8;
+    static constexpr std::uint32_t kNoGhost = 0xFFFFFFFF;
+
+    // Where a ghost's path came from.
+    enum class ESource : std::uint8_t {
+        DISTANCE_FIELD,
+        UNREACHABLE,
+        PATH_TABLE,
+        PATH_CACHE,
+        PLANNER,
+        SCHEDULER,
+        COUNT
+    };
+
+    struct Query {
+        std::size_t expanded_nodes_count {0};
+        std::size_t open_nodes_peak_count {0};
+        double microseconds {0.0};
+        std::size_t path_length {0};
+    };
+
+    struct Totals {
+        std::size_t queries_count {0};
+        std::size_t expanded_nodes_count {0};
+        std::size_t open_nodes_peak_count {0}; // The biggest one, not a sum.
+        double microseconds {0.0};
+        std::size_t path_cells_count {0};
+
+        void Add(const Query& query);
+        void Add(const Totals& totals);
+    };
+
+    struct Tick {
+        Totals total;
+        std::array<Totals, kMaxGhostsCount> ghosts;
+        std::array<Totals, static_cast<std::size_t>(ESource::COUNT)> sources;
+        // Steps the scheduler spent on queued searches, they're not part of any query.
+        std::size_t scheduler_steps_count {0};
+    };
+
+    // The planner, when there's one, is the solver whose explored cells the overlay draws.
+    std::uint32_t AddGhost(std::string name, const IncrementalPlanner* planner = nullptr);
+    std::size_t GetGhostsCount() const;
+    const std::string& GetGhostName(std::uint32_t ghost) const;
+    const IncrementalPlanner* GetGhostPlanner(std::uint32_t ghost) const;
+    ESource GetGhostLastSource(std::uint32_t ghost) const;
+
+    void Record(std::uint32_t ghost, ESource source, const Query& query);
+    void RecordSchedulerSteps(std::size_t steps_count);
+    // Closes the current update into the ring buffer.
+    void EndTick();
+
+    // 0 is the last closed update. Only GetTicksCount() of them are valid.
+    const Tick& GetTick(std::size_t ticks_ago) const;
+    std::size_t GetTicksCount() const;
+    // Every update of the ring buffer summed.
+    Tick GetWindow() const;
+
+    static const char* GetSourceName(ESource source);
+
+private:
+    struct Ghost {
+        std::string name;
+        const IncrementalPlanner* planner;
+        ESource last_source;
+    };
+
+    std::vector<Ghost> ghosts_;
+    Tick current_tick_;
+    std::array<Tick, kTicksCount> ticks_;
+    std::size_t next_tick_ {0};
+    std::size_t ticks_count_ {0};
+};
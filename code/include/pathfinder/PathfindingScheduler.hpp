@@ -0,0 +1,96 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class GameMap;
+
+// Time-sliced searches: requesters queue (from, to) pairs and Update() steps
+// the front one with its own Pathfinder until the per-update budget runs out,
+// so one huge search or many ghosts asking at once can't blow up a tick. A
+// search that doesn't fit in the budget goes on in the next update.
+//
+// Each requester has at most one request in flight. Asking again while it's
+// queued replaces it. Asking while it's being searched keeps the search when only
+// the start moved, and starts it over for a new target, as a map change does.
+class PathfindingScheduler {
+public:
+    static constexpr std::uint32_t kNoRequester = 0xFFFFFFFF;
+
+    PathfindingScheduler(const GameMap& map, std::chrono::microseconds budget);
+
+    std::uint32_t AddRequester();
+    void Request(std::uint32_t requester, Vec2<int> col_row_from, Vec2<int> col_row_to);
+    // The path found for the requester's last request, once. Empty while it's pending.
+    void TakeResult(std::uint32_t requester, Pathfinder::Path& path);
+    // The target and map version the last result was searched for.
+    Vec2<int> GetResultTarget(std::uint32_t requester) const;
+    std::uint64_t GetResultMapVersion(std::uint32_t requester) const;
+    bool IsPending(std::uint32_t requester) const;
+
+    void Update();
+    // Drops every request and result, the requesters stay.
+    void Clear();
+
+    // A zero budget disables the scheduler: callers search synchronously instead.
+    void SetBudget(std::chrono::microseconds budget);
+    std::chrono::microseconds GetBudget() const;
+    bool IsEnabled() const;
+
+    // Queued requests plus the one being searched.
+    std::size_t GetQueueDepth() const;
+    std::size_t GetMaxQueueDepth() const;
+    std::size_t GetCompletedRequestsCount() const;
+    // Updates between a request and its result.
+    double GetAverageLatencyTicks() const;
+    std::uint64_t GetMaxLatencyTicks() const;
+    // Pathfinder steps spent by the last update.
+    std::size_t GetStepsCount() const;
+    // The search being stepped, or the last one.
+    const Pathfinder& GetPathfinder() const;
+
+private:
+    enum class ERequestState {
+        IDLE,
+        QUEUED,
+        SEARCHING
+    };
+
+    struct Requester {
+        ERequestState state {ERequestState::IDLE};
+        Vec2<int> col_row_from;
+        Vec2<int> col_row_to;
+        std::uint64_t map_version {0};
+        std::uint64_t request_tick {0};
+        Pathfinder::Path result;
+        Vec2<int> result_col_row_to;
+        std::uint64_t result_map_version {0};
+    };
+
+    // Steps between clock reads, a single step is far below a microsecond.
+    static constexpr std::size_t kStepsPerClockCheck = 64;
+
+    const GameMap& map_;
+    Pathfinder pathfinder_;
+    std::chrono::microseconds budget_;
+    std::vector<Requester> requesters_;
+    std::deque<std::uint32_t> queue_;
+    std::uint32_t searching_requester_;
+    std::uint64_t tick_;
+
+    std::size_t max_queue_depth_;
+    std::size_t completed_requests_count_;
+    std::uint64_t total_latency_ticks_;
+    std::uint64_t max_latency_ticks_;
+    std::size_t steps_count_;
+
+    bool StartNextRequest();
+    void RestartSearch();
+    void FinishSearch();
+};
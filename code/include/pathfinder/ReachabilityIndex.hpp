@@ -0,0 +1,52 @@
+#pragma once
+
+#include "utils/Vec2.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class GameMap;
+
+// Per cell: the nearest walkable cell and the connected component it belongs
+// to. Ghost targets that fall on walls are snapped to a walkable cell, and
+// targets in another component are rejected, before any search floods the map
+// looking for them. Rebuilt when the map version changes.
+class ReachabilityIndex {
+public:
+    static constexpr std::uint32_t kNoComponent = std::numeric_limits<std::uint32_t>::max();
+
+    ReachabilityIndex(const GameMap& map);
+
+    void Build();
+
+    // The cell itself when it's walkable or outside the map.
+    Vec2<int> GetNearestWalkable(Vec2<int> col_row);
+    // kNoComponent for walls and cells outside the map.
+    std::uint32_t GetComponent(Vec2<int> col_row);
+    std::size_t GetComponentsCount();
+
+    // Snaps col_row_target to the nearest walkable cell. False when col_row_from
+    // can't reach it, so there is no point in searching.
+    bool ResolveTarget(Vec2<int> col_row_from, Vec2<int>& col_row_target);
+
+    std::size_t GetSnappedTargetsCount() const;
+    std::size_t GetUnreachableTargetsCount() const;
+    // Searches that would have flooded every reachable cell looking for the target.
+    std::size_t GetSavedFloodsCount() const;
+
+private:
+    const GameMap& map_;
+    std::uint64_t version_;
+    std::size_t components_count_;
+    std::vector<std::uint32_t> nearest_walkable_;
+    std::vector<std::uint32_t> components_;
+    std::vector<std::uint32_t> queue_;
+
+    std::size_t snapped_targets_count_;
+    std::size_t unreachable_targets_count_;
+
+    void Sync();
+    void BuildComponents();
+    void BuildNearestWalkable();
+};
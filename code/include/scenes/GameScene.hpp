@@ -20,15 +20,25 @@
 #include "CollisionManager.hpp"
 #include "Level.hpp"
 #include "SoundPlayer.hpp"
+#include "PathfinderOverlay.hpp"
 
 #include "scenes/IScene.hpp"
 
 #include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/PathCache.hpp"
+#include "pathfinder/CorridorGraph.hpp"
+#include "pathfinder/HierarchicalPathfinder.hpp"
+#include "pathfinder/PathTable.hpp"
+#include "pathfinder/DistanceField.hpp"
+#include "pathfinder/ReachabilityIndex.hpp"
+#include "pathfinder/PathfindingScheduler.hpp"
+#include "pathfinder/PathfinderStats.hpp"
 
 #include <optional>
 #include <memory>
 #include <string_view>
 #include <string>
+#include <vector>
 
 
 class GameScene : public IScene {
@@ -60,6 +70,14 @@ public:
     bool IsGameOver() const;
 
     Pathfinder& GetPathfinder();
+    PathTable& GetPathTable();
+    PathCache& GetPathCache();
+    const DistanceField& GetPlayerDistanceField() const;
+    ReachabilityIndex& GetReachabilityIndex();
+    PathfindingScheduler& GetPathfindingScheduler();
+#if defined(PACMAN_PATHFINDER_STATS)
+    PathfinderStats& GetPathfinderStats();
+#endif
     const GameMap& GetMap() const;
     const Player& GetPlayer() const;
  
@@ -98,8 +116,27 @@ private:
     CountdownTimer timer_showing_ghost_score_ {1.5f};
 
     // Game Objects
+    // Scenes on the same maze share its MapAsset, and the path table rows until a
+    // cell changes. What each scene owns of the map state:
+    // - GameMap: nothing until a cell changes, then the walkability and exits
+    //   (1.125 B per cell) and the 16 KB journal.
+    // - Pathfinder: 16 B per cell of search nodes, and its open lists.
+    // - CorridorGraph: 12 B per cell, and its junctions and segments.
+    // - PathTable: 5 B per cell for dirty rows and its queue, and its own rows
+    //   (3 B per cell squared, 340 KB on the stock maze) once it repairs one.
+    // - CollectableManager: a bit per spawn, 56 B for the stock maze's 386.
+    // On the stock maze that's 31 KB for the first four, against 373 KB unshared
+    // (PathfinderBenchmark's shared map run).
     GameMap map_;
     Pathfinder pathfinder_;
+    PathCache path_cache_;
+    // The table's fallback: the corridor graph, or HPA* with kUseHierarchicalPathfinder.
+    CorridorGraph corridor_graph_;
+    HierarchicalPathfinder hierarchical_pathfinder_;
+    PathTable path_table_;
+    DistanceField player_distance_field_;
+    ReachabilityIndex reachability_index_;
+    PathfindingScheduler pathfinding_scheduler_;
     Player player_;
     GhostFactory ghost_factory_;
     GhostList ghosts_;
@@ -110,9 +147,16 @@ private:
     UIManager ui_manager_;
     bool did_player_win_ {false};
 
+#if defined(PACMAN_PATHFINDER_STATS)
+    PathfinderStats pathfinder_stats_;
+    PathfinderOverlay pathfinder_overlay_;
+    bool is_showing_pathfinder_overlay_ {false};
+#endif
+
     void Init();
     void StartGame();
     
+    void UpdatePlayerDistanceField();
     void HandleStatePlaying(float dt);
     void HandleOnPlayerDied(float dt);
     void HandleStateOnPlayerWin();
@@ -47,6 +47,8 @@ protected:
     bool DidReachCellCenter() const;
     float GetCellCenterTolerance() const;
     bool IsMovableDirection(EDirection direction) const;
+    // The GameMap exit bit of the direction.
+    std::uint8_t GetExit(EDirection direction) const;
     bool IsOrthogonalTurn(EDirection next_direction) const;
     void CenterAxisX();
     void CenterAxisY();
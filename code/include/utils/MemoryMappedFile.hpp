@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only view of a whole file mapped into memory: pages are loaded on first
+// touch and shared with every process mapping the same file.
+class MemoryMappedFile {
+public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    // Closes the current file first. False when the file can't be opened or is empty.
+    bool Open(const std::string& file_path);
+    void Close();
+
+    bool IsOpen() const;
+    const std::uint8_t* GetData() const;
+    std::size_t GetSize() const;
+
+private:
+    const std::uint8_t* data_ {nullptr};
+    std::size_t size_ {0};
+#if defined(_WIN32)
+    void* file_handle_ {nullptr};
+    void* mapping_handle_ {nullptr};
+#else
+    int file_descriptor_ {-1};
+#endif
+};
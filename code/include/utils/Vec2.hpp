@@ -8,13 +8,13 @@ class Vec2 {
 public:
     T x, y;
 
-    Vec2() : x(T()), y(T()) {}
-    Vec2(T x_, T y_) : x(x_), y(y_) {}
+    constexpr Vec2() : x(T()), y(T()) {}
+    constexpr Vec2(T x_, T y_) : x(x_), y(y_) {}
 
-    Vec2 operator+(const Vec2& other) const;
-    Vec2 operator-(const Vec2& other) const;
-    Vec2 operator*(T scalar) const;
-    Vec2 operator/(T scalar) const;
+    constexpr Vec2 operator+(const Vec2& other) const;
+    constexpr Vec2 operator-(const Vec2& other) const;
+    constexpr Vec2 operator*(T scalar) const;
+    constexpr Vec2 operator/(T scalar) const;
 
     Vec2& operator+=(const Vec2& other);
     Vec2& operator-=(const Vec2& other);
@@ -22,8 +22,8 @@ public:
     Vec2& operator*=(T scalar);
     Vec2& operator/=(T scalar);
 
-    bool operator!=(const Vec2& other) const;
-    bool operator==(const Vec2& other) const;
+    constexpr bool operator!=(const Vec2& other) const;
+    constexpr bool operator==(const Vec2& other) const;
 
     T Length() const;
     T LengthSquared() const;
@@ -32,23 +32,23 @@ public:
 };
 
 template<typename T>
-Vec2<T> Vec2<T>::operator+(const Vec2& other) const {
+constexpr Vec2<T> Vec2<T>::operator+(const Vec2& other) const {
     return Vec2(x + other.x, y + other.y);
 }
 
 
 template<typename T>
-Vec2<T> Vec2<T>::operator-(const Vec2& other) const {
+constexpr Vec2<T> Vec2<T>::operator-(const Vec2& other) const {
     return Vec2(x - other.x, y - other.y);
 }
 
 template<typename T>
-Vec2<T> Vec2<T>::operator*(T scalar) const {
+constexpr Vec2<T> Vec2<T>::operator*(T scalar) const {
     return Vec2(x * scalar, y * scalar);
 }
 
 template<typename T>
-Vec2<T> Vec2<T>::operator/(T scalar) const {
+constexpr Vec2<T> Vec2<T>::operator/(T scalar) const {
     return Vec2(x / scalar, y / scalar);
 }
 
@@ -98,12 +98,12 @@ T Vec2<T>::LengthSquared() const {
 }
 
 template<typename T>
-bool Vec2<T>::operator!=(const Vec2& other) const {
+constexpr bool Vec2<T>::operator!=(const Vec2& other) const {
     return (x != other.x || y != other.y);
 }
 
 template<typename T>
-bool Vec2<T>::operator==(const Vec2& other) const {
+constexpr bool Vec2<T>::operator==(const Vec2& other) const {
     return (x == other.x && y == other.y);
 }
 
@@ -0,0 +1,379 @@
+#include "ChunkedMap.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <SDL2/SDL.h>
+
+namespace {
+static const std::uint32_t kMagic = 0x4B484350; // "PCHK"
+static const std::uint32_t kFormatVersion = 1;
+static const std::uint32_t kWallsChunk = 0xFFFFFFFF;
+static const std::uint32_t kFloorChunk = 0xFFFFFFFE;
+static const std::size_t kChunkShift = 6;
+static const std::size_t kChunkMask = ChunkedMap::kChunkSize - 1;
+static const std::size_t kChunkCellsCount = ChunkedMap::kChunkSize * ChunkedMap::kChunkSize;
+// Resident cells keep their walkability over the exit bits.
+static const std::uint8_t kWalkableBit = 1 << 4;
+
+static_assert((std::size_t{1} << kChunkShift) == ChunkedMap::kChunkSize);
+
+std::size_t AlignTo8(std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+}
+
+ChunkedMap::ChunkedMap()
+    : columns_count_(0)
+    , rows_count_(0)
+    , chunks_per_row_(0)
+    , chunks_per_column_(0)
+    , stamp_(0) {}
+
+bool ChunkedMap::Save(const MapView& map, const std::string& file_path) {
+    const auto chunks_per_row = (map.cols_count + kChunkMask) >> kChunkShift;
+    const auto chunks_per_column = (map.rows_count + kChunkMask) >> kChunkShift;
+    std::vector<std::uint32_t> descriptors;
+    std::vector<Bitset> bitsets;
+    descriptors.reserve(chunks_per_row * chunks_per_column);
+    for (std::size_t chunk_row = 0; chunk_row < chunks_per_column; ++chunk_row) {
+        for (std::size_t chunk_col = 0; chunk_col < chunks_per_row; ++chunk_col) {
+            const auto first_col = chunk_col << kChunkShift;
+            const auto first_row = chunk_row << kChunkShift;
+            const auto cols_count = std::min(kChunkSize, map.cols_count - first_col);
+            const auto rows_count = std::min(kChunkSize, map.rows_count - first_row);
+            Bitset bitset {};
+            std::size_t walkable_count = 0;
+            for (std::size_t row = 0; row < rows_count; ++row) {
+                const auto* tiles = &map.tiles[(first_row + row) * map.cols_count + first_col];
+                for (std::size_t col = 0; col < cols_count; ++col) {
+                    if (tiles[col] != 0) continue;
+                    bitset[row] |= std::uint64_t{1} << col;
+                    ++walkable_count;
+                }
+            }
+
+            if (walkable_count == 0) {
+                descriptors.push_back(kWallsChunk);
+            } else if (walkable_count == cols_count * rows_count) {
+                descriptors.push_back(kFloorChunk);
+            } else {
+                descriptors.push_back(static_cast<std::uint32_t>(bitsets.size()));
+                bitsets.push_back(bitset);
+            }
+        }
+    }
+
+    const FileHeader header {
+        kMagic,
+        kFormatVersion,
+        static_cast<std::uint32_t>(map.cols_count),
+        static_cast<std::uint32_t>(map.rows_count),
+        static_cast<std::uint32_t>(kChunkSize),
+        static_cast<std::uint32_t>(descriptors.size()),
+        bitsets.size()};
+    static const std::uint8_t kPadding[8] {};
+    const auto descriptors_size = descriptors.size() * sizeof(std::uint32_t);
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(descriptors.data()), descriptors_size);
+    file.write(reinterpret_cast<const char*>(kPadding), AlignTo8(descriptors_size) - descriptors_size);
+    file.write(reinterpret_cast<const char*>(bitsets.data()), bitsets.size() * sizeof(Bitset));
+    if (!file) {
+        SDL_Log("ChunkedMap: error writing %s.", file_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ChunkedMap::Load(const std::string& file_path) {
+    Clear();
+    if (!file_.Open(file_path)) return false;
+
+    FileHeader header;
+    bool is_loaded = (file_.GetSize() >= sizeof(header));
+    if (is_loaded) {
+        std::memcpy(&header, file_.GetData(), sizeof(header));
+        const std::size_t chunks_count =
+            ((header.columns_count + kChunkMask) >> kChunkShift) * ((header.rows_count + kChunkMask) >> kChunkShift);
+        is_loaded = (header.magic == kMagic &&
+                     header.format_version == kFormatVersion &&
+                     header.chunk_size == kChunkSize &&
+                     header.chunks_count == chunks_count &&
+                     file_.GetSize() == sizeof(header) +
+                        AlignTo8(chunks_count * sizeof(std::uint32_t)) +
+                        header.bitsets_count * sizeof(Bitset));
+    }
+    if (!is_loaded) {
+        SDL_Log("ChunkedMap: %s isn't a chunked map.", file_path.c_str());
+        file_.Close();
+        return false;
+    }
+
+    const auto* descriptors = reinterpret_cast<const std::uint32_t*>(file_.GetData() + sizeof(header));
+    for (std::size_t chunk = 0; chunk < header.chunks_count; ++chunk) {
+        const auto descriptor = descriptors[chunk];
+        if (descriptor != kWallsChunk && descriptor != kFloorChunk && descriptor >= header.bitsets_count) {
+            SDL_Log("ChunkedMap: %s has a chunk out of the file.", file_path.c_str());
+            Clear();
+            return false;
+        }
+        sources_.push_back(descriptor == kWallsChunk ? ESource::WALLS : descriptor == kFloorChunk ? ESource::FLOOR : ESource::FILE);
+        source_bitsets_.push_back(descriptor);
+    }
+    file_bitsets_ = {
+        reinterpret_cast<const Bitset*>(file_.GetData() + sizeof(header) + AlignTo8(header.chunks_count * sizeof(std::uint32_t))),
+        static_cast<std::size_t>(header.bitsets_count)};
+
+    columns_count_ = header.columns_count;
+    rows_count_ = header.rows_count;
+    chunks_per_row_ = (columns_count_ + kChunkMask) >> kChunkShift;
+    chunks_per_column_ = (rows_count_ + kChunkMask) >> kChunkShift;
+    resident_slots_.assign(header.chunks_count, kNotResident);
+    is_changed_.assign(header.chunks_count, 0);
+    wanted_stamps_.assign(header.chunks_count, 0);
+    return true;
+}
+
+bool ChunkedMap::IsLoaded() const {
+    return file_.IsOpen();
+}
+
+void ChunkedMap::UpdateResidency(std::span<const Vec2<int>> col_rows, std::size_t radius) {
+    if (++stamp_ == 0) {
+        std::fill(wanted_stamps_.begin(), wanted_stamps_.end(), 0);
+        stamp_ = 1;
+    }
+
+    const auto for_each_wanted_chunk = [this, col_rows, radius](const auto& callback) {
+        for (const auto col_row : col_rows) {
+            if (col_row.x < 0 || col_row.y < 0 ||
+                static_cast<std::size_t>(col_row.x) >= columns_count_ ||
+                static_cast<std::size_t>(col_row.y) >= rows_count_) {
+                continue;
+            }
+
+            const auto chunk_col = static_cast<std::size_t>(col_row.x) >> kChunkShift;
+            const auto chunk_row = static_cast<std::size_t>(col_row.y) >> kChunkShift;
+            const auto last_col = std::min(chunk_col + radius, chunks_per_row_ - 1);
+            const auto last_row = std::min(chunk_row + radius, chunks_per_column_ - 1);
+            for (auto row = chunk_row - std::min(chunk_row, radius); row <= last_row; ++row) {
+                for (auto col = chunk_col - std::min(chunk_col, radius); col <= last_col; ++col) {
+                    callback(row * chunks_per_row_ + col);
+                }
+            }
+        }
+    };
+
+    for_each_wanted_chunk([this](std::size_t chunk) { wanted_stamps_[chunk] = stamp_; });
+
+    std::size_t kept_count = 0;
+    for (const auto chunk : resident_chunks_) {
+        if (wanted_stamps_[chunk] == stamp_) {
+            resident_chunks_[kept_count++] = chunk;
+        } else {
+            Evict(chunk);
+        }
+    }
+    resident_chunks_.resize(kept_count);
+
+    for_each_wanted_chunk([this](std::size_t chunk) {
+        if (resident_slots_[chunk] == kNotResident) Expand(chunk);
+    });
+}
+
+bool ChunkedMap::IsWalkable(std::size_t col, std::size_t row) const {
+    const auto chunk = GetChunk(col, row);
+    const auto slot = resident_slots_[chunk];
+    if (slot == kNotResident) return IsWalkableInSource(chunk, col, row);
+
+    return GetResidentExits(slot)[((row & kChunkMask) << kChunkShift) | (col & kChunkMask)] & kWalkableBit;
+}
+
+void ChunkedMap::SetIsWalkable(std::size_t col, std::size_t row, bool is_walkable) {
+    if (IsWalkable(col, row) == is_walkable) return;
+
+    const auto chunk = GetChunk(col, row);
+    const auto slot = resident_slots_[chunk];
+    if (slot != kNotResident) {
+        auto& exits = GetResidentExits(slot)[((row & kChunkMask) << kChunkShift) | (col & kChunkMask)];
+        exits = is_walkable ? (exits | kWalkableBit) : (exits & ~kWalkableBit);
+        is_changed_[chunk] = 1;
+    } else {
+        if (sources_[chunk] != ESource::CHANGED) {
+            Bitset bitset {};
+            if (sources_[chunk] == ESource::FLOOR) bitset.fill(~std::uint64_t{0});
+            if (sources_[chunk] == ESource::FILE) bitset = file_bitsets_[source_bitsets_[chunk]];
+            sources_[chunk] = ESource::CHANGED;
+            source_bitsets_[chunk] = static_cast<std::uint32_t>(changed_bitsets_.size());
+            changed_bitsets_.push_back(bitset);
+        }
+        auto& word = changed_bitsets_[source_bitsets_[chunk]][row & kChunkMask];
+        const auto bit = std::uint64_t{1} << (col & kChunkMask);
+        word = is_walkable ? (word | bit) : (word & ~bit);
+    }
+
+    const auto col_int = static_cast<int>(col);
+    const auto row_int = static_cast<int>(row);
+    RefreshExits(col_int, row_int);
+    RefreshExits(col_int + 1, row_int);
+    RefreshExits(col_int - 1, row_int);
+    RefreshExits(col_int, row_int - 1);
+    RefreshExits(col_int, row_int + 1);
+}
+
+std::uint8_t ChunkedMap::GetExits(std::size_t col, std::size_t row) const {
+    const auto slot = resident_slots_[GetChunk(col, row)];
+    if (slot == kNotResident) return ComputeExits(col, row);
+
+    return GetResidentExits(slot)[((row & kChunkMask) << kChunkShift) | (col & kChunkMask)] & GameMap::kExitsAll;
+}
+
+std::size_t ChunkedMap::GetColumnsCount() const {
+    return columns_count_;
+}
+
+std::size_t ChunkedMap::GetRowsCount() const {
+    return rows_count_;
+}
+
+std::size_t ChunkedMap::GetChunksCount() const {
+    return sources_.size();
+}
+
+std::size_t ChunkedMap::GetResidentChunksCount() const {
+    return resident_chunks_.size();
+}
+
+std::size_t ChunkedMap::GetFileSize() const {
+    return file_.GetSize();
+}
+
+std::size_t ChunkedMap::GetMemoryUsage() const {
+    return sources_.capacity() * sizeof(ESource) +
+           source_bitsets_.capacity() * sizeof(std::uint32_t) +
+           changed_bitsets_.capacity() * sizeof(Bitset) +
+           resident_slots_.capacity() * sizeof(std::uint32_t) +
+           is_changed_.capacity() +
+           resident_exits_.capacity() +
+           free_slots_.capacity() * sizeof(std::uint32_t) +
+           resident_chunks_.capacity() * sizeof(std::uint32_t) +
+           wanted_stamps_.capacity() * sizeof(std::uint32_t);
+}
+
+void ChunkedMap::Clear() {
+    file_.Close();
+    columns_count_ = 0;
+    rows_count_ = 0;
+    chunks_per_row_ = 0;
+    chunks_per_column_ = 0;
+    sources_.clear();
+    source_bitsets_.clear();
+    file_bitsets_ = {};
+    changed_bitsets_.clear();
+    resident_slots_.clear();
+    is_changed_.clear();
+    resident_exits_.clear();
+    free_slots_.clear();
+    resident_chunks_.clear();
+    wanted_stamps_.clear();
+    stamp_ = 0;
+}
+
+std::size_t ChunkedMap::GetChunk(std::size_t col, std::size_t row) const {
+    return (row >> kChunkShift) * chunks_per_row_ + (col >> kChunkShift);
+}
+
+std::uint8_t* ChunkedMap::GetResidentExits(std::uint32_t slot) {
+    return resident_exits_.data() + static_cast<std::size_t>(slot) * kChunkCellsCount;
+}
+
+const std::uint8_t* ChunkedMap::GetResidentExits(std::uint32_t slot) const {
+    return resident_exits_.data() + static_cast<std::size_t>(slot) * kChunkCellsCount;
+}
+
+bool ChunkedMap::IsWalkableInSource(std::size_t chunk, std::size_t col, std::size_t row) const {
+    switch (sources_[chunk]) {
+        case ESource::WALLS: return false;
+        case ESource::FLOOR: return true;
+        case ESource::FILE: return (file_bitsets_[source_bitsets_[chunk]][row & kChunkMask] >> (col & kChunkMask)) & 1;
+        case ESource::CHANGED: return (changed_bitsets_[source_bitsets_[chunk]][row & kChunkMask] >> (col & kChunkMask)) & 1;
+    }
+    return false;
+}
+
+std::uint8_t ChunkedMap::ComputeExits(std::size_t col, std::size_t row) const {
+    return GameMap::ComputeExits(Vec2{static_cast<int>(col), static_cast<int>(row)}, [this](Vec2<int> col_row) {
+        return (col_row.x >= 0 && col_row.y >= 0 &&
+                static_cast<std::size_t>(col_row.x) < columns_count_ &&
+                static_cast<std::size_t>(col_row.y) < rows_count_ &&
+                IsWalkable(static_cast<std::size_t>(col_row.x), static_cast<std::size_t>(col_row.y)));
+    });
+}
+
+void ChunkedMap::RefreshExits(int col, int row) {
+    if (col < 0 || row < 0 || static_cast<std::size_t>(col) >= columns_count_ || static_cast<std::size_t>(row) >= rows_count_) return;
+
+    const auto col_size = static_cast<std::size_t>(col);
+    const auto row_size = static_cast<std::size_t>(row);
+    const auto slot = resident_slots_[GetChunk(col_size, row_size)];
+    if (slot == kNotResident) return;
+
+    auto& exits = GetResidentExits(slot)[((row_size & kChunkMask) << kChunkShift) | (col_size & kChunkMask)];
+    exits = (exits & kWalkableBit) | ComputeExits(col_size, row_size);
+}
+
+void ChunkedMap::Expand(std::size_t chunk) {
+    std::uint32_t slot = 0;
+    if (free_slots_.empty()) {
+        slot = static_cast<std::uint32_t>(resident_exits_.size() / kChunkCellsCount);
+        resident_exits_.resize(resident_exits_.size() + kChunkCellsCount);
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+
+    // Read from the source before the chunk turns resident; cells past the map's
+    // edges are walls.
+    auto* exits = GetResidentExits(slot);
+    std::fill(exits, exits + kChunkCellsCount, 0);
+    const auto first_col = (chunk % chunks_per_row_) << kChunkShift;
+    const auto first_row = (chunk / chunks_per_row_) << kChunkShift;
+    const auto cols_count = std::min(kChunkSize, columns_count_ - first_col);
+    const auto rows_count = std::min(kChunkSize, rows_count_ - first_row);
+    for (std::size_t row = 0; row < rows_count; ++row) {
+        for (std::size_t col = 0; col < cols_count; ++col) {
+            if (!IsWalkableInSource(chunk, first_col + col, first_row + row)) continue;
+            exits[(row << kChunkShift) | col] = kWalkableBit | ComputeExits(first_col + col, first_row + row);
+        }
+    }
+    resident_slots_[chunk] = slot;
+    resident_chunks_.push_back(static_cast<std::uint32_t>(chunk));
+}
+
+void ChunkedMap::Evict(std::size_t chunk) {
+    const auto slot = resident_slots_[chunk];
+    if (is_changed_[chunk]) {
+        Bitset bitset {};
+        const auto* exits = GetResidentExits(slot);
+        for (std::size_t row = 0; row < kChunkSize; ++row) {
+            for (std::size_t col = 0; col < kChunkSize; ++col) {
+                if (exits[(row << kChunkShift) | col] & kWalkableBit) bitset[row] |= std::uint64_t{1} << col;
+            }
+        }
+        if (sources_[chunk] != ESource::CHANGED) {
+            sources_[chunk] = ESource::CHANGED;
+            source_bitsets_[chunk] = static_cast<std::uint32_t>(changed_bitsets_.size());
+            changed_bitsets_.push_back(bitset);
+        } else {
+            changed_bitsets_[source_bitsets_[chunk]] = bitset;
+        }
+        is_changed_[chunk] = 0;
+    }
+    resident_slots_[chunk] = kNotResident;
+    free_slots_.push_back(slot);
+}
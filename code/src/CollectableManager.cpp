@@ -2,7 +2,9 @@
 
 #include "utils/Collisions.hpp"
 
+#include "CollectableSpawns.hpp"
 #include "Constants.hpp"
+#include "MapAsset.hpp"
 #include "Player.hpp"
 
 #include <array>
@@ -18,6 +20,8 @@ static const float kSizeBigHalf = kSizeBig / 2.f;
 
 static const unsigned int kScoreSmall = 10;
 static const unsigned int kScoreBig = 100;
+
+static const std::size_t kSpawnsPerWord = 64;
 }
 
 CollectableManager::CollectableManager(
@@ -27,91 +31,68 @@ CollectableManager::CollectableManager(
     : renderer_(renderer)
     , texture_manager_(texture_manager)
     , game_map_(game_map)
+    , collectables_count_(0)
     , texture_(nullptr) {
     
     texture_ = texture_manager_.LoadTexture(kAssetsFolderImages + "spritesheet.png");
     CreateCollectables();
 }
 
-void CollectableManager::CreateCollectables() {    
-    collectables_.clear();
-    const auto last_col = game_map_.GetColumnsCount() - 1;
-    const auto last_row = game_map_.GetRowsCount() - 1;
-
-    const auto& cells = game_map_.GetCells();
-    const auto half_cell_size = static_cast<float>(game_map_.GetCellSize()) / 2.f;
-    for (const auto& cell : cells) {
-        const auto spawn_type = kMapCollectables[cell.row][cell.col];
-        if (spawn_type == 0) continue;
-
-        const auto x = cell.center.x;
-        const auto y = cell.center.y;
-        switch(spawn_type) {
-            case 1: AddCollectable(ECollectableType::SMALL, kScoreSmall, kSizeSmall, x, y); break;
-            case 2: AddCollectable(ECollectableType::BIG, kScoreBig, kSizeBig, x, y);       break;
-        }
-
-        // Adding more half right and half down if posible.
-        bool add_coollectable_right = (
-            cell.col != last_col && 
-            (cell.col + 1) <= last_col && 
-            kMapCollectables[cell.row][cell.col + 1]);
-        if (add_coollectable_right) {
-            AddCollectable(ECollectableType::SMALL, kScoreSmall, kSizeSmall, x + half_cell_size, y);
-        }
-
-        bool add_coollectable_down = (
-            cell.row != last_row && 
-            (cell.row + 1) <= last_row && 
-            kMapCollectables[cell.row + 1][cell.col]);
-        if (add_coollectable_down) {
-            AddCollectable(ECollectableType::SMALL, kScoreSmall, kSizeSmall, x, y + half_cell_size);
-        }
-    }
+// Chunked maps have no asset, and so no collectables.
+void CollectableManager::CreateCollectables() {
+    const auto& asset = game_map_.GetAsset();
+    spawns_ = asset ? asset->GetCollectableSpawns() : std::span<const CollectableSpawn>{};
+    collected_spawns_.assign((spawns_.size() + kSpawnsPerWord - 1) / kSpawnsPerWord, 0);
+    collectables_count_ = spawns_.size();
 }
 
-void CollectableManager::AddCollectable(ECollectableType type, unsigned int score, float size, float x, float y) {
-    collectables_.emplace_back(std::make_unique<Collectable>(
-        type, score, SDL_FRect{x - size/2.f, y - size / 2.f, size, size}
-    ));
-}
+void CollectableManager::Collect(const Collectable& collectable) {
+    if (IsCollected(collectable.spawn_index)) return;
 
-bool CollectableManager::DidCollectAll() const {
-    return collectables_.empty();
+    collected_spawns_[collectable.spawn_index / kSpawnsPerWord] |= std::uint64_t{1} << (collectable.spawn_index % kSpawnsPerWord);
+    --collectables_count_;
 }
 
-void CollectableManager::MarkAllForDestroy() {
-    for (auto& c : collectables_) {
-        c->is_marked_for_destroy = true;
-    }
+void CollectableManager::CollectAll() {
+    std::fill(collected_spawns_.begin(), collected_spawns_.end(), ~std::uint64_t{0});
+    collectables_count_ = 0;
 }
 
-void CollectableManager::RemoveCollectablesMarkedForDestroy() {
-    auto should_remove_collectable = [](const auto& collectable) {
-        return collectable->is_marked_for_destroy;
-    };
-
-    collectables_.erase(
-        std::remove_if(collectables_.begin(), collectables_.end(), should_remove_collectable),
-        collectables_.end()
-    );
+bool CollectableManager::DidCollectAll() const {
+    return collectables_count_ == 0;
 }
 
 void CollectableManager::Render() {
     const SDL_Rect src_r {2, 182, 8, 8};
-    for (const auto& c : collectables_) {
-        renderer_.RenderTexture(texture_, src_r, c->hitbox);
-    }
+    ForEachCollectable([this, &src_r](const Collectable& c) {
+        renderer_.RenderTexture(texture_, src_r, c.hitbox);
+    });
 }
 
 unsigned int CollectableManager::GetAllCollectableScores() const {
     unsigned int total_score = 0;
-    for (const auto& c : collectables_) {
-        total_score += c->score;
-    }
+    ForEachCollectable([&total_score](const Collectable& c) {
+        total_score += c.score;
+    });
     return total_score;
 }
 
-CollectableList& CollectableManager::GetCollectableList() {
-    return collectables_;
-}
\ No newline at end of file
+std::size_t CollectableManager::GetMemoryUsage() const {
+    return collected_spawns_.capacity() * sizeof(std::uint64_t);
+}
+
+bool CollectableManager::IsCollected(std::size_t spawn_index) const {
+    return (collected_spawns_[spawn_index / kSpawnsPerWord] >> (spawn_index % kSpawnsPerWord)) & 1;
+}
+
+Collectable CollectableManager::GetCollectable(std::size_t spawn_index) const {
+    const auto& spawn = spawns_[spawn_index];
+    const auto is_big = (spawn.type == 2);
+    const auto size = is_big ? kSizeBig : kSizeSmall;
+    const auto center = game_map_.FromColRowToCoords(Vec2{0, 0}) + spawn.center;
+    return {
+        spawn_index,
+        is_big ? ECollectableType::BIG : ECollectableType::SMALL,
+        is_big ? kScoreBig : kScoreSmall,
+        SDL_FRect{center.x - size / 2.f, center.y - size / 2.f, size, size}};
+}
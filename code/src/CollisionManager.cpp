@@ -27,12 +27,11 @@ void CollisionManager::LoadSounds() {
 void CollisionManager::CheckCollisions(GameScene& game_scene) {
     // Player - Collectable
     const auto& player_hitbox = player_.GetHitBox();
-    auto& collectables = collectable_manager_.GetCollectableList();
-    for (auto& collectable : collectables) {
-        if (AreColliding(player_.GetHitBox(), collectable->hitbox)) {
-            OnCollisionWithCollectable(*collectable, game_scene);
+    collectable_manager_.ForEachCollectable([this, &player_hitbox, &game_scene](const Collectable& collectable) {
+        if (AreColliding(player_hitbox, collectable.hitbox)) {
+            OnCollisionWithCollectable(collectable, game_scene);
         }
-    }
+    });
 
     // Player - Ghost
     for (auto& ghost : ghosts_) {
@@ -42,12 +41,12 @@ void CollisionManager::CheckCollisions(GameScene& game_scene) {
     }
 }
 
-void CollisionManager::OnCollisionWithCollectable(Collectable& collectable, GameScene& game_scene) {
+void CollisionManager::OnCollisionWithCollectable(const Collectable& collectable, GameScene& game_scene) {
     Mix_PlayChannel(-1, sounds_collect_[sound_collect_index_], 0);
     sound_collect_index_ = !sound_collect_index_;
 
     player_.IncreaseScore(collectable.score);
-    collectable.is_marked_for_destroy = true;
+    collectable_manager_.Collect(collectable);
     if (collectable.type == ECollectableType::BIG) {
         game_scene.StartGhostFrightenedTimer();
     }
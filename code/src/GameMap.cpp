@@ -1,8 +1,20 @@
 #include "GameMap.hpp"
 
-#include "Constants.hpp"
+#include "ChunkedMap.hpp"
+#include "MapAsset.hpp"
 
 #include <algorithm>
+#include <array>
+
+namespace {
+static const std::size_t kBlockShift = MapAsset::kBlockShift;
+static const std::size_t kBlockMask = MapAsset::kBlockMask;
+static const std::uint8_t kEntityMovesShift = MapAsset::kEntityMovesShift;
+static const Vec2<int> kNoHouseDoor {-1, -1};
+// The neighbours whose exits change with a cell.
+static const std::array<Vec2<int>, 4> kExitOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+}
 
 GameMap::GameMap(
     Renderer& renderer,
@@ -11,45 +23,144 @@ GameMap::GameMap(
     Vec2<float> padding,
     std::size_t cell_size) 
     : renderer_(renderer)
-    , width_(width)
-    , height_(height)
+    , width_(0.f)
+    , height_(0.f)
     , padding_(padding)
     , cell_size_(cell_size)
     , cell_size_int_(static_cast<int>(cell_size_))
     , cell_size_float_(static_cast<float>(cell_size_))
-    , rows_count_(kRowsCount)
-    , cols_count_(kColsCount)
-    , rows_count_int_(static_cast<int>(rows_count_))
-    , cols_count_int_(static_cast<int>(cols_count_))
-    , cells_count_(rows_count_ * cols_count_) {
-    Init();
+    , rows_count_(0)
+    , cols_count_(0)
+    , rows_count_int_(0)
+    , cols_count_int_(0)
+    , cells_count_(0)
+    , geometry_(0, 0, cell_size)
+    , blocks_per_row_(0)
+    , walkable_blocks_(nullptr)
+    , exits_(nullptr)
+    , house_door_(kNoHouseDoor)
+    , version_(0)
+    , journal_start_version_(0) {
+    const auto cols_count = static_cast<std::size_t>(width / cell_size_float_);
+    const auto rows_count = static_cast<std::size_t>(height / cell_size_float_);
+    Init(MapLayout(cols_count, rows_count, std::vector<std::uint8_t>(cols_count * rows_count, 0)));
 }
-    
-void GameMap::Init() {
-    std::size_t i = 0;
-    std::size_t row_num = 0;
-    Vec2<float> pos {0.f, padding_.y};
-    cells_.reserve(cells_count_);
-    for (const auto& row : kMapTiles) {
-        std::size_t col_num = 0;
-        pos.x = padding_.x;
-        for (const auto value : row) {
-            const auto is_walkable = (value == 0);
-            const auto center = pos + Vec2{cell_size_float_ / 2.f, cell_size_float_ / 2.f};
-            cells_.emplace_back(i, pos, center, row_num, col_num, is_walkable);
-            pos.x += cell_size_float_;
-            ++i;
-            ++col_num;
-        }
-        ++row_num;
-        pos.y += cell_size_float_;
-    }
+
+GameMap::GameMap(
+    Renderer& renderer,
+    Vec2<float> padding,
+    std::size_t cell_size,
+    const MapView& map)
+    : renderer_(renderer)
+    , width_(0.f)
+    , height_(0.f)
+    , padding_(padding)
+    , cell_size_(cell_size)
+    , cell_size_int_(static_cast<int>(cell_size_))
+    , cell_size_float_(static_cast<float>(cell_size_))
+    , rows_count_(0)
+    , cols_count_(0)
+    , rows_count_int_(0)
+    , cols_count_int_(0)
+    , cells_count_(0)
+    , geometry_(0, 0, cell_size)
+    , blocks_per_row_(0)
+    , walkable_blocks_(nullptr)
+    , exits_(nullptr)
+    , house_door_(kNoHouseDoor)
+    , version_(0)
+    , journal_start_version_(0) {
+    Init(map);
+}
+
+GameMap::GameMap(
+    Renderer& renderer,
+    Vec2<float> padding,
+    std::shared_ptr<const MapAsset> asset)
+    : renderer_(renderer)
+    , width_(0.f)
+    , height_(0.f)
+    , padding_(padding)
+    , cell_size_(asset->GetGeometry().GetCellSize())
+    , cell_size_int_(static_cast<int>(cell_size_))
+    , cell_size_float_(static_cast<float>(cell_size_))
+    , rows_count_(0)
+    , cols_count_(0)
+    , rows_count_int_(0)
+    , cols_count_int_(0)
+    , cells_count_(0)
+    , geometry_(0, 0, cell_size_)
+    , blocks_per_row_(0)
+    , walkable_blocks_(nullptr)
+    , exits_(nullptr)
+    , house_door_(kNoHouseDoor)
+    , version_(0)
+    , journal_start_version_(0) {
+    Init(std::move(asset));
+}
+
+GameMap::~GameMap() = default;
+
+// The house door stays where it was.
+void GameMap::Init(const MapView& map) {
+    Init(MapAsset::Create(map, cell_size_, house_door_));
+}
+
+void GameMap::Init(std::shared_ptr<const MapAsset> asset) {
+    chunked_map_.reset();
+    asset_ = std::move(asset);
+    cell_size_ = asset_->GetGeometry().GetCellSize();
+    cell_size_int_ = static_cast<int>(cell_size_);
+    cell_size_float_ = static_cast<float>(cell_size_);
+    SetDimensions(asset_->GetGeometry().GetColumnsCount(), asset_->GetGeometry().GetRowsCount());
+
+    blocks_per_row_ = asset_->GetBlocksPerRow();
+    walkable_blocks_ = asset_->GetWalkableBlocks().data();
+    exits_ = asset_->GetExitsAndMoves().data();
+    std::vector<std::uint64_t>().swap(overlay_walkable_blocks_);
+    std::vector<std::uint8_t>().swap(overlay_exits_);
+    house_door_ = asset_->GetHouseDoor();
+    ++version_;
+    journal_start_version_ = version_;
+}
+
+bool GameMap::InitChunked(const std::string& file_path) {
+    auto chunked_map = std::make_unique<ChunkedMap>();
+    if (!chunked_map->Load(file_path)) return false;
+
+    chunked_map_ = std::move(chunked_map);
+    SetDimensions(chunked_map_->GetColumnsCount(), chunked_map_->GetRowsCount());
+    asset_.reset();
+    blocks_per_row_ = 0;
+    walkable_blocks_ = nullptr;
+    exits_ = nullptr;
+    std::vector<std::uint64_t>().swap(overlay_walkable_blocks_);
+    std::vector<std::uint8_t>().swap(overlay_exits_);
+    ++version_;
+    journal_start_version_ = version_;
+    return true;
+}
+
+bool GameMap::IsChunked() const {
+    return chunked_map_ != nullptr;
+}
+
+void GameMap::UpdateResidency(std::span<const Vec2<int>> col_rows) {
+    if (chunked_map_) chunked_map_->UpdateResidency(col_rows);
+}
+
+const ChunkedMap* GameMap::GetChunkedMap() const {
+    return chunked_map_.get();
+}
+
+const std::shared_ptr<const MapAsset>& GameMap::GetAsset() const {
+    return asset_;
 }
 
 void GameMap::Render() {
     
     renderer_.SetRenderingColor({0, 100, 225, 100});
-    for (auto& cell : cells_) {
+    for (const auto& cell : GetCells()) {
         if (cell.is_walkable) continue;
 
         const SDL_FRect cell_rect {
@@ -67,27 +178,98 @@ void GameMap::Render() {
 void GameMap::SetIsWalkable(Vec2<int> col_row, bool is_walkable) {
     if (!AreColRowInsideBoundaries(col_row)) return;
 
-    const auto index = FromColRowToIndex(col_row);
-    cells_[index].is_walkable = is_walkable;
+    const auto col = static_cast<std::size_t>(col_row.x);
+    const auto row = static_cast<std::size_t>(col_row.y);
+    if (IsWalkableInside(col, row) == is_walkable) return;
+
+    if (chunked_map_) {
+        chunked_map_->SetIsWalkable(col, row, is_walkable);
+        RecordChange(col, row);
+        return;
+    }
+
+    MakeOverlay();
+    SetIsWalkableInside(col, row, is_walkable);
+    UpdateExits(col_row);
+    for (const auto& offset : kExitOffsets) {
+        UpdateExits(col_row + offset);
+    }
+    RecordChange(col, row);
+}
+
+std::uint64_t GameMap::GetVersion() const {
+    return version_;
+}
+
+bool GameMap::GetChangesSince(std::uint64_t version, std::vector<std::uint32_t>& changed_cells) const {
+    changed_cells.clear();
+    if (version < journal_start_version_ || version > version_ || version_ - version > kJournalCapacity) return false;
+
+    for (auto change_version = version + 1; change_version <= version_; ++change_version) {
+        changed_cells.push_back(journal_[change_version % kJournalCapacity]);
+    }
+    std::sort(changed_cells.begin(), changed_cells.end());
+    changed_cells.erase(std::unique(changed_cells.begin(), changed_cells.end()), changed_cells.end());
+    return true;
+}
+
+std::uint64_t GameMap::GetLoadedVersion() const {
+    return journal_start_version_;
+}
+
+void GameMap::SetHouseDoor(Vec2<int> col_row) {
+    if (house_door_ == col_row) return;
+
+    MakeOverlay();
+    const auto previous_house_door = house_door_;
+    house_door_ = col_row;
+    UpdateExits(previous_house_door);
+    UpdateExits(house_door_);
+}
+
+bool GameMap::IsHouseDoor(Vec2<int> col_row) const {
+    return (house_door_ == col_row);
+}
+
+std::uint8_t GameMap::GetExits(std::size_t index) const {
+    if (!IsInsideBoundaries(index)) return 0;
+    if (!chunked_map_) return exits_[index] & kExitsAll;
+
+    const auto [row, col] = geometry_.FromIndexToColRow(index);
+    return chunked_map_->GetExits(col, row);
+}
+
+std::uint8_t GameMap::GetEntityExits(Vec2<int> col_row) const {
+    if (!AreColRowInsideBoundaries(col_row)) return 0;
+
+    const auto exits = GetExitsAndMoves(col_row);
+    return exits & (exits >> kEntityMovesShift);
+}
+
+std::uint8_t GameMap::GetEntityMoves(Vec2<int> col_row) const {
+    if (!AreColRowInsideBoundaries(col_row)) return 0;
+
+    return GetExitsAndMoves(col_row) >> kEntityMovesShift;
 }
 
 bool GameMap::AreCoordsWalkable(Vec2<float> coords) const {
     if (!AreCoordsInsideBoundaries(coords)) return false;
     
     const auto col_row = FromCoordsToColRow(coords);
-    const auto index = FromColRowToIndex(col_row);
-    return cells_[index].is_walkable;
+    return IsWalkableInside(col_row.x, col_row.y);
 }
 
 bool GameMap::AreColRowWalkable(Vec2<int> col_row) const {
     if (!AreColRowInsideBoundaries(col_row)) return false;
 
-    const auto index = FromColRowToIndex(col_row);
-    return cells_[index].is_walkable;
+    return IsWalkableInside(col_row.x, col_row.y);
 }
 
 bool GameMap::IsWalkable(std::size_t index) const {
-    return (index < cells_count_ && cells_[index].is_walkable);
+    if (!IsInsideBoundaries(index)) return false;
+
+    const auto [row, col] = geometry_.FromIndexToColRow(index);
+    return IsWalkableInside(col, row);
 }
 
 bool GameMap::AreColRowInsideBoundaries(Vec2<int> col_row) const {
@@ -101,8 +283,8 @@ void GameMap::ClampColRowIntoMapDimensions(Vec2<int>& col_row) const {
 }
 
 Vec2<float> GameMap::FromColRowToCoords(Vec2<int> col_row) const {
-    const auto index = FromColRowToIndex(col_row);
-    return cells_[index].position;
+    return {padding_.x + static_cast<float>(col_row.x) * cell_size_float_,
+            padding_.y + static_cast<float>(col_row.y) * cell_size_float_};
 }
 
 bool GameMap::AreCoordsInsideBoundaries(Vec2<float> coords) const {
@@ -115,24 +297,25 @@ std::size_t GameMap::FromColRowToIndex(Vec2<int> col_row) const {
 }
 
 Vec2<int> GameMap::FromIndexToColRow(std::size_t index) const {
-    return {static_cast<int>(index / cols_count_),
-            static_cast<int>(index % cols_count_)};
+    return geometry_.FromIndexToColRow(index);
 }
 
 Vec2<int> GameMap::FromCoordsToColRow(Vec2<float> coords) const {
-    return {static_cast<int>(coords.x - padding_.x) / cell_size_int_,
-            static_cast<int>(coords.y - padding_.y) / cell_size_int_};
+    return geometry_.FromPixelsToColRow(Vec2{static_cast<int>(coords.x - padding_.x), static_cast<int>(coords.y - padding_.y)});
 }
 
 Vec2<float> GameMap::FromCoordsToCenterCellCoords(Vec2<float> coords) const {
-    const auto& cell = GetCell(coords);
-    return cell.center;
+    return GetCell(coords).center;
 }
 
 bool GameMap::IsInsideBoundaries(std::size_t index) const {
     return (index < cells_count_);
 }
 
+const MapGeometry& GameMap::GetGeometry() const {
+    return geometry_;
+}
+
 std::size_t GameMap::GetRowsCount() const {
     return rows_count_;
 }
@@ -145,19 +328,35 @@ std::size_t GameMap::GetCellsCount() const {
     return cells_count_;
 }
 
-const GameMap::Cell& GameMap::GetCell(Vec2<int> col_row) const {
-    const auto index = FromColRowToIndex(col_row);
-    return cells_[index];
+GameMap::Cell GameMap::GetCell(std::size_t index) const {
+    const auto [row, col] = geometry_.FromIndexToColRow(index);
+    const auto col_row = Vec2{col, row};
+    return Cell(index, FromColRowToCoords(col_row), padding_ + geometry_.GetCellCenter(col_row),
+        static_cast<std::size_t>(row), static_cast<std::size_t>(col), IsWalkableInside(col, row));
 }
 
-const GameMap::Cell& GameMap::GetCell(Vec2<float> coords) const {
-    const auto col_row = FromCoordsToColRow(coords);
-    const auto index = FromColRowToIndex(col_row);
-    return cells_[index];
+GameMap::Cell GameMap::GetCell(Vec2<int> col_row) const {
+    return GetCell(FromColRowToIndex(col_row));
+}
+
+GameMap::Cell GameMap::GetCell(Vec2<float> coords) const {
+    return GetCell(FromColRowToIndex(FromCoordsToColRow(coords)));
 }
 
-const std::vector<GameMap::Cell>& GameMap::GetCells() const {
-    return cells_;
+GameMap::CellsView GameMap::GetCells() const {
+    return CellsView(*this);
+}
+
+std::size_t GameMap::GetMemoryUsage() const {
+    // The overlay replaces the asset's arrays, which other maps may still read.
+    const auto asset_memory_usage = asset_ ? asset_->GetMemoryUsage() : 0;
+    return GetOwnedMemoryUsage() + (overlay_exits_.empty() ? asset_memory_usage : 0);
+}
+
+std::size_t GameMap::GetOwnedMemoryUsage() const {
+    return overlay_walkable_blocks_.capacity() * sizeof(std::uint64_t) + overlay_exits_.capacity() +
+           journal_.capacity() * sizeof(std::uint32_t) +
+           (chunked_map_ ? chunked_map_->GetMemoryUsage() : 0);
 }
 
 std::size_t GameMap::GetCellSize() const {
@@ -171,3 +370,62 @@ int GameMap::GetCellSizeInt() const {
 float GameMap::GetCellSizeFloat() const {
     return cell_size_float_;
 }
+
+bool GameMap::IsWalkableInside(std::size_t col, std::size_t row) const {
+    if (chunked_map_) return chunked_map_->IsWalkable(col, row);
+
+    const auto block = walkable_blocks_[(row >> kBlockShift) * blocks_per_row_ + (col >> kBlockShift)];
+    return (block >> (((row & kBlockMask) << kBlockShift) | (col & kBlockMask))) & 1;
+}
+
+void GameMap::SetIsWalkableInside(std::size_t col, std::size_t row, bool is_walkable) {
+    auto& block = overlay_walkable_blocks_[(row >> kBlockShift) * blocks_per_row_ + (col >> kBlockShift)];
+    const auto bit = std::uint64_t{1} << (((row & kBlockMask) << kBlockShift) | (col & kBlockMask));
+    block = is_walkable ? (block | bit) : (block & ~bit);
+}
+
+void GameMap::SetDimensions(std::size_t cols_count, std::size_t rows_count) {
+    rows_count_ = rows_count;
+    cols_count_ = cols_count;
+    rows_count_int_ = static_cast<int>(rows_count_);
+    cols_count_int_ = static_cast<int>(cols_count_);
+    cells_count_ = rows_count_ * cols_count_;
+    width_ = static_cast<float>(cols_count_ * cell_size_);
+    height_ = static_cast<float>(rows_count_ * cell_size_);
+    geometry_ = MapGeometry(cols_count_, rows_count_, cell_size_);
+}
+
+// Chunked maps keep their own exits; the moves only depend on the door.
+void GameMap::UpdateExits(Vec2<int> col_row) {
+    if (chunked_map_ || !AreColRowInsideBoundaries(col_row)) return;
+
+    const auto exits = ComputeExits(col_row, [this](Vec2<int> neighbour) { return AreColRowWalkable(neighbour); });
+    const auto moves = ComputeEntityMoves(IsWalkableInside(col_row.x, col_row.y), IsHouseDoor(col_row));
+    overlay_exits_[FromColRowToIndex(col_row)] = exits | (moves << kEntityMovesShift);
+}
+
+void GameMap::MakeOverlay() {
+    if (!overlay_exits_.empty() || !asset_) return;
+
+    const auto walkable_blocks = asset_->GetWalkableBlocks();
+    const auto exits = asset_->GetExitsAndMoves();
+    overlay_walkable_blocks_.assign(walkable_blocks.begin(), walkable_blocks.end());
+    overlay_exits_.assign(exits.begin(), exits.end());
+    walkable_blocks_ = overlay_walkable_blocks_.data();
+    exits_ = overlay_exits_.data();
+}
+
+std::uint8_t GameMap::GetExitsAndMoves(Vec2<int> col_row) const {
+    if (!chunked_map_) return exits_[FromColRowToIndex(col_row)];
+
+    const auto moves = ComputeEntityMoves(IsWalkableInside(col_row.x, col_row.y), IsHouseDoor(col_row));
+    return chunked_map_->GetExits(col_row.x, col_row.y) | (moves << kEntityMovesShift);
+}
+
+// The journal is only allocated once the map changes.
+void GameMap::RecordChange(std::size_t col, std::size_t row) {
+    if (journal_.empty()) journal_.assign(kJournalCapacity, 0);
+
+    ++version_;
+    journal_[version_ % kJournalCapacity] = static_cast<std::uint32_t>(row * cols_count_ + col);
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <random>
 
 namespace {
@@ -33,7 +34,6 @@ Ghost::Ghost(
     Renderer& renderer,
     TextureManager& texture_manager,
     const GameMap& game_map,
-    Pathfinder& pathfinder,
     const Level& level,
     std::string name,
     EType type,
@@ -42,21 +42,25 @@ Ghost::Ghost(
     PathfindingPattern pathfinding_pattern)
     : EntityMovable(renderer, renderer_rect, game_map, level.GetSpeedGhost(), direction, .8f)
     , texture_manager_(texture_manager)
-    , pathfinder_(pathfinder)
     , level_(level)
     , name_(name)
     , type_(type)
     , patfinder_pattern_(pathfinding_pattern)
     , state_(EState::HOUSING)
     , state_previous_(state_)
-    , path_index_(0)
     , is_moving_between_tiles_(false)
+    , path_index_(0)
+    , home_field_(game_map)
     , animation_timer_(0.1f)
     , sprite_index_(0) {
     Init();
 }
 
 void Ghost::Init() {
+    col_row_house_ = game_map_.FromCoordsToColRow(
+        Vec2<float>{starting_renderer_rect_.x, starting_renderer_rect_.y});
+    home_field_.Update(col_row_house_);
+
     sprite_sheet_ = texture_manager_.LoadTexture(kAssetsFolderImages + "spritesheet.png");
     SetStateStop();
     
@@ -119,14 +123,41 @@ void Ghost::FindPath(GameScene& game) {
 
     const auto& center_pos = GetCenterPosition();
     const auto col_row = game_map_.FromCoordsToColRow(center_pos);
-    path_index_ = 1;
-    path_ = patfinder_pattern_(col_row, game);
+    patfinder_pattern_(col_row, game, next_path_);
+    // Keep following the previous path while a scheduled search is pending, or
+    // when its result doesn't go through the ghost's cell, as long as the ghost
+    // is still on it.
+    if (next_path_.empty()) {
+        if (!IsOnPath(col_row)) path_.clear();
+        return;
+    }
+
+    // A scheduled result may start from a cell the ghost already left behind.
+    const auto it = std::find(next_path_.begin(), next_path_.end(), col_row);
+    if (it == next_path_.end()) {
+        if (!IsOnPath(col_row)) path_.clear();
+        return;
+    }
+
+    path_index_ = static_cast<std::size_t>(std::distance(next_path_.begin(), it)) + 1;
+    path_.swap(next_path_);
+}
+
+bool Ghost::IsOnPath(Vec2<int> col_row) const {
+    return (path_index_ > 0 && path_index_ <= path_.size() && path_[path_index_ - 1] == col_row);
 }
 
 void Ghost::StepPath(float dt) {
+    if (StepToCell(dt, path_[path_index_])) {
+        path_index_++;
+    }
+}
+
+// Returns true when the center reaches the cell center.
+bool Ghost::StepToCell(float dt, Vec2<int> col_row) {
     is_moving_between_tiles_ = true;
 
-    const auto& target_cell = game_map_.GetCell(path_[path_index_]); 
+    const auto target_cell = game_map_.GetCell(col_row);
     const auto target_coords = target_cell.center;
 
     SetDirectionByTarget(target_coords);
@@ -136,8 +167,9 @@ void Ghost::StepPath(float dt) {
     auto diff_length = (GetCenterPosition() - target_coords).Length();
     if (diff_length <= threshold) {
         is_moving_between_tiles_ = false;
-        path_index_++;
+        return true;
     }
+    return false;
 }
 
 void Ghost::UpdateStateFrightened(float dt, GameScene& game_scene) {
@@ -145,7 +177,7 @@ void Ghost::UpdateStateFrightened(float dt, GameScene& game_scene) {
         timer_frightened_intermittent_.Update(dt);
     }
 
-    const auto& cell = game_map_.GetCell(GetCenterPosition());
+    const auto cell = game_map_.GetCell(GetCenterPosition());
     if (DidReachCellCenter() && cell.cell_index != last_visited_cell_index_) {
         const auto dir = ChooseRandomDirection();
         if (IsOrthogonalTurn(dir)) {
@@ -165,8 +197,10 @@ EDirection Ghost::ChooseRandomDirection() const {
         EDirection::RIGHT
     };
 
+    // Only called at a cell center, where the exits are the ways out.
+    const auto exits = game_map_.GetEntityExits(game_map_.FromCoordsToColRow(GetCenterPosition()));
     auto is_unwanted_direction = [&](EDirection d) {
-        return (!IsMovableDirection(d) || d == GetOppositeDirection());
+        return (!(exits & GetExit(d)) || d == GetOppositeDirection());
     };
     auto directions_end = std::remove_if(directions.begin(), directions.end(), is_unwanted_direction);
     if (std::distance(directions.begin(), directions_end) > 1) {
@@ -177,14 +211,20 @@ EDirection Ghost::ChooseRandomDirection() const {
     return *directions.begin();
 }
 
+// The next hop is read from the home field at each cell center. A cell that
+// can't reach the house has no next hop either, so the eyes stop there.
 void Ghost::UpdateStateEyes(float dt, GameScene& game_scene) {
-    if (path_index_ >= path_.size()) {
-        SetStateHousing();
-        game_scene.GhostInEyesStateArrivedToHouse();    
-        return;
+    if (!is_moving_between_tiles_) {
+        const auto col_row_next = home_field_.GetNextStep(col_row_eyes_);
+        if (col_row_next == col_row_eyes_) {
+            SetStateHousing();
+            game_scene.GhostInEyesStateArrivedToHouse();
+            return;
+        }
+        col_row_eyes_ = col_row_next;
     }
 
-    StepPath(dt);
+    StepToCell(dt, col_row_eyes_);
     const auto dir_vector = GetDirectionVector();
     if (dir_vector.y != 0) {
         CenterAxisX();
@@ -249,12 +289,12 @@ unsigned int Ghost::Die(int died_in_same_frightened_count) {
     const auto col_row_from = game_map_.FromCoordsToColRow({hitbox.x, hitbox.y});
     const auto fixed_coords = game_map_.FromColRowToCoords(col_row_from);
     UpdatePosition(fixed_coords);
-    
-    path_index_ = 0;
-    const auto col_row_to = game_map_.FromCoordsToColRow(
-        Vec2<float>{starting_renderer_rect_.x, starting_renderer_rect_.y});
-    path_ = pathfinder_.FindPath(col_row_from, col_row_to);
-    
+
+    // Only floods again if the map changed since the last death.
+    home_field_.Update(col_row_house_);
+    col_row_eyes_ = col_row_from;
+    is_moving_between_tiles_ = true;
+
     return (kScoreBase * died_in_same_frightened_count);
 }
 
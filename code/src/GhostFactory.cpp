@@ -21,13 +21,12 @@ std::unique_ptr<Ghost> GhostFactory::CreateGhostBlinky() {
         renderer_,
         texture_manager_,
         game_map_,
-        pathfinder_,
         level_,
         "Blinky",
         Ghost::EType::RED,
         SDL_FRect{coords.x, coords.y, 30.f, 30.f},
         EDirection::RIGHT,
-        FindPathPatternBlinky);
+        MakePathfindingPattern("Blinky", FindTargetPatternBlinky, game_map_, pathfinder_));
 }
 
 std::unique_ptr<Ghost> GhostFactory::CreateGhostInky() {
@@ -36,13 +35,12 @@ std::unique_ptr<Ghost> GhostFactory::CreateGhostInky() {
         renderer_,
         texture_manager_,
         game_map_,
-        pathfinder_,
         level_,
         "Inky",
         Ghost::EType::BLUE,
         SDL_FRect{coords.x, coords.y, 30.f, 30.f},
         EDirection::DOWN,
-        FindPathPatternInky);
+        MakePathfindingPattern("Inky", FindTargetPatternInky, game_map_, pathfinder_));
 }
 
 std::unique_ptr<Ghost> GhostFactory::CreateGhostPinky() {
@@ -51,13 +49,12 @@ std::unique_ptr<Ghost> GhostFactory::CreateGhostPinky() {
         renderer_,
         texture_manager_,
         game_map_,
-        pathfinder_,
         level_,
         "Pinky",
         Ghost::EType::PINK,
         SDL_FRect{coords.x, coords.y, 30.f, 30.f},
         EDirection::UP,
-        FindPathPatternPinky);
+        MakePathfindingPattern("Pinky", FindTargetPatternPinky, game_map_, pathfinder_));
 }
 
 std::unique_ptr<Ghost> GhostFactory::CreateGhostClyde() {
@@ -66,11 +63,10 @@ std::unique_ptr<Ghost> GhostFactory::CreateGhostClyde() {
         renderer_,
         texture_manager_,
         game_map_,
-        pathfinder_,
         level_,
         "Clyde",
         Ghost::EType::YELLOW,
         SDL_FRect{coords.x, coords.y, 30.f, 30.f},
         EDirection::DOWN,
-        FindPathPatternClyde);
+        MakePathfindingPattern("Clyde", FindTargetPatternClyde, game_map_, pathfinder_));
 }
@@ -5,23 +5,119 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace {
+struct PatternState {
+    IncrementalPlanner planner;
+    std::uint32_t requester {PathfindingScheduler::kNoRequester};
+    std::string name;
+    std::uint32_t stats_ghost {PathfinderStats::kNoGhost};
+};
+
+// Chasers on the player's cell follow the shared distance field, which costs O(1)
+// per step. Any other target is resolved first: wall targets are snapped to their
+// nearest walkable cell and unreachable ones keep the ghost where it is, so no
+// search floods the map looking for them. Then the table walks the path. On maps
+// too big for the table the path cache is asked next, then the search is queued
+// on the scheduler, and the empty path returned until it lands keeps the ghost on
+// its previous one; with the scheduler disabled the ghost's own planner repairs
+// its last search instead. Both results go into the cache.
+//
+// Returns where the path came from, for the stats.
+PathfinderStats::ESource FindPathToTarget(
+    const Vec2<int>& col_row_ghost,
+    Vec2<int> col_row_target,
+    GameScene& game,
+    PatternState& state,
+    Pathfinder::Path& path) {
+    const auto& distance_field = game.GetPlayerDistanceField();
+    if (distance_field.GetTarget() == col_row_target && distance_field.IsReachable(col_row_ghost)) {
+        distance_field.FindPath(col_row_ghost, path);
+        return PathfinderStats::ESource::DISTANCE_FIELD;
+    }
+
+    if (!game.GetReachabilityIndex().ResolveTarget(col_row_ghost, col_row_target)) {
+        path.assign(1, col_row_ghost);
+        return PathfinderStats::ESource::UNREACHABLE;
+    }
+
+    auto& path_table = game.GetPathTable();
+    if (path_table.IsEnabled()) {
+        path_table.FindPath(col_row_ghost, col_row_target, path);
+        return PathfinderStats::ESource::PATH_TABLE;
+    }
+
+    auto& path_cache = game.GetPathCache();
+    if (path_cache.Lookup(col_row_ghost, col_row_target, path)) return PathfinderStats::ESource::PATH_CACHE;
+
+    auto& scheduler = game.GetPathfindingScheduler();
+    if (!scheduler.IsEnabled()) {
+        state.planner.FindPath(col_row_ghost, col_row_target, path);
+        path_cache.Insert(col_row_ghost, col_row_target, path);
+        return PathfinderStats::ESource::PLANNER;
+    }
+
+    if (state.requester == PathfindingScheduler::kNoRequester) {
+        state.requester = scheduler.AddRequester();
+    }
+    // A result searched before the map changed may cross new walls, and one for an
+    // older target still moves the ghost but isn't cached under the new one.
+    scheduler.TakeResult(state.requester, path);
+    if (!path.empty() && scheduler.GetResultMapVersion(state.requester) != game.GetMap().GetVersion()) {
+        path.clear();
+    }
+    if (!path.empty() && scheduler.GetResultTarget(state.requester) == col_row_target) {
+        path_cache.Insert(path.front(), col_row_target, path);
+    }
+    scheduler.Request(state.requester, col_row_ghost, col_row_target);
+    return PathfinderStats::ESource::SCHEDULER;
+}
+}
+
+PathfindingPattern MakePathfindingPattern(
+    std::string name,
+    TargetPattern target_pattern,
+    const GameMap& map,
+    IPathfinder& fallback) {
+    auto state = std::make_shared<PatternState>(
+        PatternState{IncrementalPlanner(map, fallback), PathfindingScheduler::kNoRequester, std::move(name)});
+    return [target_pattern, state](Vec2<int> col_row_ghost, GameScene& game, Pathfinder::Path& path) {
+#if defined(PACMAN_PATHFINDER_STATS)
+        auto& stats = game.GetPathfinderStats();
+        if (state->stats_ghost == PathfinderStats::kNoGhost) {
+            state->stats_ghost = stats.AddGhost(state->name, &state->planner);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto source = FindPathToTarget(col_row_ghost, target_pattern(col_row_ghost, game), game, *state, path);
+        const auto microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        const bool is_planner = (source == PathfinderStats::ESource::PLANNER);
+        stats.Record(state->stats_ghost, source, {
+            is_planner ? state->planner.GetExpandedNodesCount() : 0,
+            is_planner ? state->planner.GetOpenNodesPeakCount() : 0,
+            microseconds,
+            path.size()});
+#else
+        FindPathToTarget(col_row_ghost, target_pattern(col_row_ghost, game), game, *state, path);
+#endif
+    };
+}
 
 // Rules:
 // Always try to chase the player.
-Pathfinder::Path FindPathPatternBlinky(const Vec2<int>& col_row_ghost, GameScene& game) {
-    auto& pathfinder = game.GetPathfinder();
+Vec2<int> FindTargetPatternBlinky(const Vec2<int>& /*col_row_ghost*/, GameScene& game) {
     const auto& game_map = game.GetMap();
     const auto player_position = game.GetPlayer().GetCenterPosition();
-    const auto col_row_player = game_map.FromCoordsToColRow(player_position);
-    
-    return pathfinder.FindPath(col_row_ghost, col_row_player);
+    return game_map.FromCoordsToColRow(player_position);
 }
 
 // Rules:
 // 1. Imaginary point 2 cells through player's direction.
 // 2. Then: Target = (2 * Imaginary Point) - Blinky's position)
-Pathfinder::Path FindPathPatternInky(const Vec2<int>& col_row_ghost, GameScene& game) {
-    auto& pathfinder = game.GetPathfinder();
+Vec2<int> FindTargetPatternInky(const Vec2<int>& /*col_row_ghost*/, GameScene& game) {
     const auto& game_map = game.GetMap();
     const auto player_position = game.GetPlayer().GetCenterPosition();
     const auto row_col_player = game_map.FromCoordsToColRow(player_position);
@@ -43,13 +139,12 @@ Pathfinder::Path FindPathPatternInky(const Vec2<int>& col_row_ghost, GameScene&
         2 * row_col_imaginary.y - col_row_blinky.y};
     game_map.ClampColRowIntoMapDimensions(col_row_target);
 
-    return pathfinder.FindPath(col_row_ghost, col_row_target);
+    return col_row_target;
 }
 
 // Rules:
 // 4 tiles facing player's direction.
-Pathfinder::Path FindPathPatternPinky(const Vec2<int>& col_row_ghost, GameScene& game) {
-    auto& pathfinder = game.GetPathfinder();
+Vec2<int> FindTargetPatternPinky(const Vec2<int>& /*col_row_ghost*/, GameScene& game) {
     const auto& game_map = game.GetMap();
     const auto player_position = game.GetPlayer().GetCenterPosition();
     auto col_row_player = game_map.FromCoordsToColRow(player_position);
@@ -62,14 +157,13 @@ Pathfinder::Path FindPathPatternPinky(const Vec2<int>& col_row_ghost, GameScene&
     };
     game_map.ClampColRowIntoMapDimensions(col_row_target);
 
-    return pathfinder.FindPath(col_row_ghost, col_row_target);
+    return col_row_target;
 }
 
 // Rules:
 // If player is farder or equal to a euclidean distance of kLimitDistance, then try to chase player.
 // Otherwise, go to the bottom left corner.
-Pathfinder::Path FindPathPatternClyde(const Vec2<int>& col_row_ghost, GameScene& game) {
-    auto& pathfinder = game.GetPathfinder();
+Vec2<int> FindTargetPatternClyde(const Vec2<int>& col_row_ghost, GameScene& game) {
     const auto& game_map = game.GetMap();
     const auto player_position = game.GetPlayer().GetCenterPosition();
     const auto col_row_player = game_map.FromCoordsToColRow(player_position);
@@ -79,12 +173,11 @@ Pathfinder::Path FindPathPatternClyde(const Vec2<int>& col_row_ghost, GameScene&
         col_row_ghost.y - col_row_player.y,
         col_row_ghost.x - col_row_player.x);
     
-    Vec2<int> col_row_target;
-    if (distance < kLimitDistance) {
-        col_row_target.y = static_cast<int>(game_map.GetRowsCount()) - 1;
-    } else {
-        col_row_target = col_row_player;
+    if (distance >= kLimitDistance) {
+        return col_row_player;
     }
 
-    return pathfinder.FindPath(col_row_ghost, col_row_target);
+    Vec2<int> col_row_target;
+    col_row_target.y = static_cast<int>(game_map.GetRowsCount()) - 1;
+    return col_row_target;
 }
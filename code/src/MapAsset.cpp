@@ -0,0 +1,79 @@
+#include "MapAsset.hpp"
+
+#include "GameMap.hpp"
+
+MapAsset::MapAsset(const MapView& map, std::size_t cell_size, Vec2<int> house_door_col_row)
+    : geometry_(map.cols_count, map.rows_count, cell_size)
+    , house_door_(house_door_col_row)
+    , blocks_per_row_((map.cols_count + kBlockMask) >> kBlockShift)
+    , walkable_blocks_(blocks_per_row_ * ((map.rows_count + kBlockMask) >> kBlockShift), 0)
+    , exits_and_moves_(map.cols_count * map.rows_count, 0) {
+    std::size_t index = 0;
+    for (std::size_t row = 0; row < map.rows_count; ++row) {
+        for (std::size_t col = 0; col < map.cols_count; ++col, ++index) {
+            if (map.tiles[index] != 0) continue;
+
+            walkable_blocks_[(row >> kBlockShift) * blocks_per_row_ + (col >> kBlockShift)] |=
+                std::uint64_t{1} << (((row & kBlockMask) << kBlockShift) | (col & kBlockMask));
+        }
+    }
+
+    index = 0;
+    for (int row = 0; row < static_cast<int>(map.rows_count); ++row) {
+        for (int col = 0; col < static_cast<int>(map.cols_count); ++col, ++index) {
+            const auto col_row = Vec2{col, row};
+            const auto exits = GameMap::ComputeExits(col_row, [this](Vec2<int> neighbour) { return IsWalkable(neighbour); });
+            const auto moves = GameMap::ComputeEntityMoves(IsWalkable(col_row), col_row == house_door_);
+            exits_and_moves_[index] = exits | (moves << kEntityMovesShift);
+        }
+    }
+
+    ForEachCollectableSpawn(geometry_, map.collectables, [this](const CollectableSpawn& spawn) {
+        collectable_spawns_.push_back(spawn);
+    });
+    collectable_spawns_.shrink_to_fit();
+}
+
+std::shared_ptr<const MapAsset> MapAsset::Create(const MapView& map, std::size_t cell_size, Vec2<int> house_door_col_row) {
+    return std::make_shared<const MapAsset>(map, cell_size, house_door_col_row);
+}
+
+const MapGeometry& MapAsset::GetGeometry() const {
+    return geometry_;
+}
+
+Vec2<int> MapAsset::GetHouseDoor() const {
+    return house_door_;
+}
+
+std::size_t MapAsset::GetBlocksPerRow() const {
+    return blocks_per_row_;
+}
+
+std::span<const std::uint64_t> MapAsset::GetWalkableBlocks() const {
+    return walkable_blocks_;
+}
+
+std::span<const std::uint8_t> MapAsset::GetExitsAndMoves() const {
+    return exits_and_moves_;
+}
+
+std::span<const CollectableSpawn> MapAsset::GetCollectableSpawns() const {
+    return collectable_spawns_;
+}
+
+std::size_t MapAsset::GetMemoryUsage() const {
+    return sizeof(MapAsset) +
+           walkable_blocks_.capacity() * sizeof(std::uint64_t) +
+           exits_and_moves_.capacity() +
+           collectable_spawns_.capacity() * sizeof(CollectableSpawn);
+}
+
+bool MapAsset::IsWalkable(Vec2<int> col_row) const {
+    if (!geometry_.AreColRowInsideBoundaries(col_row)) return false;
+
+    const auto col = static_cast<std::size_t>(col_row.x);
+    const auto row = static_cast<std::size_t>(col_row.y);
+    const auto block = walkable_blocks_[(row >> kBlockShift) * blocks_per_row_ + (col >> kBlockShift)];
+    return (block >> (((row & kBlockMask) << kBlockShift) | (col & kBlockMask))) & 1;
+}
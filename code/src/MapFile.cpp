@@ -0,0 +1,193 @@
+#include "MapFile.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <SDL2/SDL.h>
+
+namespace {
+static const std::uint32_t kMagic = 0x50414D50; // "PMAP"
+static const std::uint32_t kFormatVersion = 1;
+static const std::string kBinaryExtension = ".pmap";
+
+static const char kCharWall = '#';
+static const char kCharFloor = ' ';
+static const char kCharPellet = '.';
+static const char kCharPowerPellet = 'o';
+static const char kCharComment = ';';
+
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t format_version;
+    std::uint32_t cols_count;
+    std::uint32_t rows_count;
+};
+}
+
+bool MapFile::Load(const std::string& file_path) {
+    Clear();
+    const bool is_loaded = (std::filesystem::path(file_path).extension() == kBinaryExtension)
+        ? LoadBinary(file_path)
+        : LoadText(file_path);
+    if (!is_loaded) Clear();
+    return is_loaded;
+}
+
+bool MapFile::LoadOrCompile(const std::string& text_file_path) {
+    const auto binary_file_path = GetBinaryFilePath(text_file_path);
+    std::error_code error;
+    const auto text_time = std::filesystem::last_write_time(text_file_path, error);
+    if (error) {
+        SDL_Log("MapFile: can't find %s.", text_file_path.c_str());
+        return Load(binary_file_path);
+    }
+
+    const auto binary_time = std::filesystem::last_write_time(binary_file_path, error);
+    if (!error && binary_time >= text_time && Load(binary_file_path)) return true;
+
+    if (!Load(text_file_path)) return false;
+
+    // A map that can't be compiled is still playable from the parsed text.
+    if (!SaveBinary(view_, binary_file_path)) return true;
+    return Load(binary_file_path) || Load(text_file_path);
+}
+
+void MapFile::Load(MapLayout layout) {
+    Clear();
+    layout_ = std::move(layout);
+    view_ = *layout_;
+}
+
+bool MapFile::IsLoaded() const {
+    return !view_.tiles.empty();
+}
+
+MapView MapFile::GetView() const {
+    return view_;
+}
+
+bool MapFile::SaveText(const MapView& map, const std::string& file_path) {
+    std::ofstream file(file_path, std::ios::trunc);
+    file << kCharComment << " " << map.cols_count << "x" << map.rows_count << "\n";
+    std::string line(map.cols_count, kCharFloor);
+    for (std::size_t row = 0; row < map.rows_count; ++row) {
+        for (std::size_t col = 0; col < map.cols_count; ++col) {
+            const auto index = row * map.cols_count + col;
+            switch (map.tiles[index] ? 3 : map.collectables[index]) {
+                case 1:  line[col] = kCharPellet;      break;
+                case 2:  line[col] = kCharPowerPellet; break;
+                case 3:  line[col] = kCharWall;        break;
+                default: line[col] = kCharFloor;       break;
+            }
+        }
+        file << line << "\n";
+    }
+
+    if (!file) {
+        SDL_Log("MapFile: error writing %s.", file_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MapFile::SaveBinary(const MapView& map, const std::string& file_path) {
+    const FileHeader header {
+        kMagic,
+        kFormatVersion,
+        static_cast<std::uint32_t>(map.cols_count),
+        static_cast<std::uint32_t>(map.rows_count)};
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(map.tiles.data()), map.tiles.size_bytes());
+    file.write(reinterpret_cast<const char*>(map.collectables.data()), map.collectables.size_bytes());
+    if (!file) {
+        SDL_Log("MapFile: error writing %s.", file_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string MapFile::GetBinaryFilePath(const std::string& text_file_path) {
+    return std::filesystem::path(text_file_path).replace_extension(kBinaryExtension).string();
+}
+
+bool MapFile::LoadText(const std::string& file_path) {
+    std::ifstream file(file_path);
+    if (!file) {
+        SDL_Log("MapFile: can't open %s.", file_path.c_str());
+        return false;
+    }
+
+    std::size_t cols_count = 0;
+    std::size_t rows_count = 0;
+    std::vector<std::uint8_t> tiles;
+    std::vector<std::uint8_t> collectables;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(file, line); ++line_number) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line.front() == kCharComment) continue;
+
+        if (rows_count == 0) cols_count = line.size();
+        if (line.size() != cols_count) {
+            SDL_Log("MapFile: %s:%zu has %zu cells, the first row has %zu.", file_path.c_str(), line_number, line.size(), cols_count);
+            return false;
+        }
+
+        for (const auto cell : line) {
+            switch (cell) {
+                case kCharWall:        tiles.push_back(1); collectables.push_back(0); break;
+                case kCharFloor:       tiles.push_back(0); collectables.push_back(0); break;
+                case kCharPellet:      tiles.push_back(0); collectables.push_back(1); break;
+                case kCharPowerPellet: tiles.push_back(0); collectables.push_back(2); break;
+                default:
+                    SDL_Log("MapFile: %s:%zu has an unknown cell '%c'.", file_path.c_str(), line_number, cell);
+                    return false;
+            }
+        }
+        ++rows_count;
+    }
+
+    if (rows_count == 0) {
+        SDL_Log("MapFile: %s has no rows.", file_path.c_str());
+        return false;
+    }
+
+    Load(MapLayout(cols_count, rows_count, std::move(tiles), std::move(collectables)));
+    return true;
+}
+
+bool MapFile::LoadBinary(const std::string& file_path) {
+    if (!file_.Open(file_path)) {
+        SDL_Log("MapFile: can't open %s.", file_path.c_str());
+        return false;
+    }
+
+    FileHeader header;
+    bool is_valid = (file_.GetSize() >= sizeof(header));
+    if (is_valid) {
+        std::memcpy(&header, file_.GetData(), sizeof(header));
+        const std::size_t cells_count = static_cast<std::size_t>(header.cols_count) * header.rows_count;
+        is_valid = (header.magic == kMagic &&
+                    header.format_version == kFormatVersion &&
+                    cells_count > 0 &&
+                    file_.GetSize() == sizeof(header) + cells_count * 2);
+    }
+    if (!is_valid) {
+        SDL_Log("MapFile: %s isn't a compiled map.", file_path.c_str());
+        return false;
+    }
+
+    const std::size_t cells_count = static_cast<std::size_t>(header.cols_count) * header.rows_count;
+    const auto* tiles = file_.GetData() + sizeof(header);
+    view_ = MapView(header.cols_count, header.rows_count, {tiles, cells_count}, {tiles + cells_count, cells_count});
+    return true;
+}
+
+void MapFile::Clear() {
+    layout_.reset();
+    file_.Close();
+    view_ = MapView(0, 0, {}, {});
+}
@@ -0,0 +1,9 @@
+#include "MapLayout.hpp"
+
+#include "StockMap.hpp"
+
+MapLayout MapLayout::CreateDefault() {
+    return MapLayout(kColsCount, kRowsCount,
+        std::vector<std::uint8_t>(kStockMapTiles.begin(), kStockMapTiles.end()),
+        std::vector<std::uint8_t>(kStockMapCollectables.begin(), kStockMapCollectables.end()));
+}
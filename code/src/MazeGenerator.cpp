@@ -0,0 +1,257 @@
+#include "MazeGenerator.hpp"
+
+#include <array>
+#include <random>
+#include <utility>
+
+namespace {
+static const float kDefaultLoopsRatio = 0.1f;
+static const std::size_t kDefaultCorridorWidth = 1;
+static const Vec2<int> kNoHouseDoor {-1, -1};
+// In lattice cells: three wide around the middle column, two high.
+static const std::size_t kHouseWidth = 3;
+static const std::size_t kHouseHeight = 2;
+static const std::uint8_t kWall = 1;
+static const std::uint8_t kFloor = 0;
+static const std::uint8_t kPellet = 1;
+static const std::uint8_t kPowerPellet = 2;
+// East, west, north, south.
+static const std::array<Vec2<int>, 4> kDirections {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+
+// Straight from the engine rather than through the std distributions, whose output
+// differs between standard libraries: the same seed gives the same maze everywhere.
+std::size_t PickIndex(std::mt19937& rng, std::size_t count) {
+    return static_cast<std::size_t>(rng() % count);
+}
+
+bool IsChosen(std::mt19937& rng, float ratio) {
+    return static_cast<double>(rng()) < static_cast<double>(ratio) * 4294967296.0;
+}
+
+// Corridor cells, each with the walls on its right and below it open or not.
+// Opening a wall opens its mirror image as well, so the maze stays symmetric.
+class Lattice {
+public:
+    Lattice(std::size_t cols_count, std::size_t rows_count)
+        : cols_count_(cols_count)
+        , rows_count_(rows_count)
+        , middle_col_(static_cast<int>(cols_count / 2))
+        , is_right_open_(cols_count * rows_count, 0)
+        , is_down_open_(cols_count * rows_count, 0)
+        , is_house_(cols_count * rows_count, 0) {}
+
+    int GetMiddleCol() const { return middle_col_; }
+
+    // Inside the lattice and not in the ghost house.
+    bool IsCorridor(Vec2<int> cell) const {
+        return (cell.x >= 0 && cell.x < static_cast<int>(cols_count_) &&
+                cell.y >= 0 && cell.y < static_cast<int>(rows_count_) && !is_house_[GetIndex(cell)]);
+    }
+
+    bool IsLeftHalf(Vec2<int> cell) const { return IsCorridor(cell) && cell.x <= middle_col_; }
+
+    void SetIsHouse(Vec2<int> cell) { is_house_[GetIndex(cell)] = 1; }
+
+    bool IsOpen(Vec2<int> cell, std::size_t direction) const {
+        const auto [wall, is_right] = GetWall(cell, direction);
+        return (is_right ? is_right_open_ : is_down_open_)[GetIndex(wall)];
+    }
+
+    void Open(Vec2<int> cell, std::size_t direction) {
+        const auto [wall, is_right] = GetWall(cell, direction);
+        auto& is_open = is_right ? is_right_open_ : is_down_open_;
+        is_open[GetIndex(wall)] = 1;
+        // The wall right of col is the one right of cols - 2 - col in the mirror.
+        const auto mirror_col = static_cast<int>(cols_count_) - (is_right ? 2 : 1) - wall.x;
+        is_open[GetIndex(Vec2{mirror_col, wall.y})] = 1;
+    }
+
+    std::size_t GetDegree(Vec2<int> cell) const {
+        std::size_t degree = 0;
+        for (std::size_t direction = 0; direction < kDirections.size(); ++direction) {
+            degree += (IsCorridor(cell + kDirections[direction]) && IsOpen(cell, direction));
+        }
+        return degree;
+    }
+
+private:
+    std::size_t cols_count_;
+    std::size_t rows_count_;
+    int middle_col_;
+    std::vector<std::uint8_t> is_right_open_;
+    std::vector<std::uint8_t> is_down_open_;
+    std::vector<std::uint8_t> is_house_;
+
+    std::size_t GetIndex(Vec2<int> cell) const {
+        return static_cast<std::size_t>(cell.y) * cols_count_ + static_cast<std::size_t>(cell.x);
+    }
+
+    // The cell owning the wall, and whether it's the one on its right or below it.
+    static std::pair<Vec2<int>, bool> GetWall(Vec2<int> cell, std::size_t direction) {
+        switch (direction) {
+            case 0: return {cell, true};
+            case 1: return {cell + kDirections[1], true};
+            case 2: return {cell + kDirections[2], false};
+            default: return {cell, false};
+        }
+    }
+};
+}
+
+MazeGenerator::MazeGenerator(std::size_t cols_count, std::size_t rows_count, unsigned int seed)
+    : cols_count_(cols_count)
+    , rows_count_(rows_count)
+    , seed_(seed)
+    , loops_ratio_(kDefaultLoopsRatio)
+    , corridor_width_(kDefaultCorridorWidth) {}
+
+void MazeGenerator::SetLoopsRatio(float loops_ratio) {
+    loops_ratio_ = loops_ratio;
+}
+
+void MazeGenerator::SetCorridorWidth(std::size_t corridor_width) {
+    corridor_width_ = (corridor_width < 1) ? 1 : (corridor_width | 1);
+}
+
+GeneratedMaze MazeGenerator::Generate() const {
+    std::vector<std::uint8_t> tiles(cols_count_ * rows_count_, kWall);
+    std::vector<std::uint8_t> collectables(tiles.size(), 0);
+    const auto width = corridor_width_;
+    const auto period = width + 1;
+    auto lattice_cols_count = (cols_count_ > 0) ? (cols_count_ - 1) / period : 0;
+    if (lattice_cols_count % 2 == 0 && lattice_cols_count > 0) --lattice_cols_count;
+    const auto lattice_rows_count = (rows_count_ > 0) ? (rows_count_ - 1) / period : 0;
+    if (lattice_cols_count == 0 || lattice_rows_count == 0) {
+        return {MapLayout(cols_count_, rows_count_, std::move(tiles), std::move(collectables)), kNoHouseDoor};
+    }
+    const auto first_x = 1 + (cols_count_ - 1 - lattice_cols_count * period) / 2;
+
+    Lattice lattice(lattice_cols_count, lattice_rows_count);
+    const auto middle_col = lattice.GetMiddleCol();
+    const bool has_house = (lattice_cols_count >= kHouseWidth + 2 && lattice_rows_count >= kHouseHeight + 2);
+    const auto house_row = static_cast<int>((lattice_rows_count - kHouseHeight) / 2);
+    if (has_house) {
+        for (int row = house_row; row < house_row + static_cast<int>(kHouseHeight); ++row) {
+            for (int col = middle_col - 1; col <= middle_col + 1; ++col) lattice.SetIsHouse(Vec2{col, row});
+        }
+    }
+
+    // A spanning tree of the left half, mirrored into the right one.
+    std::mt19937 rng(seed_);
+    std::vector<std::uint8_t> is_visited(lattice_cols_count * lattice_rows_count, 0);
+    const auto visit = [&is_visited, lattice_cols_count](Vec2<int> cell) -> std::uint8_t& {
+        return is_visited[static_cast<std::size_t>(cell.y) * lattice_cols_count + static_cast<std::size_t>(cell.x)];
+    };
+    std::vector<Vec2<int>> stack {Vec2{0, 0}};
+    visit(Vec2{0, 0}) = 1;
+    std::vector<std::size_t> candidates;
+    while (!stack.empty()) {
+        const auto cell = stack.back();
+        candidates.clear();
+        for (std::size_t direction = 0; direction < kDirections.size(); ++direction) {
+            const auto next = cell + kDirections[direction];
+            if (lattice.IsLeftHalf(next) && !visit(next)) candidates.push_back(direction);
+        }
+        if (candidates.empty()) {
+            stack.pop_back();
+            continue;
+        }
+
+        const auto direction = candidates[PickIndex(rng, candidates.size())];
+        const auto next = cell + kDirections[direction];
+        lattice.Open(cell, direction);
+        visit(next) = 1;
+        stack.push_back(next);
+    }
+
+    // No dead ends: each one opens towards another dead end when it can.
+    for (int row = 0; row < static_cast<int>(lattice_rows_count); ++row) {
+        for (int col = 0; col <= middle_col; ++col) {
+            const auto cell = Vec2{col, row};
+            if (!lattice.IsCorridor(cell) || lattice.GetDegree(cell) != 1) continue;
+
+            candidates.clear();
+            bool has_dead_end = false;
+            for (std::size_t direction = 0; direction < kDirections.size(); ++direction) {
+                const auto next = cell + kDirections[direction];
+                if (!lattice.IsCorridor(next) || lattice.IsOpen(cell, direction)) continue;
+
+                const bool is_dead_end = (lattice.GetDegree(next) == 1);
+                if (is_dead_end && !has_dead_end) candidates.clear();
+                if (is_dead_end || !has_dead_end) candidates.push_back(direction);
+                has_dead_end |= is_dead_end;
+            }
+            if (candidates.empty()) continue;
+            lattice.Open(cell, candidates[PickIndex(rng, candidates.size())]);
+        }
+    }
+
+    // Then extra loops among the walls left, east and south of the left half.
+    for (int row = 0; row < static_cast<int>(lattice_rows_count); ++row) {
+        for (int col = 0; col <= middle_col; ++col) {
+            const auto cell = Vec2{col, row};
+            if (!lattice.IsCorridor(cell)) continue;
+
+            for (const std::size_t direction : {std::size_t{0}, std::size_t{3}}) {
+                const auto next = cell + kDirections[direction];
+                if (!lattice.IsLeftHalf(next) || lattice.IsOpen(cell, direction)) continue;
+                if (IsChosen(rng, loops_ratio_)) lattice.Open(cell, direction);
+            }
+        }
+    }
+
+    const auto fill = [this, &tiles](std::size_t first_col, std::size_t first_row, std::size_t cols, std::size_t rows) {
+        for (std::size_t row = first_row; row < first_row + rows; ++row) {
+            for (std::size_t col = first_col; col < first_col + cols; ++col) tiles[row * cols_count_ + col] = kFloor;
+        }
+    };
+    for (int row = 0; row < static_cast<int>(lattice_rows_count); ++row) {
+        for (int col = 0; col < static_cast<int>(lattice_cols_count); ++col) {
+            const auto cell = Vec2{col, row};
+            if (!lattice.IsCorridor(cell)) continue;
+
+            const auto x = first_x + static_cast<std::size_t>(col) * period;
+            const auto y = 1 + static_cast<std::size_t>(row) * period;
+            fill(x, y, width, width);
+            if (lattice.IsCorridor(cell + kDirections[0]) && lattice.IsOpen(cell, 0)) fill(x + width, y, 1, width);
+            if (lattice.IsCorridor(cell + kDirections[3]) && lattice.IsOpen(cell, 3)) fill(x, y + width, width, 1);
+        }
+    }
+
+    // The house is a single room, its door a tile on the mirror axis.
+    auto house_door = kNoHouseDoor;
+    const auto house_x = first_x + static_cast<std::size_t>(middle_col - 1) * period;
+    const auto house_y = 1 + static_cast<std::size_t>(house_row) * period;
+    const auto house_cols = kHouseWidth * period - 1;
+    const auto house_rows = kHouseHeight * period - 1;
+    if (has_house) {
+        fill(house_x, house_y, house_cols, house_rows);
+        house_door = Vec2{static_cast<int>(house_x + period + width / 2), static_cast<int>(house_y - 1)};
+        fill(static_cast<std::size_t>(house_door.x), static_cast<std::size_t>(house_door.y), 1, 1);
+    }
+
+    for (std::size_t row = 1; row < rows_count_; ++row) {
+        for (std::size_t col = 1; col < cols_count_; ++col) {
+            const auto index = row * cols_count_ + col;
+            // The door's row included.
+            const bool is_in_house = has_house &&
+                col >= house_x && col < house_x + house_cols && row + 1 >= house_y && row < house_y + house_rows;
+            const bool is_on_corridor_line = (col >= first_x && (col - first_x) % period == width / 2) || (row - 1) % period == width / 2;
+            if (tiles[index] == kFloor && !is_in_house && is_on_corridor_line) collectables[index] = kPellet;
+        }
+    }
+
+    // One row in from the top and bottom, in the first and last columns.
+    const auto power_row_top = (lattice_rows_count >= 3) ? 1 : 0;
+    const auto power_row_bottom = (lattice_rows_count >= 3) ? lattice_rows_count - 2 : lattice_rows_count - 1;
+    for (const auto row : {static_cast<std::size_t>(power_row_top), power_row_bottom}) {
+        for (const auto col : {std::size_t{0}, lattice_cols_count - 1}) {
+            const auto x = first_x + col * period + width / 2;
+            const auto y = 1 + row * period + width / 2;
+            collectables[y * cols_count_ + x] = kPowerPellet;
+        }
+    }
+
+    return {MapLayout(cols_count_, rows_count_, std::move(tiles), std::move(collectables)), house_door};
+}
@@ -0,0 +1,72 @@
+#include "PathfinderOverlay.hpp"
+
+#include "Constants.hpp"
+
+#include "pathfinder/IncrementalPlanner.hpp"
+
+#include <cstdio>
+
+namespace {
+static const int kFontSize = 8;
+static const int kLineHeight = 11;
+static const int kMarginX = 4;
+static const int kMarginY = 4;
+static const int kPanelWidth = 520;
+static const SDL_Color kPanelColor {0, 0, 0, 255};
+}
+
+PathfinderOverlay::PathfinderOverlay(Renderer& renderer, TextManager& text_manager)
+    : renderer_(renderer)
+    , font_(text_manager.LoadFont(kAssetsFolderFonts + "atari-full.ttf", kFontSize, "pathfinder-overlay")) {}
+
+void PathfinderOverlay::RenderCells(const PathfinderStats& stats, const Pathfinder& scheduler_pathfinder) {
+    bool is_scheduled = false;
+    for (std::uint32_t ghost = 0; ghost < stats.GetGhostsCount(); ++ghost) {
+        const auto source = stats.GetGhostLastSource(ghost);
+        const auto* planner = stats.GetGhostPlanner(ghost);
+        if (source == PathfinderStats::ESource::PLANNER && planner) planner->Render(renderer_);
+        is_scheduled |= (source == PathfinderStats::ESource::SCHEDULER);
+    }
+    if (is_scheduled) scheduler_pathfinder.Render(renderer_);
+}
+
+void PathfinderOverlay::RenderStats(const PathfinderStats& stats) {
+    if (!font_) return;
+
+    const auto window = stats.GetWindow();
+    const auto ticks_count = stats.GetTicksCount();
+    const auto lines_count = 3 + stats.GetGhostsCount() + window.sources.size();
+    renderer_.SetRenderingColor(kPanelColor);
+    renderer_.RenderRectFilled({0.f, 0.f, static_cast<float>(kPanelWidth), static_cast<float>(kMarginY * 2 + kLineHeight * lines_count)});
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "last %zu ticks    queries/tick  expanded/q  peak open  us/q  length  (scheduler %.1f steps/tick)",
+        ticks_count, ticks_count ? static_cast<double>(window.scheduler_steps_count) / ticks_count : 0.0);
+    int y = kMarginY;
+    renderer_.RenderText(*font_, line, kColorGray, kMarginX, y, false);
+
+    y += kLineHeight;
+    RenderLine("all", window.total, ticks_count, y);
+    for (std::uint32_t ghost = 0; ghost < stats.GetGhostsCount() && ghost < PathfinderStats::kMaxGhostsCount; ++ghost) {
+        y += kLineHeight;
+        RenderLine(stats.GetGhostName(ghost).c_str(), window.ghosts[ghost], ticks_count, y);
+    }
+    for (std::size_t source = 0; source < window.sources.size(); ++source) {
+        if (window.sources[source].queries_count == 0) continue;
+        y += kLineHeight;
+        RenderLine(PathfinderStats::GetSourceName(static_cast<PathfinderStats::ESource>(source)), window.sources[source], ticks_count, y);
+    }
+}
+
+void PathfinderOverlay::RenderLine(const char* name, const PathfinderStats::Totals& totals, std::size_t ticks_count, int y) {
+    const auto queries_count = static_cast<double>(totals.queries_count ? totals.queries_count : 1);
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-12s %8.2f %10.1f %10zu %8.1f %7.1f",
+        name,
+        ticks_count ? static_cast<double>(totals.queries_count) / ticks_count : 0.0,
+        static_cast<double>(totals.expanded_nodes_count) / queries_count,
+        totals.open_nodes_peak_count,
+        totals.microseconds / queries_count,
+        static_cast<double>(totals.path_cells_count) / queries_count);
+    renderer_.RenderText(*font_, line, kColorWhite, kMarginX, y, false);
+}
@@ -0,0 +1,90 @@
+#include "pathfinder/BatchPathfinder.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+
+BatchPathfinder::BatchPathfinder(const GameMap& map, std::size_t workers_count)
+    : batch_(0)
+    , busy_workers_count_(0)
+    , is_stopping_(false)
+    , paths_(nullptr)
+    , next_query_(0) {
+    if (workers_count == 0) {
+        workers_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // The last pathfinder belongs to the calling thread.
+    pathfinders_.reserve(workers_count);
+    for (std::size_t i = 0; i < workers_count; ++i) {
+        pathfinders_.emplace_back(map);
+    }
+    for (std::size_t i = 0; i + 1 < workers_count; ++i) {
+        threads_.emplace_back(&BatchPathfinder::RunWorker, this, i);
+    }
+}
+
+BatchPathfinder::~BatchPathfinder() {
+    {
+        std::lock_guard lock(mutex_);
+        is_stopping_ = true;
+    }
+    batch_ready_.notify_all();
+    for (auto& thread : threads_) { thread.join(); }
+}
+
+void BatchPathfinder::FindPaths(std::span<const Query> queries, std::vector<IPathfinder::Path>& paths) {
+    paths.resize(queries.size());
+    if (queries.empty()) return;
+
+    {
+        std::lock_guard lock(mutex_);
+        queries_ = queries;
+        paths_ = &paths;
+        next_query_ = 0;
+        busy_workers_count_ = threads_.size();
+        ++batch_;
+    }
+    batch_ready_.notify_all();
+
+    SolveQueries(pathfinders_.back());
+
+    std::unique_lock lock(mutex_);
+    batch_done_.wait(lock, [this]() { return busy_workers_count_ == 0; });
+    paths_ = nullptr;
+}
+
+std::size_t BatchPathfinder::GetWorkersCount() const {
+    return pathfinders_.size();
+}
+
+void BatchPathfinder::RunWorker(std::size_t worker) {
+    std::uint64_t last_batch = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            batch_ready_.wait(lock, [this, last_batch]() { return is_stopping_ || batch_ != last_batch; });
+            if (is_stopping_) return;
+            last_batch = batch_;
+        }
+
+        SolveQueries(pathfinders_[worker]);
+
+        std::lock_guard lock(mutex_);
+        if (--busy_workers_count_ == 0) batch_done_.notify_one();
+    }
+}
+
+// Each path goes to its own slot, so workers never write the same memory.
+void BatchPathfinder::SolveQueries(Pathfinder& pathfinder) {
+    auto& paths = *paths_;
+    while (true) {
+        const auto first = next_query_.fetch_add(kQueriesPerClaim, std::memory_order_relaxed);
+        if (first >= queries_.size()) return;
+
+        const auto last = std::min(first + kQueriesPerClaim, queries_.size());
+        for (auto i = first; i < last; ++i) {
+            pathfinder.FindPath(queries_[i].first, queries_[i].second, paths[i]);
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#include "pathfinder/BitboardFlood.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+static const std::size_t kBitsPerWord = 64;
+// Words a sparse level looks at per frontier word: itself and its four neighbours.
+static const std::size_t kCandidatesPerWord = 5;
+// A sparse candidate costs a few swept words, so wide frontiers sweep their rows instead.
+static const std::size_t kDenseSweepRatio = 4;
+// The dense sweep reads up to this many words past its range.
+static const std::size_t kSweepOverrun = 4;
+}
+
+BitboardFlood::BitboardFlood(const GameMap& map)
+    : map_(map)
+    , is_built_(false)
+    , version_(0)
+    , columns_count_(0)
+    , rows_count_(0)
+    , words_per_row_(0)
+    , first_word_(0)
+    , word_mark_(0)
+    , levels_count_(0)
+    , dense_levels_count_(0) {}
+
+void BitboardFlood::Flood(Vec2<int> col_row_target, std::vector<std::uint32_t>& distances) {
+    Sync();
+    distances.assign(map_.GetCellsCount(), kUnreachable);
+    levels_count_ = 0;
+    dense_levels_count_ = 0;
+    if (!map_.AreColRowWalkable(col_row_target)) return;
+
+    std::fill(visited_.begin(), visited_.end(), 0);
+    const auto col = static_cast<std::size_t>(col_row_target.x);
+    const auto row = static_cast<std::size_t>(col_row_target.y);
+    const auto word = first_word_ + row * words_per_row_ + col / kBitsPerWord;
+    const auto bit = std::uint64_t{1} << (col % kBitsPerWord);
+    frontier_[word] = bit;
+    visited_[word] = bit;
+    frontier_words_.assign(1, static_cast<std::uint32_t>(word));
+    distances[map_.FromColRowToIndex(col_row_target)] = 0;
+
+    for (std::uint32_t level = 1; !frontier_words_.empty(); ++level) {
+        next_frontier_words_.clear();
+        const auto [min_word, max_word] = std::minmax_element(frontier_words_.begin(), frontier_words_.end());
+        const auto map_last_word = first_word_ + rows_count_ * words_per_row_;
+        const auto first_word = std::max<std::size_t>(*min_word - words_per_row_ - 1, first_word_);
+        const auto last_word = std::min<std::size_t>(*max_word + words_per_row_ + 2, map_last_word);
+        if (frontier_words_.size() * kCandidatesPerWord * kDenseSweepRatio >= last_word - first_word) {
+            ExpandDense(first_word, last_word, level, distances);
+            ++dense_levels_count_;
+        } else {
+            ExpandSparse(level, distances);
+        }
+        ++levels_count_;
+
+        for (const auto frontier_word : frontier_words_) { frontier_[frontier_word] = 0; }
+        frontier_.swap(next_frontier_);
+        frontier_words_.swap(next_frontier_words_);
+    }
+}
+
+std::size_t BitboardFlood::GetLevelsCount() const {
+    return levels_count_;
+}
+
+std::size_t BitboardFlood::GetDenseLevelsCount() const {
+    return dense_levels_count_;
+}
+
+void BitboardFlood::Sync() {
+    if (is_built_ && version_ == map_.GetVersion() && columns_count_ == map_.GetColumnsCount() &&
+        rows_count_ == map_.GetRowsCount()) {
+        return;
+    }
+
+    Build();
+}
+
+void BitboardFlood::Build() {
+    is_built_ = true;
+    version_ = map_.GetVersion();
+    columns_count_ = map_.GetColumnsCount();
+    rows_count_ = map_.GetRowsCount();
+    words_per_row_ = columns_count_ / kBitsPerWord + 1;
+    first_word_ = words_per_row_ + 1;
+
+    const auto words_count = first_word_ + (rows_count_ + 1) * words_per_row_ + kSweepOverrun + 1;
+    walkable_.assign(words_count, 0);
+    visited_.assign(words_count, 0);
+    frontier_.assign(words_count, 0);
+    next_frontier_.assign(words_count, 0);
+    word_marks_.assign(words_count, 0);
+    word_mark_ = 0;
+
+    for (std::size_t row = 0; row < rows_count_; ++row) {
+        for (std::size_t col = 0; col < columns_count_; ++col) {
+            if (!map_.IsWalkable(row * columns_count_ + col)) continue;
+
+            walkable_[first_word_ + row * words_per_row_ + col / kBitsPerWord] |= std::uint64_t{1} << (col % kBitsPerWord);
+        }
+    }
+}
+
+// Only the words next to frontier words can gain cells.
+void BitboardFlood::ExpandSparse(std::uint32_t level, std::vector<std::uint32_t>& distances) {
+    if (++word_mark_ == 0) {
+        std::fill(word_marks_.begin(), word_marks_.end(), 0);
+        word_mark_ = 1;
+    }
+
+    const auto map_last_word = first_word_ + rows_count_ * words_per_row_;
+    for (const auto frontier_word : frontier_words_) {
+        const std::size_t candidates[kCandidatesPerWord] {
+            frontier_word, frontier_word - 1, frontier_word + 1,
+            frontier_word - words_per_row_, frontier_word + words_per_row_};
+        for (const auto word : candidates) {
+            if (word < first_word_ || word >= map_last_word || word_marks_[word] == word_mark_) continue;
+
+            word_marks_[word] = word_mark_;
+            const auto bits = ExpandWord(word) & walkable_[word] & ~visited_[word];
+            if (bits != 0) AddNextWord(word, bits, level, distances);
+        }
+    }
+}
+
+// Every word between first_word and last_word, which must be map rows. The
+// AVX2 sweep may go a few words past the last one.
+void BitboardFlood::ExpandDense(
+    std::size_t first_word,
+    std::size_t last_word,
+    std::uint32_t level,
+    std::vector<std::uint32_t>& distances) {
+    std::size_t word = first_word;
+#if defined(__AVX2__)
+    const auto* frontier = frontier_.data();
+    const auto stride = words_per_row_;
+    for (; word < last_word; word += 4) {
+        const auto load = [](const std::uint64_t* words) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+        };
+        const auto current = load(frontier + word);
+        const auto reached = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(current, _mm256_slli_epi64(current, 1)),
+                _mm256_or_si256(_mm256_srli_epi64(load(frontier + word - 1), 63), _mm256_srli_epi64(current, 1))),
+            _mm256_or_si256(
+                _mm256_slli_epi64(load(frontier + word + 1), 63),
+                _mm256_or_si256(load(frontier + word - stride), load(frontier + word + stride))));
+        const auto bits = _mm256_andnot_si256(load(&visited_[word]), _mm256_and_si256(reached, load(&walkable_[word])));
+        if (_mm256_testz_si256(bits, bits)) continue;
+
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), bits);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            if (lanes[lane] != 0) AddNextWord(word + lane, lanes[lane], level, distances);
+        }
+    }
+#endif
+    for (; word < last_word; ++word) {
+        const auto bits = ExpandWord(word) & walkable_[word] & ~visited_[word];
+        if (bits != 0) AddNextWord(word, bits, level, distances);
+    }
+}
+
+// Cells of the word next to a frontier cell: east and west through the shifts,
+// carrying the edge bits of the neighbour words, north and south from the rows
+// above and below.
+std::uint64_t BitboardFlood::ExpandWord(std::size_t word) const {
+    const auto current = frontier_[word];
+    return current | (current << 1) | (frontier_[word - 1] >> 63) | (current >> 1) | (frontier_[word + 1] << 63) |
+           frontier_[word - words_per_row_] | frontier_[word + words_per_row_];
+}
+
+void BitboardFlood::AddNextWord(
+    std::size_t word,
+    std::uint64_t bits,
+    std::uint32_t level,
+    std::vector<std::uint32_t>& distances) {
+    next_frontier_[word] = bits;
+    visited_[word] |= bits;
+    next_frontier_words_.push_back(static_cast<std::uint32_t>(word));
+
+    const auto offset = word - first_word_;
+    const auto first_cell = (offset / words_per_row_) * columns_count_ + (offset % words_per_row_) * kBitsPerWord;
+    while (bits != 0) {
+        distances[first_cell + static_cast<std::size_t>(std::countr_zero(bits))] = level;
+        bits &= bits - 1;
+    }
+}
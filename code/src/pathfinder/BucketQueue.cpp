@@ -0,0 +1,124 @@
+#include "pathfinder/BucketQueue.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+static const std::size_t kWordBits = 64;
+}
+
+void BucketQueue::Reserve(std::size_t capacity) {
+    const auto words_count = (capacity + kWordBits - 1) / kWordBits;
+    const auto summary_count = (words_count + kWordBits - 1) / kWordBits;
+    for (auto& bucket : buckets_) {
+        bucket.words.assign(words_count, 0);
+        bucket.summary.assign(summary_count, 0);
+        bucket.size = 0;
+        bucket.first_summary_word = std::numeric_limits<std::size_t>::max();
+    }
+    priorities_.assign(capacity, 0);
+    size_ = 0;
+}
+
+void BucketQueue::Clear() {
+    // Only the words still holding ids are touched, so clearing after a search costs
+    // as much as the nodes that were left open.
+    for (auto& bucket : buckets_) {
+        if (bucket.size == 0) continue;
+
+        for (std::size_t s = bucket.first_summary_word; s < bucket.summary.size(); ++s) {
+            auto summary_word = bucket.summary[s];
+            while (summary_word) {
+                const auto bit = static_cast<std::size_t>(std::countr_zero(summary_word));
+                bucket.words[s * kWordBits + bit] = 0;
+                summary_word &= summary_word - 1;
+            }
+            bucket.summary[s] = 0;
+        }
+        bucket.size = 0;
+        bucket.first_summary_word = std::numeric_limits<std::size_t>::max();
+    }
+    size_ = 0;
+}
+
+bool BucketQueue::Empty() const {
+    return (size_ == 0);
+}
+
+std::size_t BucketQueue::Size() const {
+    return size_;
+}
+
+bool BucketQueue::Contains(std::uint32_t id) const {
+    const auto& bucket = GetBucket(priorities_[id]);
+    return (bucket.words[id / kWordBits] >> (id % kWordBits)) & 1;
+}
+
+void BucketQueue::Push(std::uint32_t id, std::uint32_t priority) {
+    if (size_ == 0 || priority < lowest_priority_) {
+        lowest_priority_ = priority;
+    }
+
+    priorities_[id] = priority;
+    Insert(GetBucket(priority), id);
+    ++size_;
+}
+
+void BucketQueue::DecreaseKey(std::uint32_t id, std::uint32_t priority) {
+    Erase(GetBucket(priorities_[id]), id);
+    priorities_[id] = priority;
+    Insert(GetBucket(priority), id);
+    lowest_priority_ = std::min(lowest_priority_, priority);
+}
+
+std::uint32_t BucketQueue::Pop() {
+    for (std::uint32_t offset = 0; offset < kBucketsCount; ++offset) {
+        auto& bucket = GetBucket(lowest_priority_ + offset);
+        if (bucket.size == 0) continue;
+
+        lowest_priority_ += offset;
+        --size_;
+        return PopLowestId(bucket);
+    }
+
+    return std::numeric_limits<std::uint32_t>::max();
+}
+
+BucketQueue::Bucket& BucketQueue::GetBucket(std::uint32_t priority) {
+    return buckets_[priority % kBucketsCount];
+}
+
+const BucketQueue::Bucket& BucketQueue::GetBucket(std::uint32_t priority) const {
+    return buckets_[priority % kBucketsCount];
+}
+
+void BucketQueue::Insert(Bucket& bucket, std::uint32_t id) {
+    const auto word_index = id / kWordBits;
+    const auto summary_index = word_index / kWordBits;
+    bucket.words[word_index] |= (std::uint64_t{1} << (id % kWordBits));
+    bucket.summary[summary_index] |= (std::uint64_t{1} << (word_index % kWordBits));
+    bucket.first_summary_word = std::min(bucket.first_summary_word, summary_index);
+    ++bucket.size;
+}
+
+void BucketQueue::Erase(Bucket& bucket, std::uint32_t id) {
+    const auto word_index = id / kWordBits;
+    auto& word = bucket.words[word_index];
+    word &= ~(std::uint64_t{1} << (id % kWordBits));
+    if (word == 0) {
+        bucket.summary[word_index / kWordBits] &= ~(std::uint64_t{1} << (word_index % kWordBits));
+    }
+    --bucket.size;
+}
+
+std::uint32_t BucketQueue::PopLowestId(Bucket& bucket) {
+    auto s = bucket.first_summary_word;
+    while (bucket.summary[s] == 0) ++s;
+    bucket.first_summary_word = s;
+
+    const auto word_index = s * kWordBits + static_cast<std::size_t>(std::countr_zero(bucket.summary[s]));
+    const auto bit = static_cast<std::size_t>(std::countr_zero(bucket.words[word_index]));
+    const auto id = static_cast<std::uint32_t>(word_index * kWordBits + bit);
+    Erase(bucket, id);
+    return id;
+}
@@ -0,0 +1,445 @@
+#include "pathfinder/CompressedPathDatabase.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <SDL2/SDL.h>
+
+namespace {
+static const std::uint32_t kMagic = 0x42445043; // "CPDB"
+static const std::uint32_t kFormatVersion = 1;
+// Sources a worker claims at once, so the shared counter isn't hit per row.
+static const std::uint32_t kSourcesPerClaim = 16;
+static const std::uint32_t kMoveBits = 2;
+static const std::uint32_t kMoveMask = 0x3;
+static const std::uint8_t kAnyMove = 0xF;
+static const std::array<Vec2<int>, 4> kMoveOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+
+// Per worker BFS state, indexed by position.
+struct RowEncoder {
+    std::vector<std::uint32_t> distances;
+    std::vector<std::uint8_t> moves;
+    std::vector<std::uint32_t> queue;
+};
+
+// BFS from the source over the position graph. Every target gets the set of first
+// moves starting one of its shortest paths: the union of the sets of the cells it
+// can be reached from at the previous distance. The runs are then cut greedily, a
+// run going on while its targets still share a move.
+void EncodeRow(std::uint32_t source, std::span<const std::uint32_t> neighbours, RowEncoder& encoder, std::vector<std::uint32_t>& row) {
+    static constexpr std::uint32_t kUnreached = 0xFFFFFFFF;
+    auto& distances = encoder.distances;
+    auto& moves = encoder.moves;
+    auto& queue = encoder.queue;
+    std::fill(distances.begin(), distances.end(), kUnreached);
+    std::fill(moves.begin(), moves.end(), std::uint8_t{0});
+
+    queue.clear();
+    queue.push_back(source);
+    distances[source] = 0;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const auto position = queue[head];
+        for (std::uint32_t move = 0; move < 4; ++move) {
+            const auto neighbour = neighbours[position * 4 + move];
+            if (neighbour == kUnreached) continue;
+
+            const auto first_moves = (position == source) ? static_cast<std::uint8_t>(1 << move) : moves[position];
+            if (distances[neighbour] == kUnreached) {
+                distances[neighbour] = distances[position] + 1;
+                moves[neighbour] = first_moves;
+                queue.push_back(neighbour);
+            } else if (distances[neighbour] == distances[position] + 1) {
+                moves[neighbour] |= first_moves;
+            }
+        }
+    }
+
+    row.clear();
+    std::uint32_t run_start = 0;
+    std::uint8_t run_moves = kAnyMove;
+    for (std::uint32_t target = 0; target < moves.size(); ++target) {
+        const std::uint8_t target_moves = moves[target] ? moves[target] : kAnyMove;
+        if (run_moves & target_moves) {
+            run_moves &= target_moves;
+            continue;
+        }
+
+        row.push_back(run_start << kMoveBits | std::countr_zero(run_moves));
+        run_start = target;
+        run_moves = target_moves;
+    }
+    row.push_back(run_start << kMoveBits | std::countr_zero(run_moves));
+}
+}
+
+CompressedPathDatabase::CompressedPathDatabase(const GameMap& map, IPathfinder& fallback)
+    : map_(map)
+    , fallback_(fallback)
+    , is_valid_(false)
+    , build_seconds_(0.0)
+    , version_(0)
+    , map_hash_(0)
+    , columns_count_(0)
+    , rows_count_(0) {}
+
+void CompressedPathDatabase::Build(std::size_t workers_count) {
+    const auto start = std::chrono::steady_clock::now();
+    Clear();
+
+    std::vector<std::uint32_t> components;
+    auto cell_positions = NumberCells(components);
+    const auto positions_count = components.size();
+    if (positions_count >= kMaxPositionsCount) {
+        SDL_Log("CompressedPathDatabase disabled: %zu walkable cells is above the limit of %u.", positions_count, kMaxPositionsCount);
+        return;
+    }
+
+    // The map is only read here, so the workers walk this graph instead of it.
+    std::vector<std::uint32_t> neighbours(positions_count * 4, kNoPosition);
+    for (std::size_t i = 0; i < cell_positions.size(); ++i) {
+        if (cell_positions[i] == kNoPosition) continue;
+
+        const auto [row, col] = map_.FromIndexToColRow(i);
+        for (std::size_t move = 0; move < kMoveOffsets.size(); ++move) {
+            const auto col_row = Vec2<int>{col, row} + kMoveOffsets[move];
+            if (!map_.AreColRowWalkable(col_row)) continue;
+
+            neighbours[cell_positions[i] * 4 + move] = cell_positions[map_.FromColRowToIndex(col_row)];
+        }
+    }
+
+    if (workers_count == 0) {
+        workers_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::vector<std::uint32_t>> rows(positions_count);
+    std::atomic<std::uint32_t> next_source {0};
+    const auto encode_rows = [&]() {
+        RowEncoder encoder;
+        encoder.distances.resize(positions_count);
+        encoder.moves.resize(positions_count);
+        encoder.queue.reserve(positions_count);
+        for (;;) {
+            const auto first = next_source.fetch_add(kSourcesPerClaim, std::memory_order_relaxed);
+            if (first >= positions_count) return;
+
+            const auto last = std::min<std::uint32_t>(first + kSourcesPerClaim, static_cast<std::uint32_t>(positions_count));
+            for (auto source = first; source < last; ++source) {
+                EncodeRow(source, neighbours, encoder, rows[source]);
+                rows[source].shrink_to_fit();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i + 1 < workers_count; ++i) {
+        threads.emplace_back(encode_rows);
+    }
+    encode_rows();
+    for (auto& thread : threads) { thread.join(); }
+
+    built_row_offsets_.reserve(positions_count + 1);
+    built_row_offsets_.push_back(0);
+    for (const auto& row : rows) {
+        built_row_offsets_.push_back(built_row_offsets_.back() + row.size());
+    }
+    built_runs_.reserve(built_row_offsets_.back());
+    for (auto& row : rows) {
+        built_runs_.insert(built_runs_.end(), row.begin(), row.end());
+        row = {};
+    }
+    built_cell_positions_ = std::move(cell_positions);
+    built_components_ = std::move(components);
+
+    row_offsets_ = built_row_offsets_;
+    cell_positions_ = built_cell_positions_;
+    components_ = built_components_;
+    runs_ = built_runs_;
+    columns_count_ = map_.GetColumnsCount();
+    rows_count_ = map_.GetRowsCount();
+    version_ = map_.GetVersion();
+    map_hash_ = HashMap();
+    is_valid_ = true;
+
+    build_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool CompressedPathDatabase::Load(const std::string& file_path) {
+    Clear();
+    if (!file_.Open(file_path)) return false;
+
+    FileHeader header;
+    bool is_loaded = (file_.GetSize() >= sizeof(header));
+    if (is_loaded) {
+        std::memcpy(&header, file_.GetData(), sizeof(header));
+        is_loaded = (header.magic == kMagic &&
+                     header.format_version == kFormatVersion &&
+                     header.columns_count == map_.GetColumnsCount() &&
+                     header.rows_count == map_.GetRowsCount() &&
+                     header.map_hash == HashMap() &&
+                     header.positions_count < kMaxPositionsCount &&
+                     header.runs_count <= file_.GetSize() / sizeof(std::uint32_t));
+    }
+
+    const std::size_t cells_count = map_.GetCellsCount();
+    const std::size_t positions_count = header.positions_count;
+    const auto runs_count = static_cast<std::size_t>(header.runs_count);
+    if (is_loaded) {
+        is_loaded = (file_.GetSize() == sizeof(header) +
+                     (positions_count + 1) * sizeof(std::uint64_t) +
+                     cells_count * sizeof(std::uint32_t) +
+                     positions_count * sizeof(std::uint32_t) +
+                     runs_count * sizeof(std::uint32_t));
+    }
+    if (!is_loaded) {
+        SDL_Log("CompressedPathDatabase: %s doesn't match the map.", file_path.c_str());
+        file_.Close();
+        return false;
+    }
+
+    // Every array starts aligned for its type: the header and the offsets are 8 bytes wide.
+    const auto* data = file_.GetData() + sizeof(header);
+    row_offsets_ = {reinterpret_cast<const std::uint64_t*>(data), positions_count + 1};
+    data += row_offsets_.size_bytes();
+    cell_positions_ = {reinterpret_cast<const std::uint32_t*>(data), cells_count};
+    data += cell_positions_.size_bytes();
+    components_ = {reinterpret_cast<const std::uint32_t*>(data), positions_count};
+    data += components_.size_bytes();
+    runs_ = {reinterpret_cast<const std::uint32_t*>(data), runs_count};
+    if (!AreTablesValid()) {
+        SDL_Log("CompressedPathDatabase: %s has tables out of range.", file_path.c_str());
+        Clear();
+        return false;
+    }
+
+    columns_count_ = header.columns_count;
+    rows_count_ = header.rows_count;
+    version_ = map_.GetVersion();
+    map_hash_ = header.map_hash;
+    is_valid_ = true;
+    return true;
+}
+
+bool CompressedPathDatabase::Save(const std::string& file_path) const {
+    if (row_offsets_.empty()) return false;
+
+    const FileHeader header {
+        kMagic,
+        kFormatVersion,
+        static_cast<std::uint32_t>(columns_count_),
+        static_cast<std::uint32_t>(rows_count_),
+        map_hash_,
+        static_cast<std::uint32_t>(components_.size()),
+        0,
+        runs_.size()};
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(row_offsets_.data()), row_offsets_.size_bytes());
+    file.write(reinterpret_cast<const char*>(cell_positions_.data()), cell_positions_.size_bytes());
+    file.write(reinterpret_cast<const char*>(components_.data()), components_.size_bytes());
+    file.write(reinterpret_cast<const char*>(runs_.data()), runs_.size_bytes());
+    if (!file) {
+        SDL_Log("CompressedPathDatabase: error writing %s.", file_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CompressedPathDatabase::LoadOrBuild(const std::string& file_path, std::size_t workers_count) {
+    if (Load(file_path)) return true;
+
+    Build(workers_count);
+    // Reloaded so the runs live in the mapped file and not on the heap.
+    return is_valid_ && Save(file_path) && Load(file_path);
+}
+
+bool CompressedPathDatabase::IsValid() {
+    Sync();
+    return is_valid_;
+}
+
+void CompressedPathDatabase::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    if (GetFirstMove(col_row_from, col_row_to) == EMove::NONE) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    const auto to_position = cell_positions_[map_.FromColRowToIndex(col_row_to)];
+    auto col_row = col_row_from;
+    path.clear();
+    path.push_back(col_row);
+    while (col_row != col_row_to) {
+        const auto move = LookUpMove(cell_positions_[map_.FromColRowToIndex(col_row)], to_position);
+        col_row += kMoveOffsets[static_cast<std::size_t>(move)];
+        path.push_back(col_row);
+        // Only a corrupt file's moves step into walls or go around in circles.
+        if (!map_.AreColRowWalkable(col_row) || path.size() > components_.size()) {
+            fallback_.FindPath(col_row_from, col_row_to, path);
+            return;
+        }
+    }
+}
+
+CompressedPathDatabase::EMove CompressedPathDatabase::GetFirstMove(Vec2<int> col_row_from, Vec2<int> col_row_to) {
+    if (!IsValid() ||
+        !map_.AreColRowInsideBoundaries(col_row_from) ||
+        !map_.AreColRowInsideBoundaries(col_row_to)) {
+        return EMove::NONE;
+    }
+
+    const auto from_position = cell_positions_[map_.FromColRowToIndex(col_row_from)];
+    const auto to_position = cell_positions_[map_.FromColRowToIndex(col_row_to)];
+    if (from_position == kNoPosition ||
+        to_position == kNoPosition ||
+        from_position == to_position ||
+        components_[from_position] != components_[to_position]) {
+        return EMove::NONE;
+    }
+
+    return LookUpMove(from_position, to_position);
+}
+
+double CompressedPathDatabase::GetBuildSeconds() const {
+    return build_seconds_;
+}
+
+std::size_t CompressedPathDatabase::GetRunsCount() const {
+    return runs_.size();
+}
+
+std::size_t CompressedPathDatabase::GetFileSize() const {
+    if (row_offsets_.empty()) return 0;
+
+    return sizeof(FileHeader) +
+           row_offsets_.size_bytes() +
+           cell_positions_.size_bytes() +
+           components_.size_bytes() +
+           runs_.size_bytes();
+}
+
+std::size_t CompressedPathDatabase::GetMemoryUsage() const {
+    return built_row_offsets_.capacity() * sizeof(std::uint64_t) +
+           built_cell_positions_.capacity() * sizeof(std::uint32_t) +
+           built_components_.capacity() * sizeof(std::uint32_t) +
+           built_runs_.capacity() * sizeof(std::uint32_t);
+}
+
+// A toggled cell may be toggled back, so the walls are hashed again rather than
+// dropping the database on the first change.
+void CompressedPathDatabase::Sync() {
+    if (row_offsets_.empty() || version_ == map_.GetVersion()) return;
+
+    version_ = map_.GetVersion();
+    is_valid_ = (map_.GetColumnsCount() == columns_count_ &&
+                 map_.GetRowsCount() == rows_count_ &&
+                 HashMap() == map_hash_);
+}
+
+void CompressedPathDatabase::Clear() {
+    is_valid_ = false;
+    build_seconds_ = 0.0;
+    row_offsets_ = {};
+    cell_positions_ = {};
+    components_ = {};
+    runs_ = {};
+    built_row_offsets_ = {};
+    built_cell_positions_ = {};
+    built_components_ = {};
+    built_runs_ = {};
+    file_.Close();
+}
+
+// FNV-1a over the dimensions and the walkability of every cell.
+std::uint64_t CompressedPathDatabase::HashMap() const {
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto add = [&hash](std::uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    add(map_.GetColumnsCount());
+    add(map_.GetRowsCount());
+    for (std::size_t i = 0; i < map_.GetCellsCount(); ++i) {
+        add(map_.IsWalkable(i));
+    }
+    return hash;
+}
+
+std::vector<std::uint32_t> CompressedPathDatabase::NumberCells(std::vector<std::uint32_t>& components) const {
+    const auto cells_count = map_.GetCellsCount();
+    std::vector<std::uint32_t> cell_positions(cells_count, kNoPosition);
+    std::vector<std::uint32_t> stack;
+    std::uint32_t position = 0;
+    std::uint32_t component = 0;
+    components.clear();
+    for (std::size_t root = 0; root < cells_count; ++root) {
+        if (!map_.IsWalkable(root) || cell_positions[root] != kNoPosition) continue;
+
+        stack.push_back(static_cast<std::uint32_t>(root));
+        while (!stack.empty()) {
+            const auto index = stack.back();
+            stack.pop_back();
+            if (cell_positions[index] != kNoPosition) continue;
+
+            cell_positions[index] = position++;
+            components.push_back(component);
+            const auto [row, col] = map_.FromIndexToColRow(index);
+            // Pushed backwards so east is visited first.
+            for (auto move = kMoveOffsets.size(); move-- > 0;) {
+                const auto col_row = Vec2<int>{col, row} + kMoveOffsets[move];
+                if (!map_.AreColRowWalkable(col_row)) continue;
+
+                const auto neighbour = map_.FromColRowToIndex(col_row);
+                if (cell_positions[neighbour] == kNoPosition) stack.push_back(static_cast<std::uint32_t>(neighbour));
+            }
+        }
+        ++component;
+    }
+    return cell_positions;
+}
+
+// What lookups assume of a mapped file before reading it unchecked: row offsets
+// inside the runs, rows starting at position 0 with increasing runs, and
+// positions on the walkable cells only.
+bool CompressedPathDatabase::AreTablesValid() const {
+    const auto positions_count = components_.size();
+    if (row_offsets_.front() != 0 || row_offsets_.back() != runs_.size()) return false;
+
+    for (std::size_t row = 0; row < positions_count; ++row) {
+        const auto first = row_offsets_[row];
+        const auto last = row_offsets_[row + 1];
+        if (last <= first || last > runs_.size() || (runs_[first] >> kMoveBits) != 0) return false;
+
+        for (auto run = first + 1; run < last; ++run) {
+            if (runs_[run] >> kMoveBits <= runs_[run - 1] >> kMoveBits ||
+                runs_[run] >> kMoveBits >= positions_count) {
+                return false;
+            }
+        }
+    }
+
+    for (std::size_t index = 0; index < cell_positions_.size(); ++index) {
+        const auto position = cell_positions_[index];
+        if ((position == kNoPosition) == map_.IsWalkable(index)) return false;
+        if (position != kNoPosition && position >= positions_count) return false;
+    }
+    return std::all_of(components_.begin(), components_.end(),
+        [positions_count](std::uint32_t component) { return component < positions_count; });
+}
+
+// The last run starting at or before the target; rows always start at position 0.
+CompressedPathDatabase::EMove CompressedPathDatabase::LookUpMove(std::uint32_t from_position, std::uint32_t to_position) const {
+    const auto* first = runs_.data() + row_offsets_[from_position];
+    const auto* last = runs_.data() + row_offsets_[from_position + 1];
+    const auto* run = std::upper_bound(first, last, to_position << kMoveBits | kMoveMask);
+    return static_cast<EMove>(*(run - 1) & kMoveMask);
+}
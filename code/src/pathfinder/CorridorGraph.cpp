@@ -0,0 +1,430 @@
+#include "pathfinder/CorridorGraph.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+// Same order as the Pathfinder neighbours: east, west, north, south. The
+// opposite of a direction is direction ^ 1.
+static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+}
+
+CorridorGraph::CorridorGraph(const GameMap& map, IPathfinder& fallback)
+    : map_(map)
+    , fallback_(fallback)
+    , junctions_count_(0)
+    , segments_count_(0)
+    , version_(0)
+    , generation_(0)
+    , expanded_nodes_count_(0) {
+    Build();
+}
+
+void CorridorGraph::Build() {
+    const auto cells_count = map_.GetCellsCount();
+    junctions_.clear();
+    segments_.clear();
+    free_junctions_.clear();
+    free_segments_.clear();
+    junctions_count_ = 0;
+    segments_count_ = 0;
+    cell_junctions_.assign(cells_count, kInvalidIndex);
+    cell_segments_.assign(cells_count, kInvalidIndex);
+    cell_offsets_.assign(cells_count, 0);
+
+    version_ = map_.GetVersion();
+    std::vector<std::uint32_t> cells(cells_count);
+    for (std::size_t i = 0; i < cells_count; ++i) {
+        cells[i] = static_cast<std::uint32_t>(i);
+        if (IsJunctionCell(cells[i])) AddJunction(cells[i]);
+    }
+    TraceMissingSegments(cells);
+}
+
+void CorridorGraph::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    if (!map_.AreColRowWalkable(col_row_from) || !map_.AreColRowWalkable(col_row_to)) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    Sync();
+    const auto from_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_from));
+    const auto to_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_to));
+    if (from_index == to_index) {
+        expanded_nodes_count_ = 0;
+        path.assign(1, col_row_from);
+        return;
+    }
+
+    if (!Search(from_index, to_index)) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    ExpandPath(from_index, to_index, path);
+}
+
+std::size_t CorridorGraph::GetJunctionsCount() const {
+    return junctions_count_;
+}
+
+std::size_t CorridorGraph::GetSegmentsCount() const {
+    return segments_count_;
+}
+
+std::size_t CorridorGraph::GetExpandedNodesCount() const {
+    return expanded_nodes_count_;
+}
+
+void CorridorGraph::Sync() {
+    if (version_ == map_.GetVersion()) return;
+
+    std::vector<std::uint32_t> changed_cells;
+    if (!map_.GetChangesSince(version_, changed_cells)) {
+        Build();
+        return;
+    }
+
+    version_ = map_.GetVersion();
+    Repair(changed_cells);
+}
+
+// Only the toggled cells and their neighbours change neighbours count, so only
+// the junctions and segments touching them are dropped and traced again.
+void CorridorGraph::Repair(const std::vector<std::uint32_t>& changed_cells) {
+    std::vector<std::uint32_t> region;
+    for (const auto cell_index : changed_cells) {
+        region.push_back(cell_index);
+        for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            const auto [row, col] = map_.FromIndexToColRow(cell_index);
+            const auto col_row = Vec2<int>{col, row} + kNeighbourOffsets[direction];
+            if (map_.AreColRowInsideBoundaries(col_row)) {
+                region.push_back(static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row)));
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> released_cells;
+    for (const auto cell_index : region) {
+        if (cell_segments_[cell_index] != kInvalidIndex) {
+            RemoveSegment(cell_segments_[cell_index], released_cells);
+        }
+        if (cell_junctions_[cell_index] != kInvalidIndex) {
+            RemoveJunction(cell_junctions_[cell_index], released_cells);
+        }
+    }
+
+    for (const auto cell_index : region) {
+        if (cell_junctions_[cell_index] == kInvalidIndex && IsJunctionCell(cell_index)) {
+            AddJunction(cell_index);
+        }
+    }
+
+    released_cells.insert(released_cells.end(), region.begin(), region.end());
+    TraceMissingSegments(released_cells);
+}
+
+void CorridorGraph::TraceMissingSegments(const std::vector<std::uint32_t>& cells) {
+    for (const auto cell_index : cells) {
+        const auto junction = cell_junctions_[cell_index];
+        if (junction == kInvalidIndex) continue;
+
+        for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            if (junctions_[junction].segments[direction] == kInvalidIndex &&
+                GetNeighbourIndex(cell_index, direction) != kInvalidIndex) {
+                TraceSegment(junction, direction);
+            }
+        }
+    }
+
+    // Whatever is left is a loop of corridor cells without any junction on it:
+    // one of its cells becomes a junction and the loop a segment back to it.
+    for (const auto cell_index : cells) {
+        if (!map_.IsWalkable(cell_index) ||
+            cell_junctions_[cell_index] != kInvalidIndex ||
+            cell_segments_[cell_index] != kInvalidIndex) {
+            continue;
+        }
+
+        const auto junction = AddJunction(cell_index);
+        for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            if (junctions_[junction].segments[direction] == kInvalidIndex &&
+                GetNeighbourIndex(cell_index, direction) != kInvalidIndex) {
+                TraceSegment(junction, direction);
+            }
+        }
+    }
+}
+
+bool CorridorGraph::IsJunctionCell(std::uint32_t cell_index) const {
+    if (!map_.IsWalkable(cell_index)) return false;
+
+    int neighbours_count = 0;
+    for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+        neighbours_count += (GetNeighbourIndex(cell_index, direction) != kInvalidIndex);
+    }
+    return neighbours_count != 2;
+}
+
+// kInvalidIndex when the move leaves the map or hits a wall.
+std::uint32_t CorridorGraph::GetNeighbourIndex(std::uint32_t cell_index, std::size_t direction) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    const auto col_row = Vec2<int>{col, row} + kNeighbourOffsets[direction];
+    if (!map_.AreColRowWalkable(col_row)) return kInvalidIndex;
+
+    return static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row));
+}
+
+std::uint32_t CorridorGraph::AddJunction(std::uint32_t cell_index) {
+    std::uint32_t junction = static_cast<std::uint32_t>(junctions_.size());
+    if (free_junctions_.empty()) {
+        junctions_.emplace_back();
+    } else {
+        junction = free_junctions_.back();
+        free_junctions_.pop_back();
+    }
+
+    junctions_[junction] = Junction{};
+    junctions_[junction].cell_index = cell_index;
+    cell_junctions_[cell_index] = junction;
+    ++junctions_count_;
+    return junction;
+}
+
+void CorridorGraph::RemoveJunction(std::uint32_t junction, std::vector<std::uint32_t>& released_cells) {
+    for (const auto segment : junctions_[junction].segments) {
+        if (segment != kInvalidIndex) RemoveSegment(segment, released_cells);
+    }
+
+    const auto cell_index = junctions_[junction].cell_index;
+    cell_junctions_[cell_index] = kInvalidIndex;
+    released_cells.push_back(cell_index);
+    junctions_[junction] = Junction{};
+    free_junctions_.push_back(junction);
+    --junctions_count_;
+}
+
+void CorridorGraph::RemoveSegment(std::uint32_t segment, std::vector<std::uint32_t>& released_cells) {
+    auto& removed = segments_[segment];
+    if (removed.from_junction == kInvalidIndex) return;
+
+    for (const auto cell_index : removed.cells) {
+        cell_segments_[cell_index] = kInvalidIndex;
+        released_cells.push_back(cell_index);
+    }
+
+    junctions_[removed.from_junction].segments[removed.from_direction] = kInvalidIndex;
+    junctions_[removed.to_junction].segments[removed.to_direction] = kInvalidIndex;
+    released_cells.push_back(junctions_[removed.from_junction].cell_index);
+    released_cells.push_back(junctions_[removed.to_junction].cell_index);
+
+    removed = Segment{};
+    free_segments_.push_back(segment);
+    --segments_count_;
+}
+
+// Walks from the junction through the corridor cells, which have exactly two
+// walkable neighbours, until it reaches a junction again.
+void CorridorGraph::TraceSegment(std::uint32_t junction, std::size_t direction) {
+    std::uint32_t segment = static_cast<std::uint32_t>(segments_.size());
+    if (free_segments_.empty()) {
+        segments_.emplace_back();
+    } else {
+        segment = free_segments_.back();
+        free_segments_.pop_back();
+    }
+    ++segments_count_;
+
+    auto& traced = segments_[segment];
+    traced.from_junction = junction;
+    traced.from_direction = static_cast<std::uint8_t>(direction);
+    junctions_[junction].segments[direction] = segment;
+
+    auto cell_index = GetNeighbourIndex(junctions_[junction].cell_index, direction);
+    while (cell_junctions_[cell_index] == kInvalidIndex) {
+        traced.cells.push_back(cell_index);
+        cell_segments_[cell_index] = segment;
+        cell_offsets_[cell_index] = static_cast<std::uint32_t>(traced.cells.size());
+
+        const auto came_from = direction ^ 1;
+        for (direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            if (direction != came_from && GetNeighbourIndex(cell_index, direction) != kInvalidIndex) break;
+        }
+        cell_index = GetNeighbourIndex(cell_index, direction);
+    }
+
+    traced.to_junction = cell_junctions_[cell_index];
+    traced.to_direction = static_cast<std::uint8_t>(direction ^ 1);
+    junctions_[traced.to_junction].segments[traced.to_direction] = segment;
+}
+
+// A* over the junctions. The goal node stands for the target cell: it's linked
+// to the target junction, or to both ends of the target segment by the distance
+// along it. The start cell seeds both ends of its segment the same way.
+bool CorridorGraph::Search(std::uint32_t from_index, std::uint32_t to_index) {
+    const auto goal = static_cast<std::uint32_t>(junctions_.size());
+    if (search_nodes_.size() != junctions_.size() + 1) {
+        search_nodes_.resize(junctions_.size() + 1);
+        open_nodes_.Reserve(search_nodes_.size());
+    }
+    open_nodes_.Clear();
+    expanded_nodes_count_ = 0;
+    if (++generation_ == 0) {
+        std::fill(search_nodes_.begin(), search_nodes_.end(), SearchNode{});
+        generation_ = 1;
+    }
+
+    const auto [to_row, to_col] = map_.FromIndexToColRow(to_index);
+    const Vec2<int> col_row_to {to_col, to_row};
+    const auto to_junction = cell_junctions_[to_index];
+    const auto to_segment = cell_segments_[to_index];
+    const auto to_offset = cell_offsets_[to_index];
+
+    const auto from_junction = cell_junctions_[from_index];
+    if (from_junction != kInvalidIndex) {
+        Relax(from_junction, kInvalidIndex, kInvalidIndex, 0, Heuristic(from_index, col_row_to));
+    } else {
+        const auto from_segment = cell_segments_[from_index];
+        const auto from_offset = cell_offsets_[from_index];
+        const auto& segment = segments_[from_segment];
+        Relax(segment.from_junction, kInvalidIndex, from_segment, from_offset,
+            Heuristic(junctions_[segment.from_junction].cell_index, col_row_to));
+        Relax(segment.to_junction, kInvalidIndex, from_segment, segment.GetWeight() - from_offset,
+            Heuristic(junctions_[segment.to_junction].cell_index, col_row_to));
+        if (to_segment == from_segment) {
+            const auto distance = std::max(from_offset, to_offset) - std::min(from_offset, to_offset);
+            Relax(goal, kInvalidIndex, from_segment, distance, 0);
+        }
+    }
+
+    while (!open_nodes_.Empty()) {
+        const auto node = open_nodes_.Pop();
+        ++expanded_nodes_count_;
+        if (node == goal) return true;
+
+        const auto g = search_nodes_[node].g;
+        if (to_junction == node) {
+            Relax(goal, node, kInvalidIndex, g, 0);
+        } else if (to_junction == kInvalidIndex) {
+            const auto& segment = segments_[to_segment];
+            if (segment.from_junction == node) Relax(goal, node, to_segment, g + to_offset, 0);
+            if (segment.to_junction == node) Relax(goal, node, to_segment, g + segment.GetWeight() - to_offset, 0);
+        }
+
+        for (const auto segment_index : junctions_[node].segments) {
+            if (segment_index == kInvalidIndex) continue;
+
+            const auto& segment = segments_[segment_index];
+            const auto next = (segment.from_junction == node) ? segment.to_junction : segment.from_junction;
+            if (next == node) continue;
+
+            Relax(next, node, segment_index, g + segment.GetWeight(),
+                Heuristic(junctions_[next].cell_index, col_row_to));
+        }
+    }
+
+    return false;
+}
+
+// Every move costs at least its Manhattan length, so the heuristic stays
+// consistent and closed junctions never reopen.
+bool CorridorGraph::Relax(std::uint32_t node, std::uint32_t parent, std::uint32_t parent_segment, std::uint32_t g, std::uint32_t h) {
+    auto& search_node = search_nodes_[node];
+    const bool is_visited = (search_node.generation == generation_);
+    const bool is_open = (is_visited && open_nodes_.Contains(node));
+    if (is_visited && (!is_open || g >= search_node.g)) return false;
+
+    search_node.generation = generation_;
+    search_node.parent = parent;
+    search_node.parent_segment = parent_segment;
+    search_node.g = g;
+
+    const auto key = (static_cast<std::uint64_t>(g + h) << 32) | node;
+    if (is_open) {
+        open_nodes_.DecreaseKey(node, key);
+    } else {
+        open_nodes_.Push(node, key);
+    }
+    return true;
+}
+
+int CorridorGraph::Heuristic(std::uint32_t cell_index, Vec2<int> col_row_to) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    return std::abs(row - col_row_to.y) + std::abs(col - col_row_to.x);
+}
+
+// Offset 0 is the from_junction cell and the segment weight the to_junction one.
+std::uint32_t CorridorGraph::GetSegmentCell(const Segment& segment, std::uint32_t offset) const {
+    if (offset == 0) return junctions_[segment.from_junction].cell_index;
+    if (offset == segment.GetWeight()) return junctions_[segment.to_junction].cell_index;
+    return segment.cells[offset - 1];
+}
+
+void CorridorGraph::AppendSegmentCells(Path& path, std::uint32_t segment, std::uint32_t from_offset, std::uint32_t to_offset) const {
+    const int step = (from_offset <= to_offset) ? 1 : -1;
+    for (auto offset = from_offset;; offset += step) {
+        const auto [row, col] = map_.FromIndexToColRow(GetSegmentCell(segments_[segment], offset));
+        path.emplace_back(col, row);
+        if (offset == to_offset) break;
+    }
+}
+
+void CorridorGraph::ExpandPath(std::uint32_t from_index, std::uint32_t to_index, Path& path) {
+    const auto& goal_node = search_nodes_[junctions_.size()];
+    path.clear();
+    path.reserve(goal_node.g + 1);
+
+    // Straight along the segment both cells are on.
+    if (goal_node.parent == kInvalidIndex) {
+        AppendSegmentCells(path, goal_node.parent_segment, cell_offsets_[from_index], cell_offsets_[to_index]);
+        return;
+    }
+
+    auto& junctions = path_junctions_;
+    junctions.clear();
+    for (auto junction = goal_node.parent; junction != kInvalidIndex; junction = search_nodes_[junction].parent) {
+        junctions.push_back(junction);
+    }
+
+    // From the start cell to the first junction.
+    const auto first_junction = junctions.back();
+    const auto& first_node = search_nodes_[first_junction];
+    if (first_node.parent_segment == kInvalidIndex) {
+        const auto [row, col] = map_.FromIndexToColRow(from_index);
+        path.emplace_back(col, row);
+    } else {
+        const auto& segment = segments_[first_node.parent_segment];
+        const auto from_offset = cell_offsets_[from_index];
+        const bool is_towards_from_junction = (segment.from_junction == first_junction && first_node.g == from_offset);
+        AppendSegmentCells(path, first_node.parent_segment, from_offset, is_towards_from_junction ? 0 : segment.GetWeight());
+    }
+
+    // Junction to junction, each one already in the path.
+    for (std::size_t i = junctions.size() - 1; i > 0; --i) {
+        const auto segment_index = search_nodes_[junctions[i - 1]].parent_segment;
+        const auto& segment = segments_[segment_index];
+        if (segment.from_junction == junctions[i]) {
+            AppendSegmentCells(path, segment_index, 1, segment.GetWeight());
+        } else {
+            AppendSegmentCells(path, segment_index, segment.GetWeight() - 1, 0);
+        }
+    }
+
+    // From the last junction to the target cell.
+    if (goal_node.parent_segment != kInvalidIndex) {
+        const auto last_junction = junctions.front();
+        const auto& segment = segments_[goal_node.parent_segment];
+        const auto to_offset = cell_offsets_[to_index];
+        const bool is_from_from_junction = (
+            segment.from_junction == last_junction &&
+            goal_node.g == search_nodes_[last_junction].g + to_offset);
+        if (is_from_from_junction) {
+            AppendSegmentCells(path, goal_node.parent_segment, 1, to_offset);
+        } else {
+            AppendSegmentCells(path, goal_node.parent_segment, segment.GetWeight() - 1, to_offset);
+        }
+    }
+}
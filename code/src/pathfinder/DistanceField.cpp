@@ -0,0 +1,129 @@
+#include "pathfinder/DistanceField.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+// Same order as the Pathfinder neighbours: east, west, north, south.
+static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+// Mazes keep their frontiers a few words wide, and without the AVX2 sweeps the
+// bitboards only break even with the queue on them.
+#if defined(__AVX2__)
+static const bool kIsBitboardAuto = true;
+#else
+static const bool kIsBitboardAuto = false;
+#endif
+}
+
+DistanceField::DistanceField(const GameMap& map, EFlood flood)
+    : map_(map)
+    , flood_(flood)
+    , bitboard_flood_(map)
+    , version_(0)
+    , is_flooded_(false)
+    , floods_count_(0) {}
+
+void DistanceField::Update(Vec2<int> col_row_target) {
+    const bool is_up_to_date = (
+        is_flooded_ &&
+        col_row_target == col_row_target_ &&
+        version_ == map_.GetVersion() &&
+        distances_.size() == map_.GetCellsCount());
+    if (is_up_to_date) return;
+
+    col_row_target_ = col_row_target;
+    version_ = map_.GetVersion();
+    Flood();
+}
+
+void DistanceField::Flood() {
+    is_flooded_ = true;
+    ++floods_count_;
+
+    const bool is_using_bitboard = (flood_ == EFlood::BITBOARD ||
+                                    (flood_ == EFlood::AUTO && kIsBitboardAuto && map_.GetCellsCount() >= kBitboardMinCellsCount));
+    if (is_using_bitboard) {
+        bitboard_flood_.Flood(col_row_target_, distances_);
+    } else {
+        FloodScalar();
+    }
+}
+
+void DistanceField::FloodScalar() {
+    const auto cells_count = map_.GetCellsCount();
+    const int cols_count = static_cast<int>(map_.GetColumnsCount());
+    const int rows_count = static_cast<int>(map_.GetRowsCount());
+    distances_.assign(cells_count, kUnreachable);
+    queue_.clear();
+    queue_.reserve(cells_count);
+
+    if (!map_.AreColRowWalkable(col_row_target_)) return;
+
+    const auto target_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_target_));
+    distances_[target_index] = 0;
+    queue_.push_back(target_index);
+    for (std::size_t head = 0; head < queue_.size(); ++head) {
+        const auto index = queue_[head];
+        const int col = static_cast<int>(index) % cols_count;
+        const int row = static_cast<int>(index) / cols_count;
+        const auto distance = distances_[index] + 1;
+        for (const auto& offset : kNeighbourOffsets) {
+            const int n_col = col + offset.x;
+            const int n_row = row + offset.y;
+            if (n_col < 0 || n_col >= cols_count || n_row < 0 || n_row >= rows_count) continue;
+
+            const auto n_index = static_cast<std::uint32_t>(n_row * cols_count + n_col);
+            if (distances_[n_index] != kUnreachable || !map_.AreColRowWalkable(Vec2<int>{n_col, n_row})) continue;
+
+            distances_[n_index] = distance;
+            queue_.push_back(n_index);
+        }
+    }
+}
+
+bool DistanceField::IsReachable(Vec2<int> col_row) const {
+    return (GetDistance(col_row) != kUnreachable);
+}
+
+std::uint32_t DistanceField::GetDistance(Vec2<int> col_row) const {
+    if (!is_flooded_ || !map_.AreColRowInsideBoundaries(col_row)) return kUnreachable;
+
+    return distances_[map_.FromColRowToIndex(col_row)];
+}
+
+Vec2<int> DistanceField::GetNextStep(Vec2<int> col_row) const {
+    const auto distance = GetDistance(col_row);
+    if (distance == 0 || distance == kUnreachable) return col_row;
+
+    for (const auto& offset : kNeighbourOffsets) {
+        const auto neighbour = col_row + offset;
+        if (GetDistance(neighbour) == distance - 1) return neighbour;
+    }
+
+    return col_row;
+}
+
+void DistanceField::FindPath(Vec2<int> col_row_from, Pathfinder::Path& path) const {
+    path.assign(1, col_row_from);
+    const auto next_step = GetNextStep(col_row_from);
+    if (next_step != col_row_from) path.push_back(next_step);
+}
+
+Vec2<int> DistanceField::GetTarget() const {
+    return col_row_target_;
+}
+
+std::size_t DistanceField::GetFloodsCount() const {
+    return floods_count_;
+}
+
+void DistanceField::SetFlood(EFlood flood) {
+    flood_ = flood;
+}
+
+DistanceField::EFlood DistanceField::GetFlood() const {
+    return flood_;
+}
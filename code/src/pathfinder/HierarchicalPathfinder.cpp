@@ -0,0 +1,491 @@
+#include "pathfinder/HierarchicalPathfinder.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace {
+// Same order as the Pathfinder neighbours: east, west, north, south.
+static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+// Border runs this long get an entrance at each end instead of one in the middle.
+static const std::size_t kLongEntranceLength = 6;
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(const GameMap& map, IPathfinder& fallback, std::size_t cluster_size)
+    : map_(map)
+    , fallback_(fallback)
+    , cluster_size_(std::max<std::size_t>(cluster_size, 2))
+    , refined_segments_count_(kRefinedSegmentsCount)
+    , cluster_columns_count_(0)
+    , cluster_rows_count_(0)
+    , nodes_count_(0)
+    , version_(0)
+    , rebuilt_clusters_count_(0)
+    , local_generation_(0)
+    , generation_(0)
+    , expanded_nodes_count_(0) {}
+
+void HierarchicalPathfinder::Build() {
+    const auto cells_count = map_.GetCellsCount();
+    cluster_columns_count_ = (map_.GetColumnsCount() + cluster_size_ - 1) / cluster_size_;
+    cluster_rows_count_ = (map_.GetRowsCount() + cluster_size_ - 1) / cluster_size_;
+    clusters_.assign(cluster_columns_count_ * cluster_rows_count_, Cluster{});
+    nodes_.clear();
+    free_nodes_.clear();
+    nodes_count_ = 0;
+    cell_nodes_.assign(cells_count, kInvalidIndex);
+
+    const auto local_cells_count = cluster_size_ * cluster_size_;
+    local_generations_.assign(local_cells_count, 0);
+    local_distances_.assign(local_cells_count, 0);
+    local_parents_.assign(local_cells_count, kInvalidIndex);
+    local_generation_ = 0;
+
+    version_ = map_.GetVersion();
+
+    std::vector<std::uint32_t> clusters(clusters_.size());
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+        clusters[i] = static_cast<std::uint32_t>(i);
+    }
+    Rebuild(clusters);
+}
+
+void HierarchicalPathfinder::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    if (!map_.AreColRowWalkable(col_row_from) || !map_.AreColRowWalkable(col_row_to)) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    Sync();
+    expanded_nodes_count_ = 0;
+    const auto from_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_from));
+    const auto to_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_to));
+    path.assign(1, col_row_from);
+    if (from_index == to_index) return;
+
+    const auto from_cluster = GetCluster(from_index);
+    if (from_cluster == GetCluster(to_index)) {
+        if (AppendLocalPath(path, from_cluster, from_index, to_index)) return;
+    }
+
+    if (!Search(from_index, to_index)) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    RefinePath(from_index, to_index, path);
+}
+
+void HierarchicalPathfinder::SetRefinedSegmentsCount(std::size_t refined_segments_count) {
+    refined_segments_count_ = refined_segments_count;
+}
+
+std::size_t HierarchicalPathfinder::GetRefinedSegmentsCount() const {
+    return refined_segments_count_;
+}
+
+std::size_t HierarchicalPathfinder::GetClustersCount() const {
+    return clusters_.size();
+}
+
+std::size_t HierarchicalPathfinder::GetNodesCount() const {
+    return nodes_count_;
+}
+
+std::size_t HierarchicalPathfinder::GetExpandedNodesCount() const {
+    return expanded_nodes_count_;
+}
+
+std::size_t HierarchicalPathfinder::GetRebuiltClustersCount() const {
+    return rebuilt_clusters_count_;
+}
+
+void HierarchicalPathfinder::Sync() {
+    if (version_ == map_.GetVersion() && !clusters_.empty()) return;
+
+    std::vector<std::uint32_t> changed_cells;
+    if (clusters_.empty() || !map_.GetChangesSince(version_, changed_cells)) {
+        Build();
+        return;
+    }
+
+    // A cell on a cluster's border changes the entrances of the cluster across too.
+    version_ = map_.GetVersion();
+    std::vector<std::uint32_t> dirty_clusters;
+    for (const auto cell_index : changed_cells) {
+        const auto cluster = GetCluster(cell_index);
+        dirty_clusters.push_back(cluster);
+
+        const auto [row, col] = map_.FromIndexToColRow(cell_index);
+        const auto local_col = static_cast<std::size_t>(col) % cluster_size_;
+        const auto local_row = static_cast<std::size_t>(row) % cluster_size_;
+        const auto cluster_col = cluster % cluster_columns_count_;
+        const auto cluster_row = cluster / cluster_columns_count_;
+        if (local_col == 0 && cluster_col > 0) dirty_clusters.push_back(cluster - 1);
+        if (local_col + 1 == cluster_size_ && cluster_col + 1 < cluster_columns_count_) dirty_clusters.push_back(cluster + 1);
+        if (local_row == 0 && cluster_row > 0) {
+            dirty_clusters.push_back(static_cast<std::uint32_t>(cluster - cluster_columns_count_));
+        }
+        if (local_row + 1 == cluster_size_ && cluster_row + 1 < cluster_rows_count_) {
+            dirty_clusters.push_back(static_cast<std::uint32_t>(cluster + cluster_columns_count_));
+        }
+    }
+    std::sort(dirty_clusters.begin(), dirty_clusters.end());
+    dirty_clusters.erase(std::unique(dirty_clusters.begin(), dirty_clusters.end()), dirty_clusters.end());
+    Rebuild(dirty_clusters);
+}
+
+// The dirty clusters' borders get new entrances, which changes the nodes of the
+// clusters on both sides. A cluster keeps its east and south entrances, so the
+// west and north borders are found again through the neighbours owning them.
+// Nodes that survive keep their ids, so the edges of the clusters further away
+// stay valid.
+void HierarchicalPathfinder::Rebuild(const std::vector<std::uint32_t>& dirty_clusters) {
+    std::vector<std::uint32_t> affected_clusters;
+    for (const auto cluster : dirty_clusters) {
+        FindEntrances(cluster);
+
+        const auto cluster_col = cluster % cluster_columns_count_;
+        const auto cluster_row = cluster / cluster_columns_count_;
+        if (cluster_col > 0) FindEntrances(cluster - 1);
+        if (cluster_row > 0) FindEntrances(static_cast<std::uint32_t>(cluster - cluster_columns_count_));
+
+        affected_clusters.push_back(cluster);
+        if (cluster_col > 0) affected_clusters.push_back(cluster - 1);
+        if (cluster_col + 1 < cluster_columns_count_) affected_clusters.push_back(cluster + 1);
+        if (cluster_row > 0) affected_clusters.push_back(static_cast<std::uint32_t>(cluster - cluster_columns_count_));
+        if (cluster_row + 1 < cluster_rows_count_) affected_clusters.push_back(static_cast<std::uint32_t>(cluster + cluster_columns_count_));
+    }
+    std::sort(affected_clusters.begin(), affected_clusters.end());
+    affected_clusters.erase(std::unique(affected_clusters.begin(), affected_clusters.end()), affected_clusters.end());
+
+    for (const auto cluster : affected_clusters) { RebuildNodes(cluster); }
+    for (const auto cluster : affected_clusters) { RebuildEdges(cluster); }
+    rebuilt_clusters_count_ = affected_clusters.size();
+}
+
+void HierarchicalPathfinder::FindEntrances(std::uint32_t cluster) {
+    auto& entrances = clusters_[cluster];
+    entrances.east_entrances.clear();
+    entrances.south_entrances.clear();
+
+    const auto columns_count = static_cast<std::uint32_t>(map_.GetColumnsCount());
+    const auto [first, size] = GetClusterBounds(cluster);
+    const auto last_col = static_cast<std::uint32_t>(first.x + size.x - 1);
+    const auto last_row = static_cast<std::uint32_t>(first.y + size.y - 1);
+    if (cluster % cluster_columns_count_ + 1 < cluster_columns_count_) {
+        AddBorderEntrances(entrances.east_entrances,
+            static_cast<std::uint32_t>(first.y) * columns_count + last_col, columns_count, 1, static_cast<std::size_t>(size.y));
+    }
+    if (cluster / cluster_columns_count_ + 1 < cluster_rows_count_) {
+        AddBorderEntrances(entrances.south_entrances,
+            last_row * columns_count + static_cast<std::uint32_t>(first.x), 1, columns_count, static_cast<std::size_t>(size.x));
+    }
+}
+
+// Walks the border cells from first_cell, step apart, each facing the cell
+// across further on.
+void HierarchicalPathfinder::AddBorderEntrances(
+    std::vector<Entrance>& entrances,
+    std::uint32_t first_cell,
+    std::uint32_t step,
+    std::uint32_t across,
+    std::size_t length) {
+    const auto add_run = [&](std::size_t run_begin, std::size_t run_end) {
+        const auto run_length = run_end - run_begin;
+        if (run_length == 0) return;
+
+        std::array<std::size_t, 2> positions {run_begin + run_length / 2, run_end};
+        if (run_length >= kLongEntranceLength) positions = {run_begin, run_end - 1};
+        for (const auto position : positions) {
+            if (position == run_end) continue;
+
+            const auto cell = first_cell + static_cast<std::uint32_t>(position) * step;
+            entrances.push_back({cell, cell + across});
+        }
+    };
+
+    std::size_t run_begin = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        const auto cell = first_cell + static_cast<std::uint32_t>(i) * step;
+        if (map_.IsWalkable(cell) && map_.IsWalkable(cell + across)) continue;
+
+        add_run(run_begin, i);
+        run_begin = i + 1;
+    }
+    add_run(run_begin, length);
+}
+
+void HierarchicalPathfinder::RebuildNodes(std::uint32_t cluster) {
+    std::vector<std::uint32_t> cells;
+    ForEachBorderEntrance(cluster, [&cells](std::uint32_t cell, std::uint32_t) { cells.push_back(cell); });
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    auto& nodes = clusters_[cluster].nodes;
+    for (const auto node : nodes) {
+        const auto cell = nodes_[node].cell_index;
+        if (std::binary_search(cells.begin(), cells.end(), cell)) continue;
+
+        cell_nodes_[cell] = kInvalidIndex;
+        nodes_[node] = Node{};
+        free_nodes_.push_back(node);
+        --nodes_count_;
+    }
+
+    nodes.clear();
+    for (const auto cell : cells) {
+        if (cell_nodes_[cell] == kInvalidIndex) {
+            std::uint32_t node;
+            if (!free_nodes_.empty()) {
+                node = free_nodes_.back();
+                free_nodes_.pop_back();
+            } else {
+                node = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.emplace_back();
+            }
+            nodes_[node].cell_index = cell;
+            cell_nodes_[cell] = node;
+            ++nodes_count_;
+        }
+        nodes.push_back(cell_nodes_[cell]);
+    }
+}
+
+void HierarchicalPathfinder::RebuildEdges(std::uint32_t cluster) {
+    const auto& nodes = clusters_[cluster].nodes;
+    for (const auto node : nodes) { nodes_[node].edges.clear(); }
+
+    ForEachBorderEntrance(cluster, [this](std::uint32_t cell, std::uint32_t facing_cell) {
+        nodes_[cell_nodes_[cell]].edges.push_back({cell_nodes_[facing_cell], 1});
+    });
+
+    for (const auto node : nodes) {
+        FloodCluster(cluster, nodes_[node].cell_index);
+        for (const auto other_node : nodes) {
+            if (other_node == node) continue;
+
+            const auto distance = GetLocalDistance(nodes_[other_node].cell_index);
+            if (distance != kInvalidIndex) nodes_[node].edges.push_back({other_node, distance});
+        }
+    }
+}
+
+// Calls visitor(cell, facing_cell) for the entrances on the four borders, cell
+// being the one inside the cluster.
+template <typename Visitor>
+void HierarchicalPathfinder::ForEachBorderEntrance(std::uint32_t cluster, Visitor&& visitor) const {
+    const auto& own = clusters_[cluster];
+    for (const auto& entrance : own.east_entrances) { visitor(entrance.inner_cell, entrance.outer_cell); }
+    for (const auto& entrance : own.south_entrances) { visitor(entrance.inner_cell, entrance.outer_cell); }
+
+    if (cluster % cluster_columns_count_ > 0) {
+        for (const auto& entrance : clusters_[cluster - 1].east_entrances) {
+            visitor(entrance.outer_cell, entrance.inner_cell);
+        }
+    }
+    if (cluster >= cluster_columns_count_) {
+        for (const auto& entrance : clusters_[cluster - cluster_columns_count_].south_entrances) {
+            visitor(entrance.outer_cell, entrance.inner_cell);
+        }
+    }
+}
+
+std::uint32_t HierarchicalPathfinder::GetCluster(std::uint32_t cell_index) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    return static_cast<std::uint32_t>(
+        (static_cast<std::size_t>(row) / cluster_size_) * cluster_columns_count_ + static_cast<std::size_t>(col) / cluster_size_);
+}
+
+std::pair<Vec2<int>, Vec2<int>> HierarchicalPathfinder::GetClusterBounds(std::uint32_t cluster) const {
+    const int cluster_size = static_cast<int>(cluster_size_);
+    const Vec2<int> first {
+        static_cast<int>(cluster % cluster_columns_count_) * cluster_size,
+        static_cast<int>(cluster / cluster_columns_count_) * cluster_size};
+    const Vec2<int> size {
+        std::min(cluster_size, static_cast<int>(map_.GetColumnsCount()) - first.x),
+        std::min(cluster_size, static_cast<int>(map_.GetRowsCount()) - first.y)};
+    return {first, size};
+}
+
+void HierarchicalPathfinder::FloodCluster(std::uint32_t cluster, std::uint32_t from_cell) {
+    if (++local_generation_ == 0) {
+        std::fill(local_generations_.begin(), local_generations_.end(), 0);
+        local_generation_ = 1;
+    }
+
+    if (!map_.IsWalkable(from_cell)) return;
+
+    const auto [first, size] = GetClusterBounds(cluster);
+    const auto from_local = GetLocalIndex(from_cell);
+    local_generations_[from_local] = local_generation_;
+    local_distances_[from_local] = 0;
+    local_parents_[from_local] = kInvalidIndex;
+    local_queue_.assign(1, from_cell);
+    for (std::size_t head = 0; head < local_queue_.size(); ++head) {
+        const auto cell = local_queue_[head];
+        const auto [row, col] = map_.FromIndexToColRow(cell);
+        const auto distance = local_distances_[GetLocalIndex(cell)] + 1;
+        for (const auto& offset : kNeighbourOffsets) {
+            const Vec2<int> col_row {col + offset.x, row + offset.y};
+            if (col_row.x < first.x || col_row.x >= first.x + size.x ||
+                col_row.y < first.y || col_row.y >= first.y + size.y) {
+                continue;
+            }
+
+            const auto neighbour = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row));
+            const auto local = GetLocalIndex(neighbour);
+            if (local_generations_[local] == local_generation_ || !map_.IsWalkable(neighbour)) continue;
+
+            local_generations_[local] = local_generation_;
+            local_distances_[local] = distance;
+            local_parents_[local] = cell;
+            local_queue_.push_back(neighbour);
+        }
+    }
+}
+
+std::uint32_t HierarchicalPathfinder::GetLocalIndex(std::uint32_t cell_index) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    const auto local_col = static_cast<std::size_t>(col) % cluster_size_;
+    const auto local_row = static_cast<std::size_t>(row) % cluster_size_;
+    return static_cast<std::uint32_t>(local_row * cluster_size_ + local_col);
+}
+
+// kInvalidIndex when the last flood of the cluster didn't reach the cell.
+std::uint32_t HierarchicalPathfinder::GetLocalDistance(std::uint32_t cell_index) const {
+    const auto local = GetLocalIndex(cell_index);
+    return (local_generations_[local] == local_generation_) ? local_distances_[local] : kInvalidIndex;
+}
+
+// A cell that is a node links to itself only, any other to the nodes of its
+// cluster it reaches.
+void HierarchicalPathfinder::LinkCell(std::uint32_t cell_index, std::vector<Link>& links) {
+    links.clear();
+    if (cell_nodes_[cell_index] != kInvalidIndex) {
+        links.push_back({cell_nodes_[cell_index], 0});
+        return;
+    }
+
+    const auto cluster = GetCluster(cell_index);
+    FloodCluster(cluster, cell_index);
+    for (const auto node : clusters_[cluster].nodes) {
+        const auto distance = GetLocalDistance(nodes_[node].cell_index);
+        if (distance != kInvalidIndex) links.push_back({node, distance});
+    }
+}
+
+// Appends the cells after from_cell up to to_cell. False when to_cell can't be
+// reached inside the cluster.
+bool HierarchicalPathfinder::AppendLocalPath(Path& path, std::uint32_t cluster, std::uint32_t from_cell, std::uint32_t to_cell) {
+    FloodCluster(cluster, from_cell);
+    const auto distance = GetLocalDistance(to_cell);
+    if (distance == kInvalidIndex) return false;
+
+    // Filled from the back, the distance says where the target goes.
+    auto position = path.size() + distance;
+    path.resize(position);
+    for (auto cell = to_cell; cell != from_cell; cell = local_parents_[GetLocalIndex(cell)]) {
+        const auto [row, col] = map_.FromIndexToColRow(cell);
+        path[--position] = Vec2<int>{col, row};
+    }
+    return true;
+}
+
+bool HierarchicalPathfinder::Search(std::uint32_t from_index, std::uint32_t to_index) {
+    const auto goal = static_cast<std::uint32_t>(nodes_.size());
+    if (search_nodes_.size() != nodes_.size() + 1) {
+        search_nodes_.resize(nodes_.size() + 1);
+        open_nodes_.Reserve(search_nodes_.size());
+    }
+    open_nodes_.Clear();
+    if (++generation_ == 0) {
+        std::fill(search_nodes_.begin(), search_nodes_.end(), SearchNode{});
+        generation_ = 1;
+    }
+
+    LinkCell(from_index, start_links_);
+    LinkCell(to_index, goal_links_);
+    const auto goal_cluster = GetCluster(to_index);
+    for (const auto& link : start_links_) {
+        Relax(link.node, kInvalidIndex, link.distance, Heuristic(nodes_[link.node].cell_index, to_index));
+    }
+
+    while (!open_nodes_.Empty()) {
+        const auto node = open_nodes_.Pop();
+        ++expanded_nodes_count_;
+        if (node == goal) return true;
+
+        const auto g = search_nodes_[node].g;
+        const auto cell_index = nodes_[node].cell_index;
+        if (GetCluster(cell_index) == goal_cluster) {
+            for (const auto& link : goal_links_) {
+                if (link.node == node) Relax(goal, node, g + link.distance, 0);
+            }
+        }
+
+        for (const auto& edge : nodes_[node].edges) {
+            Relax(edge.to_node, node, g + edge.weight, Heuristic(nodes_[edge.to_node].cell_index, to_index));
+        }
+    }
+
+    return false;
+}
+
+void HierarchicalPathfinder::Relax(std::uint32_t node, std::uint32_t parent, std::uint32_t g, std::uint32_t h) {
+    auto& search_node = search_nodes_[node];
+    const bool is_visited = (search_node.generation == generation_);
+    const bool is_open = (is_visited && open_nodes_.Contains(node));
+    if (is_visited && (!is_open || g >= search_node.g)) return;
+
+    search_node.generation = generation_;
+    search_node.parent = parent;
+    search_node.g = g;
+
+    const auto key = (static_cast<std::uint64_t>(g + h) << 32) | node;
+    if (is_open) {
+        open_nodes_.DecreaseKey(node, key);
+    } else {
+        open_nodes_.Push(node, key);
+    }
+}
+
+std::uint32_t HierarchicalPathfinder::Heuristic(std::uint32_t cell_index, std::uint32_t to_index) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    const auto [to_row, to_col] = map_.FromIndexToColRow(to_index);
+    return static_cast<std::uint32_t>(std::abs(row - to_row) + std::abs(col - to_col));
+}
+
+// Turns the abstract path into cells: steps across entrances are single moves,
+// steps inside a cluster are searched again there.
+// The path already holds the start cell.
+void HierarchicalPathfinder::RefinePath(std::uint32_t from_index, std::uint32_t to_index, Path& path) {
+    abstract_path_.clear();
+    abstract_path_.push_back(to_index);
+    const auto goal = static_cast<std::uint32_t>(nodes_.size());
+    for (auto node = search_nodes_[goal].parent; node != kInvalidIndex; node = search_nodes_[node].parent) {
+        abstract_path_.push_back(nodes_[node].cell_index);
+    }
+    abstract_path_.push_back(from_index);
+    std::reverse(abstract_path_.begin(), abstract_path_.end());
+
+    std::size_t refined_segments_count = 0;
+    for (std::size_t i = 1; i < abstract_path_.size(); ++i) {
+        const auto from_cell = abstract_path_[i - 1];
+        const auto to_cell = abstract_path_[i];
+        if (from_cell == to_cell) continue;
+
+        const auto cluster = GetCluster(from_cell);
+        if (cluster != GetCluster(to_cell)) {
+            const auto [row, col] = map_.FromIndexToColRow(to_cell);
+            path.emplace_back(col, row);
+        } else {
+            AppendLocalPath(path, cluster, from_cell, to_cell);
+        }
+
+        if (++refined_segments_count == refined_segments_count_) break;
+    }
+}
@@ -0,0 +1,264 @@
+#include "pathfinder/IncrementalPlanner.hpp"
+
+#include "GameMap.hpp"
+#include "utils/Renderer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace {
+// Same order as the Pathfinder neighbours: east, west, north, south.
+static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+
+static const SDL_Color kClosedCellColor {96, 32, 32, 255};
+static const SDL_Color kOpenCellColor {32, 96, 96, 255};
+static const SDL_Color kStartCellColor {0, 0, 255, 255};
+static const SDL_Color kGoalCellColor {0, 255, 0, 255};
+}
+
+IncrementalPlanner::IncrementalPlanner(const GameMap& map, IPathfinder& fallback)
+    : map_(map)
+    , fallback_(fallback)
+    , is_initialized_(false)
+    , version_(0)
+    , generation_(0)
+    , start_index_(0)
+    , goal_index_(0)
+    , expanded_nodes_count_(0)
+    , total_expanded_nodes_count_(0)
+    , reused_nodes_count_(0)
+    , open_nodes_peak_count_(0) {}
+
+void IncrementalPlanner::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    expanded_nodes_count_ = 0;
+    reused_nodes_count_ = 0;
+    open_nodes_peak_count_ = 0;
+    if (!map_.AreColRowWalkable(col_row_from) || !map_.AreColRowWalkable(col_row_to)) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    const auto start_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_from));
+    const auto goal_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_to));
+    const bool is_start_reusable = (
+        is_initialized_ &&
+        version_ == map_.GetVersion() &&
+        nodes_.size() == map_.GetCellsCount() &&
+        IsClosed(start_index));
+    if (is_start_reusable && start_index == start_index_ && goal_index == goal_index_) {
+        ReconstructPath(path);
+        return;
+    }
+
+    goal_index_ = goal_index;
+    if (!is_start_reusable) {
+        Restart(start_index);
+    } else {
+        Rebase(start_index);
+    }
+
+    const bool did_find_goal = Search();
+    total_expanded_nodes_count_ += expanded_nodes_count_;
+    if (!did_find_goal) {
+        // The tree now covers everything reachable, but it's no use to the fallback.
+        is_initialized_ = false;
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    ReconstructPath(path);
+}
+
+void IncrementalPlanner::Reset() {
+    is_initialized_ = false;
+}
+
+std::size_t IncrementalPlanner::GetExpandedNodesCount() const {
+    return expanded_nodes_count_;
+}
+
+std::size_t IncrementalPlanner::GetTotalExpandedNodesCount() const {
+    return total_expanded_nodes_count_;
+}
+
+std::size_t IncrementalPlanner::GetReusedNodesCount() const {
+    return reused_nodes_count_;
+}
+
+std::size_t IncrementalPlanner::GetOpenNodesPeakCount() const {
+    return open_nodes_peak_count_;
+}
+
+void IncrementalPlanner::Render(Renderer& renderer) const {
+    if (!is_initialized_) return;
+
+    const auto cell_size = map_.GetCellSizeFloat();
+    const auto render_cell = [&](std::uint32_t index, const SDL_Color& color) {
+        const auto [row, col] = map_.FromIndexToColRow(index);
+        const auto position = map_.FromColRowToCoords(Vec2<int>{col, row});
+        renderer.SetRenderingColor(color);
+        renderer.RenderRectFilled({position.x, position.y, cell_size, cell_size});
+    };
+
+    for (const auto index : closed_cells_) {
+        if (IsClosed(index)) render_cell(index, kClosedCellColor);
+    }
+    for (std::size_t i = 0; i < open_nodes_.Size(); ++i) {
+        render_cell(open_nodes_.GetId(i), kOpenCellColor);
+    }
+    render_cell(start_index_, kStartCellColor);
+    render_cell(goal_index_, kGoalCellColor);
+}
+
+void IncrementalPlanner::Restart(std::uint32_t start_index) {
+    const auto cells_count = map_.GetCellsCount();
+    if (nodes_.size() != cells_count) {
+        nodes_.assign(cells_count, SearchNode{});
+        open_nodes_.Reserve(cells_count);
+        generation_ = 0;
+    }
+    NextGeneration();
+
+    version_ = map_.GetVersion();
+    is_initialized_ = true;
+    start_index_ = start_index;
+    closed_cells_.clear();
+    open_nodes_.Clear();
+    Relax(start_index_, kInvalidIndex, 0);
+}
+
+// Keeps the subtree under the new start, which holds exact distances from the
+// old start minus the distance to the new one, and makes the cells next to it
+// the open list again, keyed towards the current goal. With the same start the
+// whole tree is kept and only the keys change.
+//
+// Every cell next to a kept one was reached by the previous search, so the new
+// open list comes from the old open cells and the dropped closed ones alone.
+void IncrementalPlanner::Rebase(std::uint32_t start_index) {
+    const auto offset = nodes_[start_index].g;
+    fringe_candidates_.clear();
+    for (std::size_t i = 0; i < open_nodes_.Size(); ++i) {
+        fringe_candidates_.push_back(open_nodes_.GetId(i));
+    }
+    if (!NextGeneration()) {
+        Restart(start_index);
+        return;
+    }
+
+    std::size_t kept_count = 0;
+    for (const auto index : closed_cells_) {
+        auto& node = nodes_[index];
+        const bool is_kept = (index == start_index ||
+                              (node.parent != kInvalidIndex && IsVisited(node.parent)));
+        if (!is_kept) {
+            fringe_candidates_.push_back(index);
+            continue;
+        }
+
+        node.generation = generation_;
+        node.g -= offset;
+        if (index == start_index) node.parent = kInvalidIndex;
+        closed_cells_[kept_count++] = index;
+    }
+    closed_cells_.resize(kept_count);
+    reused_nodes_count_ = kept_count;
+    start_index_ = start_index;
+
+    open_nodes_.Clear();
+    for (const auto index : fringe_candidates_) {
+        for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            const auto neighbour = GetNeighbourIndex(index, direction);
+            if (neighbour != kInvalidIndex && IsClosed(neighbour)) {
+                Relax(index, neighbour, nodes_[neighbour].g + 1);
+            }
+        }
+    }
+}
+
+// Plain A* from whatever open list and closed cells there are, until the goal
+// gets closed. The goal may be closed already.
+bool IncrementalPlanner::Search() {
+    while (!IsClosed(goal_index_)) {
+        if (open_nodes_.Empty()) return false;
+
+        const auto index = open_nodes_.Pop();
+        auto& node = nodes_[index];
+        node.is_closed = true;
+        closed_cells_.push_back(index);
+        ++expanded_nodes_count_;
+
+        const auto g = node.g + 1;
+        for (std::size_t direction = 0; direction < kNeighbourOffsets.size(); ++direction) {
+            const auto neighbour = GetNeighbourIndex(index, direction);
+            if (neighbour != kInvalidIndex) Relax(neighbour, index, g);
+        }
+    }
+
+    return true;
+}
+
+void IncrementalPlanner::Relax(std::uint32_t index, std::uint32_t parent, std::uint32_t g) {
+    auto& node = nodes_[index];
+    const bool is_visited = IsVisited(index);
+    if (is_visited && (node.is_closed || g >= node.g)) return;
+
+    node.generation = generation_;
+    node.parent = parent;
+    node.g = g;
+    node.is_closed = false;
+
+    const auto key = (static_cast<std::uint64_t>(g + Heuristic(index)) << 32) | index;
+    if (is_visited) {
+        open_nodes_.DecreaseKey(index, key);
+    } else {
+        open_nodes_.Push(index, key);
+#if defined(PACMAN_PATHFINDER_STATS)
+        open_nodes_peak_count_ = std::max(open_nodes_peak_count_, open_nodes_.Size());
+#endif
+    }
+}
+
+bool IncrementalPlanner::IsVisited(std::uint32_t index) const {
+    return (nodes_[index].generation == generation_);
+}
+
+bool IncrementalPlanner::IsClosed(std::uint32_t index) const {
+    return (IsVisited(index) && nodes_[index].is_closed);
+}
+
+// Returns false when the generation wraps around and every node had to be reset.
+bool IncrementalPlanner::NextGeneration() {
+    if (++generation_ != 0) return true;
+
+    std::fill(nodes_.begin(), nodes_.end(), SearchNode{});
+    generation_ = 1;
+    closed_cells_.clear();
+    return false;
+}
+
+std::uint32_t IncrementalPlanner::Heuristic(std::uint32_t index) const {
+    const auto [row, col] = map_.FromIndexToColRow(index);
+    const auto [goal_row, goal_col] = map_.FromIndexToColRow(goal_index_);
+    return static_cast<std::uint32_t>(std::abs(row - goal_row) + std::abs(col - goal_col));
+}
+
+// kInvalidIndex when the move leaves the map or hits a wall.
+std::uint32_t IncrementalPlanner::GetNeighbourIndex(std::uint32_t index, std::size_t direction) const {
+    const auto [row, col] = map_.FromIndexToColRow(index);
+    const auto col_row = Vec2<int>{col, row} + kNeighbourOffsets[direction];
+    if (!map_.AreColRowWalkable(col_row)) return kInvalidIndex;
+
+    return static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row));
+}
+
+// Written back to front in place, the goal's g being the path length.
+void IncrementalPlanner::ReconstructPath(Path& path) const {
+    path.resize(static_cast<std::size_t>(nodes_[goal_index_].g) + 1);
+    auto position = path.size();
+    for (auto index = goal_index_; index != kInvalidIndex; index = nodes_[index].parent) {
+        const auto [row, col] = map_.FromIndexToColRow(index);
+        path[--position] = Vec2<int>{col, row};
+    }
+}
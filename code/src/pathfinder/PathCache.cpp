@@ -0,0 +1,150 @@
+#include "pathfinder/PathCache.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+
+PathCache::PathCache(const GameMap& map, IPathfinder& solver, std::size_t capacity)
+    : map_(map)
+    , solver_(solver)
+    , capacity_(0)
+    , version_(map.GetVersion())
+    , head_(kInvalidIndex)
+    , tail_(kInvalidIndex)
+    , hits_count_(0)
+    , misses_count_(0)
+    , evictions_count_(0) {
+    SetCapacity(capacity);
+}
+
+void PathCache::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    if (Lookup(col_row_from, col_row_to, path)) return;
+
+    solver_.FindPath(col_row_from, col_row_to, path);
+    Insert(col_row_from, col_row_to, path);
+}
+
+bool PathCache::Lookup(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    Sync();
+    std::uint64_t key = 0;
+    if (capacity_ == 0 || !GetKey(col_row_from, col_row_to, key)) return false;
+
+    const auto it = slots_.find(key);
+    if (it == slots_.end()) {
+        ++misses_count_;
+        return false;
+    }
+
+    ++hits_count_;
+    Unlink(it->second);
+    PushFront(it->second);
+    const auto& cached_path = entries_[it->second].path;
+    path.assign(cached_path.begin(), cached_path.end());
+    return true;
+}
+
+// A full cache reuses its least recently used entry, moving its map node over
+// to the new key instead of allocating one.
+void PathCache::Insert(Vec2<int> col_row_from, Vec2<int> col_row_to, const Path& path) {
+    Sync();
+    std::uint64_t key = 0;
+    if (capacity_ == 0 || !GetKey(col_row_from, col_row_to, key)) return;
+
+    std::uint32_t entry = kInvalidIndex;
+    if (const auto it = slots_.find(key); it != slots_.end()) {
+        entry = it->second;
+        Unlink(entry);
+    } else if (slots_.size() < capacity_) {
+        entry = static_cast<std::uint32_t>(slots_.size());
+        slots_.emplace(key, entry);
+    } else {
+        entry = tail_;
+        Unlink(entry);
+        auto node = slots_.extract(entries_[entry].key);
+        node.key() = key;
+        slots_.insert(std::move(node));
+        ++evictions_count_;
+    }
+
+    entries_[entry].key = key;
+    entries_[entry].path.assign(path.begin(), path.end());
+    PushFront(entry);
+}
+
+// Entries keep their path storage for the next ones.
+void PathCache::Clear() {
+    slots_.clear();
+    head_ = kInvalidIndex;
+    tail_ = kInvalidIndex;
+    version_ = map_.GetVersion();
+}
+
+void PathCache::SetCapacity(std::size_t capacity) {
+    capacity_ = std::min<std::size_t>(capacity, kInvalidIndex);
+    entries_.resize(capacity_);
+    slots_.reserve(capacity_);
+    Clear();
+}
+
+std::size_t PathCache::GetCapacity() const {
+    return capacity_;
+}
+
+std::size_t PathCache::GetSize() const {
+    return slots_.size();
+}
+
+std::size_t PathCache::GetHitsCount() const {
+    return hits_count_;
+}
+
+std::size_t PathCache::GetMissesCount() const {
+    return misses_count_;
+}
+
+std::size_t PathCache::GetEvictionsCount() const {
+    return evictions_count_;
+}
+
+void PathCache::ResetCounters() {
+    hits_count_ = 0;
+    misses_count_ = 0;
+    evictions_count_ = 0;
+}
+
+void PathCache::Sync() {
+    if (version_ != map_.GetVersion()) Clear();
+}
+
+// Cells outside the map go straight to the solver.
+bool PathCache::GetKey(Vec2<int> col_row_from, Vec2<int> col_row_to, std::uint64_t& key) const {
+    if (!map_.AreColRowInsideBoundaries(col_row_from) || !map_.AreColRowInsideBoundaries(col_row_to)) return false;
+
+    key = (static_cast<std::uint64_t>(map_.FromColRowToIndex(col_row_from)) << 32) |
+          static_cast<std::uint64_t>(map_.FromColRowToIndex(col_row_to));
+    return true;
+}
+
+void PathCache::Unlink(std::uint32_t entry) {
+    auto& unlinked = entries_[entry];
+    if (unlinked.previous != kInvalidIndex) {
+        entries_[unlinked.previous].next = unlinked.next;
+    } else {
+        head_ = unlinked.next;
+    }
+    if (unlinked.next != kInvalidIndex) {
+        entries_[unlinked.next].previous = unlinked.previous;
+    } else {
+        tail_ = unlinked.previous;
+    }
+    unlinked.previous = kInvalidIndex;
+    unlinked.next = kInvalidIndex;
+}
+
+void PathCache::PushFront(std::uint32_t entry) {
+    entries_[entry].previous = kInvalidIndex;
+    entries_[entry].next = head_;
+    if (head_ != kInvalidIndex) entries_[head_].previous = entry;
+    head_ = entry;
+    if (tail_ == kInvalidIndex) tail_ = entry;
+}
@@ -0,0 +1,239 @@
+#include "pathfinder/PathTable.hpp"
+
+#include "GameMap.hpp"
+#include "MapAsset.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include <SDL2/SDL.h>
+
+namespace {
+static const std::array<Vec2<int>, 4> kHopOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+}
+
+// The asset the rows were built against, null when the map had changed since.
+struct PathTable::Rows {
+    std::shared_ptr<const MapAsset> asset;
+    std::vector<EHop> next_hops;
+    std::vector<std::uint16_t> distances;
+};
+
+PathTable::PathTable(const GameMap& map, IPathfinder& fallback, std::size_t max_cells_count, std::shared_ptr<const Rows> rows)
+    : map_(map)
+    , fallback_(fallback)
+    , max_cells_count_(std::min<std::size_t>(max_cells_count, kUnreachable))
+    , is_enabled_(false)
+    , cells_count_(0)
+    , owned_rows_(nullptr)
+    , next_hops_(nullptr)
+    , distances_(nullptr)
+    , dirty_rows_count_(0)
+    , version_(0) {
+    if (!AdoptRows(std::move(rows))) Build();
+}
+
+void PathTable::Build() {
+    cells_count_ = map_.GetCellsCount();
+    is_enabled_ = (cells_count_ <= max_cells_count_);
+    if (!is_enabled_) {
+        rows_.reset();
+        owned_rows_ = nullptr;
+        next_hops_ = nullptr;
+        distances_ = nullptr;
+        dirty_rows_ = {};
+        changed_cells_ = {};
+        SDL_Log("PathTable disabled: %zu cells is above the limit of %zu.", cells_count_, max_cells_count_);
+        return;
+    }
+
+    auto rows = std::make_shared<Rows>();
+    rows->asset = (map_.GetVersion() == map_.GetLoadedVersion()) ? map_.GetAsset() : nullptr;
+    rows->next_hops.assign(cells_count_ * cells_count_, EHop::NONE);
+    rows->distances.assign(cells_count_ * cells_count_, kUnreachable);
+    owned_rows_ = rows.get();
+    next_hops_ = rows->next_hops.data();
+    distances_ = rows->distances.data();
+    rows_ = std::move(rows);
+    dirty_rows_.assign(cells_count_, 0);
+    dirty_rows_count_ = 0;
+    queue_.reserve(cells_count_);
+
+    version_ = map_.GetVersion();
+    for (std::size_t i = 0; i < cells_count_; ++i) {
+        BuildRow(i);
+    }
+}
+
+bool PathTable::IsEnabled() const {
+    return is_enabled_;
+}
+
+void PathTable::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
+    if (GetDistance(col_row_from, col_row_to) == kUnreachable) {
+        fallback_.FindPath(col_row_from, col_row_to, path);
+        return;
+    }
+
+    // Every row on the way is needed, so they're all made valid while walking.
+    const auto to_index = map_.FromColRowToIndex(col_row_to);
+    auto index = map_.FromColRowToIndex(col_row_from);
+    auto col_row = col_row_from;
+
+    path.clear();
+    path.reserve(distances_[index * cells_count_ + to_index] + 1);
+    path.push_back(col_row);
+    while (index != to_index) {
+        EnsureRow(index);
+        const auto hop = next_hops_[index * cells_count_ + to_index];
+        index = GetNeighbourIndex(index, hop);
+        col_row += kHopOffsets[static_cast<std::size_t>(hop)];
+        path.push_back(col_row);
+    }
+}
+
+std::uint16_t PathTable::GetDistance(Vec2<int> col_row_from, Vec2<int> col_row_to) {
+    if (!is_enabled_ ||
+        !map_.AreColRowInsideBoundaries(col_row_from) ||
+        !map_.AreColRowInsideBoundaries(col_row_to)) {
+        return kUnreachable;
+    }
+
+    Sync();
+    const auto from_index = map_.FromColRowToIndex(col_row_from);
+    EnsureRow(from_index);
+    return distances_[from_index * cells_count_ + map_.FromColRowToIndex(col_row_to)];
+}
+
+std::shared_ptr<const PathTable::Rows> PathTable::ShareRows() {
+    if (!is_enabled_ || !rows_->asset || version_ != map_.GetLoadedVersion()) return nullptr;
+
+    owned_rows_ = nullptr;
+    return rows_;
+}
+
+std::size_t PathTable::GetMemoryUsage() const {
+    const auto rows_memory_usage = owned_rows_ ?
+        owned_rows_->next_hops.capacity() * sizeof(EHop) + owned_rows_->distances.capacity() * sizeof(std::uint16_t) : 0;
+    return rows_memory_usage +
+           dirty_rows_.capacity() +
+           changed_cells_.capacity() * sizeof(std::uint32_t) +
+           queue_.capacity() * sizeof(std::uint32_t);
+}
+
+std::size_t PathTable::GetDirtyRowsCount() const {
+    return dirty_rows_count_;
+}
+
+bool PathTable::AdoptRows(std::shared_ptr<const Rows> rows) {
+    cells_count_ = map_.GetCellsCount();
+    is_enabled_ = (cells_count_ <= max_cells_count_);
+    if (!is_enabled_ || !rows || !rows->asset || rows->asset != map_.GetAsset()) return false;
+
+    rows_ = std::move(rows);
+    owned_rows_ = nullptr;
+    next_hops_ = rows_->next_hops.data();
+    distances_ = rows_->distances.data();
+    dirty_rows_.assign(cells_count_, 0);
+    dirty_rows_count_ = 0;
+    queue_.reserve(cells_count_);
+    version_ = map_.GetLoadedVersion();
+    return true;
+}
+
+PathTable::Rows& PathTable::GetOwnedRows() {
+    if (!owned_rows_) {
+        auto rows = std::make_shared<Rows>(*rows_);
+        rows->asset.reset();
+        owned_rows_ = rows.get();
+        next_hops_ = rows->next_hops.data();
+        distances_ = rows->distances.data();
+        rows_ = std::move(rows);
+    }
+    return *owned_rows_;
+}
+
+void PathTable::Sync() {
+    if (version_ == map_.GetVersion()) return;
+
+    if (!map_.GetChangesSince(version_, changed_cells_)) {
+        Build();
+        return;
+    }
+
+    version_ = map_.GetVersion();
+    for (const auto cell_index : changed_cells_) {
+        InvalidateCell(cell_index);
+    }
+}
+
+void PathTable::InvalidateCell(std::size_t cell_index) {
+    // A row can only change if its source reached the cell (it's now a wall) or
+    // one of the cell's neighbours (it's now walkable). Dirty rows stay dirty.
+    MarkRowDirty(cell_index);
+    for (std::size_t row = 0; row < cells_count_; ++row) {
+        if (dirty_rows_[row]) continue;
+
+        const auto* distances = &distances_[row * cells_count_];
+        bool is_affected = (distances[cell_index] != kUnreachable);
+        for (std::size_t hop = 0; hop < kHopOffsets.size() && !is_affected; ++hop) {
+            const auto neighbour = GetNeighbourIndex(cell_index, static_cast<EHop>(hop));
+            is_affected = (neighbour < cells_count_ && distances[neighbour] != kUnreachable);
+        }
+
+        if (is_affected) {
+            MarkRowDirty(row);
+        }
+    }
+}
+
+void PathTable::MarkRowDirty(std::size_t row_index) {
+    if (dirty_rows_[row_index]) return;
+
+    dirty_rows_[row_index] = 1;
+    ++dirty_rows_count_;
+}
+
+void PathTable::EnsureRow(std::size_t row_index) {
+    if (!dirty_rows_[row_index]) return;
+
+    BuildRow(row_index);
+    dirty_rows_[row_index] = 0;
+    --dirty_rows_count_;
+}
+
+// BFS from the row's source. Cells next to the source get the move towards them,
+// every other cell inherits the first move of the cell it was reached from.
+void PathTable::BuildRow(std::size_t row_index) {
+    auto& rows = GetOwnedRows();
+    auto* next_hops = &rows.next_hops[row_index * cells_count_];
+    auto* distances = &rows.distances[row_index * cells_count_];
+    std::fill(next_hops, next_hops + cells_count_, EHop::NONE);
+    std::fill(distances, distances + cells_count_, kUnreachable);
+    if (!map_.IsWalkable(row_index)) return;
+
+    queue_.clear();
+    queue_.push_back(static_cast<std::uint32_t>(row_index));
+    distances[row_index] = 0;
+    for (std::size_t head = 0; head < queue_.size(); ++head) {
+        const auto index = queue_[head];
+        for (std::size_t hop = 0; hop < kHopOffsets.size(); ++hop) {
+            const auto neighbour = GetNeighbourIndex(index, static_cast<EHop>(hop));
+            if (neighbour >= cells_count_ || distances[neighbour] != kUnreachable) continue;
+
+            distances[neighbour] = distances[index] + 1;
+            next_hops[neighbour] = (index == row_index) ? static_cast<EHop>(hop) : next_hops[index];
+            queue_.push_back(static_cast<std::uint32_t>(neighbour));
+        }
+    }
+}
+
+// Returns cells_count_ when the move leaves the map or hits a wall.
+std::size_t PathTable::GetNeighbourIndex(std::size_t cell_index, EHop hop) const {
+    const auto [row, col] = map_.FromIndexToColRow(cell_index);
+    const auto col_row = Vec2<int>{col, row} + kHopOffsets[static_cast<std::size_t>(hop)];
+    if (!map_.AreColRowWalkable(col_row)) return cells_count_;
+
+    return map_.FromColRowToIndex(col_row);
+}
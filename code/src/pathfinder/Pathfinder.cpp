@@ -4,148 +4,242 @@
 #include <algorithm>
 
 #include "GameMap.hpp"
+#include "utils/Renderer.hpp"
 
-Pathfinder::Pathfinder(GameMap& map)
+namespace {
+static const SDL_Color kClosedCellColor {96, 32, 32, 255};
+static const SDL_Color kOpenCellColor {32, 96, 96, 255};
+static const SDL_Color kStartCellColor {0, 0, 255, 255};
+static const SDL_Color kTargetCellColor {0, 255, 0, 255};
+}
+
+Pathfinder::Pathfinder(const GameMap& map, EOpenList open_list)
     : map_(map)
+    , open_list_(open_list)
+    , is_using_bucket_queue_(false)
+    , generation_(0)
     , target_index_(0)
-    , target_node_(nullptr)
+    , target_node_(kInvalidIndex)
     , did_finish_(false)
-    , target_nodes_count_(0) {
+    , expanded_nodes_count_(0)
+    , open_nodes_peak_count_(0) {
 
     Reset();
 }
 
 
-Pathfinder::Path Pathfinder::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to) {
+void Pathfinder::FindPath(Vec2<int> col_row_from, Vec2<int> col_row_to, Path& path) {
     Reset(col_row_from, col_row_to);
     while (!did_finish_) {
         Step();
     }
 
-    return ReconstructPath();
+    ReconstructPath(path);
 }
 
 void Pathfinder::Reset(Vec2<int> col_row_from, Vec2<int> col_row_to) {
     col_row_from_ = col_row_from;
     col_row_to_ = col_row_to;
-    
+
     did_finish_ = false;
-    target_node_ = nullptr;
-    
-    target_index_ = map_.FromColRowToIndex(col_row_to_);
-
-    // Map Nodes
-    open_nodes_.clear();
-    map_nodes_.clear();
-    target_nodes_count_ = 0;
+    expanded_nodes_count_ = 0;
+    open_nodes_peak_count_ = 0;
+    target_node_ = kInvalidIndex;
+    target_index_ = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_to_));
+
+    // Map Nodes are only rebuilt when the map size changes or the generation wraps around.
     const auto map_cells_count = map_.GetCellsCount();
-    map_nodes_.reserve(map_cells_count);
-    for (std::size_t i = 0; i < map_cells_count; ++i) {
-        map_nodes_.emplace_back(i);
+    if (map_nodes_.size() != map_cells_count) {
+        map_nodes_.assign(map_cells_count, MapNode{});
+        open_nodes_.Reserve(map_cells_count);
+        open_nodes_buckets_.Reserve(map_cells_count);
+        generation_ = 0;
     }
 
-    const auto node_index = map_.FromColRowToIndex(col_row_from_);
-    target_index_ = map_.FromColRowToIndex(col_row_to_);
+    open_nodes_.Clear();
+    open_nodes_buckets_.Clear();
+    is_using_bucket_queue_ = (open_list_ == EOpenList::BUCKET_QUEUE ||
+                              (open_list_ == EOpenList::AUTO && kHasUniformEdgeCosts));
+    if (++generation_ == 0) {
+        std::fill(map_nodes_.begin(), map_nodes_.end(), MapNode{});
+        generation_ = 1;
+    }
+
+    const auto node_index = static_cast<std::uint32_t>(map_.FromColRowToIndex(col_row_from_));
     auto& starting_node = map_nodes_[node_index];
+    starting_node.generation = generation_;
+    starting_node.parent = kInvalidIndex;
+    starting_node.g = 0;
     starting_node.h = Heuristic(col_row_from_, col_row_to_);
-    starting_node.is_closed = true;
 
-    open_nodes_.emplace(&starting_node);
+    PushOpen(node_index);
 }
 
 void Pathfinder::Step() {
-    if (did_finish_ || open_nodes_.empty()) {
+    if (did_finish_ || IsOpenEmpty()) {
         did_finish_ = true;
         return;
     }
 
-    auto* node = *open_nodes_.begin();
-    open_nodes_.erase(open_nodes_.begin());
-    const auto [cr, cc] = map_.FromIndexToColRow(node->map_index);
-    if (node->map_index == target_index_) {
-        target_node_ = node;
+    const auto node_index = PopOpen();
+    const auto& node = map_nodes_[node_index];
+    ++expanded_nodes_count_;
+    if (node_index == target_index_) {
+        target_node_ = node_index;
         did_finish_ = true;
         return;
     }
 
-    if (!target_node_ || node->h < target_node_->h) {
-        target_node_ = node;
+    if (target_node_ == kInvalidIndex || node.h < map_nodes_[target_node_].h) {
+        target_node_ = node_index;
     }
 
-    node->is_closed = true;
-    auto neighbours = GetNeighbours(node->map_index);
-    auto [row, col] = map_.FromIndexToColRow(node->map_index);
-    for (auto* neighbour : neighbours) {
-        const bool skip_neighbour = (!neighbour || neighbour->is_closed);
-        if (skip_neighbour) continue;
-
-        const int g_cost = node->g + 1; // (weight * heuristic) 1 in our case
-        if (!neighbour->is_open || g_cost < neighbour->g) {
-            if (neighbour->is_open) {
-                open_nodes_.erase(neighbour);
+    const auto neighbours = GetNeighbours(node_index);
+    const auto [row, col] = map_.FromIndexToColRow(node_index);
+    static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    for (std::size_t i = 0; i < neighbours.size(); ++i) {
+        const auto neighbour_index = neighbours[i];
+        if (neighbour_index == kInvalidIndex) continue;
+
+        auto& neighbour = map_nodes_[neighbour_index];
+        const bool is_visited = IsVisited(neighbour);
+        const bool is_open = (is_visited && IsOpen(neighbour_index));
+        if (is_visited && !is_open) continue;
+
+        const int g_cost = node.g + kEdgeCost;
+        if (!is_open || g_cost < neighbour.g) {
+            neighbour.generation = generation_;
+            neighbour.g = g_cost;
+            neighbour.h = Heuristic(Vec2<int>{col, row} + kNeighbourOffsets[i], col_row_to_);
+            neighbour.parent = node_index;
+
+            if (is_open) {
+                DecreaseOpen(neighbour_index);
+            } else {
+                PushOpen(neighbour_index);
             }
-            
-            neighbour->g = g_cost;
-            const auto n_col_row = map_.FromIndexToColRow(neighbour->map_index);
-            neighbour->h = Heuristic(n_col_row, col_row_to_);
-            neighbour->parent = node;
-
-            neighbour->is_open = true;
-            open_nodes_.emplace(neighbour);
         }
     }
 }
 
-Pathfinder::Neighbours Pathfinder::GetNeighbours(std::size_t node_index) {
-    Neighbours neighbours {nullptr, nullptr, nullptr, nullptr};
+Pathfinder::Neighbours Pathfinder::GetNeighbours(std::uint32_t node_index) const {
+    Neighbours neighbours {kInvalidIndex, kInvalidIndex, kInvalidIndex, kInvalidIndex};
 
     const int columns_count = static_cast<int>(map_.GetColumnsCount());
     const int index = static_cast<int>(node_index);
-
-    const int e_index = index + 1;
-    if (map_.IsWalkable(e_index) && e_index % columns_count != 0) neighbours[0] = &map_nodes_[e_index];
-    
-    const int w_index = index + -1;
-    if (map_.IsWalkable(w_index) && w_index % columns_count != columns_count - 1) neighbours[1] = &map_nodes_[w_index];
-
-    const int n_index = index - columns_count;
-    if (map_.IsWalkable(n_index) && n_index >= 0) neighbours[2] = &map_nodes_[n_index];
-
-    const int nodes_count = static_cast<int>(map_.GetCellsCount());
-    const int s_index = index + columns_count;
-    if (map_.IsWalkable(s_index) && s_index < nodes_count) neighbours[3] = &map_nodes_[s_index];
+    const auto exits = map_.GetExits(node_index);
+    if (exits & GameMap::kExitEast) neighbours[0] = index + 1;
+    if (exits & GameMap::kExitWest) neighbours[1] = index - 1;
+    if (exits & GameMap::kExitNorth) neighbours[2] = index - columns_count;
+    if (exits & GameMap::kExitSouth) neighbours[3] = index + columns_count;
 
     return neighbours;
 }
 
+bool Pathfinder::IsVisited(const MapNode& node) const {
+    return (node.generation == generation_);
+}
+
 int Pathfinder::Heuristic(Vec2<int> col_row_left, Vec2<int> col_row_right) const {
     return std::abs(col_row_left.y - col_row_right.y) + std::abs(col_row_left.x - col_row_right.x);
 }
 
-Pathfinder::Path Pathfinder::ReconstructPath() const {
-    Pathfinder::Path path;
+std::uint64_t Pathfinder::MakeOpenKey(const MapNode& node, std::uint32_t node_index) const {
+    const auto f_cost = static_cast<std::uint32_t>(node.g + node.h);
+    return (static_cast<std::uint64_t>(f_cost) << 32) | node_index;
+}
+
+bool Pathfinder::IsUsingBucketQueue() const {
+    return is_using_bucket_queue_;
+}
+
+bool Pathfinder::IsOpenEmpty() const {
+    return IsUsingBucketQueue() ? open_nodes_buckets_.Empty() : open_nodes_.Empty();
+}
+
+bool Pathfinder::IsOpen(std::uint32_t node_index) const {
+    return IsUsingBucketQueue() ? open_nodes_buckets_.Contains(node_index) : open_nodes_.Contains(node_index);
+}
+
+void Pathfinder::PushOpen(std::uint32_t node_index) {
+    const auto& node = map_nodes_[node_index];
+    if (IsUsingBucketQueue()) {
+        open_nodes_buckets_.Push(node_index, static_cast<std::uint32_t>(node.g + node.h));
+    } else {
+        open_nodes_.Push(node_index, MakeOpenKey(node, node_index));
+    }
+#if defined(PACMAN_PATHFINDER_STATS)
+    const auto open_nodes_count = IsUsingBucketQueue() ? open_nodes_buckets_.Size() : open_nodes_.Size();
+    open_nodes_peak_count_ = std::max(open_nodes_peak_count_, open_nodes_count);
+#endif
+}
 
-    MapNode* current_node = target_node_;
-    while (current_node) {
-        const auto [row, col] = map_.FromIndexToColRow(current_node->map_index);
-        path.emplace_back(col, row);
-        current_node = current_node->parent;
+void Pathfinder::DecreaseOpen(std::uint32_t node_index) {
+    const auto& node = map_nodes_[node_index];
+    if (IsUsingBucketQueue()) {
+        open_nodes_buckets_.DecreaseKey(node_index, static_cast<std::uint32_t>(node.g + node.h));
+    } else {
+        open_nodes_.DecreaseKey(node_index, MakeOpenKey(node, node_index));
     }
+}
 
-    std::reverse(path.begin(), path.end());
-    return path;
+std::uint32_t Pathfinder::PopOpen() {
+    return IsUsingBucketQueue() ? open_nodes_buckets_.Pop() : open_nodes_.Pop();
 }
 
-void Pathfinder::Render(SDL_Renderer& renderer) {
-    SDL_Rect starter_rect {col_row_from_.x * 16, col_row_from_.y * 16, 16, 16};
-    SDL_SetRenderDrawColor(&renderer, 0, 0, 255, 255);
-    SDL_RenderFillRect(&renderer, &starter_rect);
+// Every move costs kEdgeCost, so the target's g gives the path length and the
+// path is written back to front in place.
+void Pathfinder::ReconstructPath(Path& path) const {
+    path.clear();
+    if (target_node_ == kInvalidIndex) return;
+
+    path.resize(static_cast<std::size_t>(map_nodes_[target_node_].g / kEdgeCost) + 1);
+    auto position = path.size();
+    for (auto current_node = target_node_; current_node != kInvalidIndex; current_node = map_nodes_[current_node].parent) {
+        const auto [row, col] = map_.FromIndexToColRow(current_node);
+        path[--position] = Vec2<int>{col, row};
+    }
+}
 
-    SDL_Rect target_rect {col_row_to_.x * 16, col_row_to_.y * 16, 16, 16};
-    SDL_SetRenderDrawColor(&renderer, 0, 255, 0, 255);
-    SDL_RenderFillRect(&renderer, &target_rect);
+void Pathfinder::Render(Renderer& renderer) const {
+    const auto cell_size = map_.GetCellSizeFloat();
+    const auto render_cell = [&](Vec2<int> col_row, const SDL_Color& color) {
+        if (!map_.AreColRowInsideBoundaries(col_row)) return;
+        const auto position = map_.FromColRowToCoords(col_row);
+        renderer.SetRenderingColor(color);
+        renderer.RenderRectFilled({position.x, position.y, cell_size, cell_size});
+    };
+
+    for (std::size_t i = 0; i < map_nodes_.size(); ++i) {
+        if (!IsVisited(map_nodes_[i])) continue;
+        const auto [row, col] = map_.FromIndexToColRow(i);
+        render_cell(Vec2<int>{col, row}, IsOpen(static_cast<std::uint32_t>(i)) ? kOpenCellColor : kClosedCellColor);
+    }
+    render_cell(col_row_from_, kStartCellColor);
+    render_cell(col_row_to_, kTargetCellColor);
 }
 
 bool Pathfinder::DidFinish() const {
     return did_finish_;
-}
\ No newline at end of file
+}
+
+void Pathfinder::GetPath(Path& path) const {
+    ReconstructPath(path);
+}
+
+void Pathfinder::SetOpenList(EOpenList open_list) {
+    open_list_ = open_list;
+}
+
+Pathfinder::EOpenList Pathfinder::GetOpenList() const {
+    return open_list_;
+}
+
+std::size_t Pathfinder::GetExpandedNodesCount() const {
+    return expanded_nodes_count_;
+}
+
+std::size_t Pathfinder::GetOpenNodesPeakCount() const {
+    return open_nodes_peak_count_;
+}
@@ -0,0 +1,93 @@
+#include "pathfinder/PathfinderStats.hpp"
+
+#include <algorithm>
+#include <utility>
+
+void PathfinderStats::Totals::Add(const Query& query) {
+    ++queries_count;
+    expanded_nodes_count += query.expanded_nodes_count;
+    open_nodes_peak_count = std::max(open_nodes_peak_count, query.open_nodes_peak_count);
+    microseconds += query.microseconds;
+    path_cells_count += query.path_length;
+}
+
+void PathfinderStats::Totals::Add(const Totals& totals) {
+    queries_count += totals.queries_count;
+    expanded_nodes_count += totals.expanded_nodes_count;
+    open_nodes_peak_count = std::max(open_nodes_peak_count, totals.open_nodes_peak_count);
+    microseconds += totals.microseconds;
+    path_cells_count += totals.path_cells_count;
+}
+
+// Ghosts past kMaxGhostsCount still count in the totals and sources.
+std::uint32_t PathfinderStats::AddGhost(std::string name, const IncrementalPlanner* planner) {
+    ghosts_.push_back({std::move(name), planner, ESource::COUNT});
+    return static_cast<std::uint32_t>(ghosts_.size() - 1);
+}
+
+std::size_t PathfinderStats::GetGhostsCount() const {
+    return ghosts_.size();
+}
+
+const std::string& PathfinderStats::GetGhostName(std::uint32_t ghost) const {
+    return ghosts_[ghost].name;
+}
+
+const IncrementalPlanner* PathfinderStats::GetGhostPlanner(std::uint32_t ghost) const {
+    return ghosts_[ghost].planner;
+}
+
+PathfinderStats::ESource PathfinderStats::GetGhostLastSource(std::uint32_t ghost) const {
+    return ghosts_[ghost].last_source;
+}
+
+void PathfinderStats::Record(std::uint32_t ghost, ESource source, const Query& query) {
+    current_tick_.total.Add(query);
+    current_tick_.sources[static_cast<std::size_t>(source)].Add(query);
+    if (ghost < ghosts_.size()) ghosts_[ghost].last_source = source;
+    if (ghost < kMaxGhostsCount) current_tick_.ghosts[ghost].Add(query);
+}
+
+void PathfinderStats::RecordSchedulerSteps(std::size_t steps_count) {
+    current_tick_.scheduler_steps_count += steps_count;
+}
+
+void PathfinderStats::EndTick() {
+    ticks_[next_tick_] = current_tick_;
+    next_tick_ = (next_tick_ + 1) % kTicksCount;
+    ticks_count_ = std::min(ticks_count_ + 1, kTicksCount);
+    current_tick_ = Tick{};
+}
+
+const PathfinderStats::Tick& PathfinderStats::GetTick(std::size_t ticks_ago) const {
+    return ticks_[(next_tick_ + kTicksCount - 1 - ticks_ago % kTicksCount) % kTicksCount];
+}
+
+std::size_t PathfinderStats::GetTicksCount() const {
+    return ticks_count_;
+}
+
+PathfinderStats::Tick PathfinderStats::GetWindow() const {
+    Tick window;
+    for (std::size_t i = 0; i < ticks_count_; ++i) {
+        const auto& tick = GetTick(i);
+        window.total.Add(tick.total);
+        for (std::size_t ghost = 0; ghost < kMaxGhostsCount; ++ghost) window.ghosts[ghost].Add(tick.ghosts[ghost]);
+        for (std::size_t source = 0; source < window.sources.size(); ++source) window.sources[source].Add(tick.sources[source]);
+        window.scheduler_steps_count += tick.scheduler_steps_count;
+    }
+    return window;
+}
+
+const char* PathfinderStats::GetSourceName(ESource source) {
+    switch (source) {
+        case ESource::DISTANCE_FIELD: return "field";
+        case ESource::UNREACHABLE:    return "unreachable";
+        case ESource::PATH_TABLE:     return "table";
+        case ESource::PATH_CACHE:     return "cache";
+        case ESource::PLANNER:        return "planner";
+        case ESource::SCHEDULER:      return "scheduler";
+        case ESource::COUNT:          break;
+    }
+    return "none";
+}
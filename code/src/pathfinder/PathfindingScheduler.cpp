@@ -0,0 +1,159 @@
+#include "pathfinder/PathfindingScheduler.hpp"
+
+#include "GameMap.hpp"
+
+#include <algorithm>
+#include <utility>
+
+PathfindingScheduler::PathfindingScheduler(const GameMap& map, std::chrono::microseconds budget)
+    : map_(map)
+    , pathfinder_(map)
+    , budget_(budget)
+    , searching_requester_(kNoRequester)
+    , tick_(0)
+    , max_queue_depth_(0)
+    , completed_requests_count_(0)
+    , total_latency_ticks_(0)
+    , max_latency_ticks_(0)
+    , steps_count_(0) {}
+
+std::uint32_t PathfindingScheduler::AddRequester() {
+    requesters_.emplace_back();
+    return static_cast<std::uint32_t>(requesters_.size() - 1);
+}
+
+void PathfindingScheduler::Request(std::uint32_t requester, Vec2<int> col_row_from, Vec2<int> col_row_to) {
+    auto& entry = requesters_[requester];
+    if (entry.state == ERequestState::SEARCHING) {
+        if (entry.col_row_to == col_row_to && entry.map_version == map_.GetVersion()) return;
+
+        entry.col_row_from = col_row_from;
+        entry.col_row_to = col_row_to;
+        RestartSearch();
+        return;
+    }
+
+    entry.col_row_from = col_row_from;
+    entry.col_row_to = col_row_to;
+    if (entry.state == ERequestState::QUEUED) return;
+
+    entry.state = ERequestState::QUEUED;
+    entry.request_tick = tick_;
+    queue_.push_back(requester);
+    max_queue_depth_ = std::max(max_queue_depth_, GetQueueDepth());
+}
+
+// Swapped rather than moved, so both buffers keep their storage.
+void PathfindingScheduler::TakeResult(std::uint32_t requester, Pathfinder::Path& path) {
+    auto& result = requesters_[requester].result;
+    path.swap(result);
+    result.clear();
+}
+
+Vec2<int> PathfindingScheduler::GetResultTarget(std::uint32_t requester) const {
+    return requesters_[requester].result_col_row_to;
+}
+
+std::uint64_t PathfindingScheduler::GetResultMapVersion(std::uint32_t requester) const {
+    return requesters_[requester].result_map_version;
+}
+
+bool PathfindingScheduler::IsPending(std::uint32_t requester) const {
+    return (requesters_[requester].state != ERequestState::IDLE);
+}
+
+// Always steps a little, even past the budget, so requests can't starve.
+void PathfindingScheduler::Update() {
+    ++tick_;
+    steps_count_ = 0;
+
+    const auto deadline = std::chrono::steady_clock::now() + budget_;
+    do {
+        if (searching_requester_ == kNoRequester && !StartNextRequest()) break;
+        if (requesters_[searching_requester_].map_version != map_.GetVersion()) RestartSearch();
+
+        for (std::size_t i = 0; i < kStepsPerClockCheck && !pathfinder_.DidFinish(); ++i) {
+            pathfinder_.Step();
+            ++steps_count_;
+        }
+        if (pathfinder_.DidFinish()) FinishSearch();
+    } while (std::chrono::steady_clock::now() < deadline);
+}
+
+void PathfindingScheduler::Clear() {
+    for (auto& requester : requesters_) { requester = Requester{}; }
+    queue_.clear();
+    searching_requester_ = kNoRequester;
+}
+
+void PathfindingScheduler::SetBudget(std::chrono::microseconds budget) {
+    budget_ = budget;
+}
+
+std::chrono::microseconds PathfindingScheduler::GetBudget() const {
+    return budget_;
+}
+
+bool PathfindingScheduler::IsEnabled() const {
+    return (budget_.count() > 0);
+}
+
+std::size_t PathfindingScheduler::GetQueueDepth() const {
+    return queue_.size() + (searching_requester_ != kNoRequester ? 1 : 0);
+}
+
+std::size_t PathfindingScheduler::GetMaxQueueDepth() const {
+    return max_queue_depth_;
+}
+
+std::size_t PathfindingScheduler::GetCompletedRequestsCount() const {
+    return completed_requests_count_;
+}
+
+double PathfindingScheduler::GetAverageLatencyTicks() const {
+    if (completed_requests_count_ == 0) return 0.0;
+    return static_cast<double>(total_latency_ticks_) / static_cast<double>(completed_requests_count_);
+}
+
+std::uint64_t PathfindingScheduler::GetMaxLatencyTicks() const {
+    return max_latency_ticks_;
+}
+
+std::size_t PathfindingScheduler::GetStepsCount() const {
+    return steps_count_;
+}
+
+const Pathfinder& PathfindingScheduler::GetPathfinder() const {
+    return pathfinder_;
+}
+
+bool PathfindingScheduler::StartNextRequest() {
+    if (queue_.empty()) return false;
+
+    searching_requester_ = queue_.front();
+    queue_.pop_front();
+    requesters_[searching_requester_].state = ERequestState::SEARCHING;
+    RestartSearch();
+    return true;
+}
+
+// Searches the requester's current pair over the current map from scratch.
+void PathfindingScheduler::RestartSearch() {
+    auto& requester = requesters_[searching_requester_];
+    requester.map_version = map_.GetVersion();
+    pathfinder_.Reset(requester.col_row_from, requester.col_row_to);
+}
+
+void PathfindingScheduler::FinishSearch() {
+    auto& requester = requesters_[searching_requester_];
+    requester.state = ERequestState::IDLE;
+    pathfinder_.GetPath(requester.result);
+    requester.result_col_row_to = requester.col_row_to;
+    requester.result_map_version = requester.map_version;
+    searching_requester_ = kNoRequester;
+
+    const auto latency_ticks = tick_ - requester.request_tick;
+    ++completed_requests_count_;
+    total_latency_ticks_ += latency_ticks;
+    max_latency_ticks_ = std::max(max_latency_ticks_, latency_ticks);
+}
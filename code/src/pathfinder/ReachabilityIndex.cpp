@@ -0,0 +1,146 @@
+#include "pathfinder/ReachabilityIndex.hpp"
+
+#include "GameMap.hpp"
+
+#include <array>
+
+namespace {
+// Same order as the Pathfinder neighbours: east, west, north, south.
+static const std::array<Vec2<int>, 4> kNeighbourOffsets {
+    Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+static const std::uint32_t kNotVisited = std::numeric_limits<std::uint32_t>::max();
+}
+
+ReachabilityIndex::ReachabilityIndex(const GameMap& map)
+    : map_(map)
+    , version_(0)
+    , components_count_(0)
+    , snapped_targets_count_(0)
+    , unreachable_targets_count_(0) {
+    Build();
+}
+
+void ReachabilityIndex::Build() {
+    version_ = map_.GetVersion();
+    queue_.reserve(map_.GetCellsCount());
+    BuildComponents();
+    BuildNearestWalkable();
+}
+
+Vec2<int> ReachabilityIndex::GetNearestWalkable(Vec2<int> col_row) {
+    if (!map_.AreColRowInsideBoundaries(col_row)) return col_row;
+
+    Sync();
+    const auto [row, col] = map_.FromIndexToColRow(nearest_walkable_[map_.FromColRowToIndex(col_row)]);
+    return Vec2<int>{col, row};
+}
+
+std::uint32_t ReachabilityIndex::GetComponent(Vec2<int> col_row) {
+    if (!map_.AreColRowInsideBoundaries(col_row)) return kNoComponent;
+
+    Sync();
+    return components_[map_.FromColRowToIndex(col_row)];
+}
+
+std::size_t ReachabilityIndex::GetComponentsCount() {
+    Sync();
+    return components_count_;
+}
+
+bool ReachabilityIndex::ResolveTarget(Vec2<int> col_row_from, Vec2<int>& col_row_target) {
+    if (!map_.AreColRowInsideBoundaries(col_row_target)) return true;
+
+    if (!map_.AreColRowWalkable(col_row_target)) {
+        col_row_target = GetNearestWalkable(col_row_target);
+        ++snapped_targets_count_;
+    }
+
+    // A start on a wall has no component: leave it to the search.
+    const auto component_from = GetComponent(col_row_from);
+    if (component_from == kNoComponent || component_from == GetComponent(col_row_target)) return true;
+
+    ++unreachable_targets_count_;
+    return false;
+}
+
+std::size_t ReachabilityIndex::GetSnappedTargetsCount() const {
+    return snapped_targets_count_;
+}
+
+std::size_t ReachabilityIndex::GetUnreachableTargetsCount() const {
+    return unreachable_targets_count_;
+}
+
+std::size_t ReachabilityIndex::GetSavedFloodsCount() const {
+    return snapped_targets_count_ + unreachable_targets_count_;
+}
+
+void ReachabilityIndex::Sync() {
+    if (version_ == map_.GetVersion() && components_.size() == map_.GetCellsCount()) return;
+
+    Build();
+}
+
+void ReachabilityIndex::BuildComponents() {
+    const auto cells_count = map_.GetCellsCount();
+    components_.assign(cells_count, kNoComponent);
+    components_count_ = 0;
+    for (std::size_t i = 0; i < cells_count; ++i) {
+        if (components_[i] != kNoComponent || !map_.IsWalkable(i)) continue;
+
+        const auto component = static_cast<std::uint32_t>(components_count_++);
+        components_[i] = component;
+        queue_.clear();
+        queue_.push_back(static_cast<std::uint32_t>(i));
+        for (std::size_t head = 0; head < queue_.size(); ++head) {
+            const auto [row, col] = map_.FromIndexToColRow(queue_[head]);
+            for (const auto& offset : kNeighbourOffsets) {
+                const auto col_row = Vec2<int>{col, row} + offset;
+                if (!map_.AreColRowWalkable(col_row)) continue;
+
+                const auto index = map_.FromColRowToIndex(col_row);
+                if (components_[index] != kNoComponent) continue;
+
+                components_[index] = component;
+                queue_.push_back(static_cast<std::uint32_t>(index));
+            }
+        }
+    }
+}
+
+// Multi-source BFS from every walkable cell across walls and corridors alike,
+// so each wall gets the walkable cell at the smallest Manhattan distance.
+void ReachabilityIndex::BuildNearestWalkable() {
+    const auto cells_count = map_.GetCellsCount();
+    nearest_walkable_.assign(cells_count, kNotVisited);
+    queue_.clear();
+    for (std::size_t i = 0; i < cells_count; ++i) {
+        if (!map_.IsWalkable(i)) continue;
+
+        nearest_walkable_[i] = static_cast<std::uint32_t>(i);
+        queue_.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // Without any walkable cell every cell stays its own nearest one.
+    if (queue_.empty()) {
+        for (std::size_t i = 0; i < cells_count; ++i) {
+            nearest_walkable_[i] = static_cast<std::uint32_t>(i);
+        }
+        return;
+    }
+
+    for (std::size_t head = 0; head < queue_.size(); ++head) {
+        const auto index = queue_[head];
+        const auto [row, col] = map_.FromIndexToColRow(index);
+        for (const auto& offset : kNeighbourOffsets) {
+            const auto col_row = Vec2<int>{col, row} + offset;
+            if (!map_.AreColRowInsideBoundaries(col_row)) continue;
+
+            const auto neighbour = map_.FromColRowToIndex(col_row);
+            if (nearest_walkable_[neighbour] != kNotVisited) continue;
+
+            nearest_walkable_[neighbour] = nearest_walkable_[index];
+            queue_.push_back(static_cast<std::uint32_t>(neighbour));
+        }
+    }
+}
@@ -7,10 +7,60 @@
 
 #include "utils/Collisions.hpp"
 
+#include "MapAsset.hpp"
+#include "MapFile.hpp"
+
 #include <ranges>
 #include <stdexcept>
 #include <string>
 #include <algorithm>
+#include <mutex>
+
+namespace {
+// What every scene playing the map shares, for as long as one of them is alive, so
+// game instances in the same process load and build it once.
+struct SharedMap {
+    std::mutex mutex;
+    std::weak_ptr<const MapAsset> asset;
+    std::weak_ptr<const PathTable::Rows> path_table_rows;
+};
+
+SharedMap& GetSharedMap() {
+    static SharedMap shared_map;
+    return shared_map;
+}
+
+// The built-in maze when the map file can't be loaded.
+std::shared_ptr<const MapAsset> LoadMapAsset() {
+    auto& shared_map = GetSharedMap();
+    const std::lock_guard lock(shared_map.mutex);
+    if (auto asset = shared_map.asset.lock()) return asset;
+
+    MapFile map_file;
+    if (!map_file.LoadOrCompile(kAssetsFolderMaps + kMapFileName)) {
+        SDL_Log("Error loading the map %s, using the built-in one.", kMapFileName.c_str());
+        map_file.Load(MapLayout::CreateDefault());
+    }
+    auto asset = MapAsset::Create(map_file.GetView(), kCellSize, kHousesDoorColRow);
+    shared_map.asset = asset;
+    return asset;
+}
+
+std::shared_ptr<const PathTable::Rows> GetSharedPathTableRows() {
+    auto& shared_map = GetSharedMap();
+    const std::lock_guard lock(shared_map.mutex);
+    return shared_map.path_table_rows.lock();
+}
+
+// The first scene's table rows, for the scenes after it.
+void SharePathTableRows(PathTable& path_table) {
+    auto& shared_map = GetSharedMap();
+    const std::lock_guard lock(shared_map.mutex);
+    if (!shared_map.path_table_rows.expired()) return;
+
+    shared_map.path_table_rows = path_table.ShareRows();
+}
+}
 
 GameScene::GameScene(
     Renderer& renderer,
@@ -25,11 +75,20 @@ GameScene::GameScene(
     , state_(EGameState::READY_TO_PLAY)
     , map_(
         renderer_,
-        kGameWidth,
-        kGameHeight,
         Vec2{static_cast<float>(kGamePaddingX), static_cast<float>(kGamePaddingY)},
-        kCellSize)
+        LoadMapAsset())
     , pathfinder_(map_)
+    , path_cache_(map_, pathfinder_, kPathCacheCapacity)
+    , corridor_graph_(map_, path_cache_)
+    , hierarchical_pathfinder_(map_, path_cache_)
+    , path_table_(
+        map_,
+        kUseHierarchicalPathfinder ? static_cast<IPathfinder&>(hierarchical_pathfinder_) : corridor_graph_,
+        kPathTableMaxCellsCount,
+        GetSharedPathTableRows())
+    , player_distance_field_(map_)
+    , reachability_index_(map_)
+    , pathfinding_scheduler_(map_, std::chrono::microseconds{kPathfindingBudgetMicroseconds})
     , player_(renderer_, texture_manager_, map_, level_)
     , ghost_factory_(renderer_, texture_manager_, map_, pathfinder_, level_)
     , ghosts_{{
@@ -40,11 +99,16 @@ GameScene::GameScene(
     }}
     , collectable_manager_(renderer_, texture_manager_, map_)
     , collision_manager_(sound_manager_, player_, ghosts_, collectable_manager_)
-    , ui_manager_(renderer, text_manager_, texture_manager_, player_, level_) {
+    , ui_manager_(renderer, text_manager_, texture_manager_, player_, level_)
+#if defined(PACMAN_PATHFINDER_STATS)
+    , pathfinder_overlay_(renderer_, text_manager_)
+#endif
+{
     Init();
 }
 
 void GameScene::Init() {
+    SharePathTableRows(path_table_);
     background_texture_ = texture_manager_.LoadTexture(kAssetsFolderImages + "background.png");
     timer_to_start_.SetOnFinishCallback([this]() {
         sound_player_.PlayMusicPlaying();
@@ -96,6 +160,7 @@ void GameScene::StartGame() {
     did_player_win_ = false;
     player_.Reset();
     for (auto& ghost : ghosts_) { ghost->Reset(); }
+    pathfinding_scheduler_.Clear();
     
     timer_mode_frightened_.SetIntervalSeconds(level_.GetSecondsDurationGhostFrightened());
     is_timer_mode_frightened_active_ = false;
@@ -113,9 +178,15 @@ void GameScene::Update(float dt) {
     }
 
     player_.Update(dt);
+    UpdatePlayerDistanceField();
+    pathfinding_scheduler_.Update();
     for (auto& ghost : ghosts_) {
         ghost->Update(dt, this);
     }
+#if defined(PACMAN_PATHFINDER_STATS)
+    pathfinder_stats_.RecordSchedulerSteps(pathfinding_scheduler_.GetStepsCount());
+    pathfinder_stats_.EndTick();
+#endif
 
     switch(state_) {
         case EGameState::READY_TO_PLAY:  timer_to_start_.Update(dt);    break;
@@ -127,13 +198,20 @@ void GameScene::Update(float dt) {
     }
 }
 
+// Shared by every chaser. It only floods again when the player changes cell.
+void GameScene::UpdatePlayerDistanceField() {
+    const auto player_position = player_.GetCenterPosition();
+    if (!map_.AreCoordsInsideBoundaries(player_position)) return;
+
+    player_distance_field_.Update(map_.FromCoordsToColRow(player_position));
+}
+
 void GameScene::HandleStatePlaying(float dt) {
     if (is_timer_mode_frightened_active_) {
         timer_mode_frightened_.Update(dt);
     }
 
     collision_manager_.CheckCollisions(*this);
-    collectable_manager_.RemoveCollectablesMarkedForDestroy();
     if (collectable_manager_.DidCollectAll()) {
         state_ = EGameState::ON_PLAYER_WIN;
     } else if (player_.IsDead()) {
@@ -166,6 +244,11 @@ void GameScene::OnEvent(const SDL_Event& event, Game* game) {
     if (event.type != SDL_KEYDOWN) return;
 
     player_.HandleKeyPressed(event.key.keysym.scancode);
+#if defined(PACMAN_PATHFINDER_STATS)
+    if (event.key.keysym.scancode == SDL_SCANCODE_P) {
+        is_showing_pathfinder_overlay_ = !is_showing_pathfinder_overlay_;
+    }
+#endif
     
     if (!is_key_hack_able_) return;
     switch(event.key.keysym.scancode) {
@@ -187,7 +270,7 @@ void GameScene::OnEvent(const SDL_Event& event, Game* game) {
         break;
         case SDL_SCANCODE_C:
             player_.IncreaseScore(collectable_manager_.GetAllCollectableScores());
-            collectable_manager_.MarkAllForDestroy();
+            collectable_manager_.CollectAll();
             is_key_hack_able_ = false;
         break;
     }
@@ -217,12 +300,20 @@ void GameScene::OnGhostDie(Ghost& ghost) {
 void GameScene::Render() {
     renderer_.RenderTexture(background_texture_, {0, 0, 561, 659}, {kGamePaddingX - 10.f, kGamePaddingY - 10.f, 561.f, 659.f});
 
+#if defined(PACMAN_PATHFINDER_STATS)
+    if (is_showing_pathfinder_overlay_) {
+        pathfinder_overlay_.RenderCells(pathfinder_stats_, pathfinding_scheduler_.GetPathfinder());
+    }
+#endif
     collectable_manager_.Render();
     for (auto& ghost : ghosts_) {
         ghost->Render();
     }
     player_.Render();
     ui_manager_.Render(*this);
+#if defined(PACMAN_PATHFINDER_STATS)
+    if (is_showing_pathfinder_overlay_) pathfinder_overlay_.RenderStats(pathfinder_stats_);
+#endif
 }
 
 void GameScene::StartGhostFrightenedTimer() {
@@ -268,6 +359,32 @@ Pathfinder& GameScene::GetPathfinder() {
     return pathfinder_;
 }
 
+PathTable& GameScene::GetPathTable() {
+    return path_table_;
+}
+
+PathCache& GameScene::GetPathCache() {
+    return path_cache_;
+}
+
+#if defined(PACMAN_PATHFINDER_STATS)
+PathfinderStats& GameScene::GetPathfinderStats() {
+    return pathfinder_stats_;
+}
+#endif
+
+const DistanceField& GameScene::GetPlayerDistanceField() const {
+    return player_distance_field_;
+}
+
+ReachabilityIndex& GameScene::GetReachabilityIndex() {
+    return reachability_index_;
+}
+
+PathfindingScheduler& GameScene::GetPathfindingScheduler() {
+    return pathfinding_scheduler_;
+}
+
 const GameMap& GameScene::GetMap() const {
     return map_;
 }
@@ -71,24 +71,19 @@ bool EntityMovable::IsMovableDirection(EDirection direction) const {
         return false;
     }
 
-    static const Vec2<int> kHousesDoorColRow {8, 6};
-    const auto& cell = game_map_.GetCell(center_rect);
-    auto col_row = game_map_.FromCoordsToColRow(cell.center);    
-    if (kHousesDoorColRow == col_row && direction == EDirection::DOWN) {
-        return false;
-    }
-
+    const auto col_row = game_map_.FromCoordsToColRow(center_rect);
+    const auto center_cell = game_map_.FromCoordsToCenterCellCoords(center_rect);
     const auto dir_vector = GetDirectionVector(direction);       
     const auto tolerance = GetCellCenterTolerance();
     
+    // At the center the move leaves the cell, anywhere else it stays inside.
     bool did_pass_cell_center = (
-        (dir_vector.x != 0 && fabs(center_rect.x - cell.center.x) < tolerance) ||
-        (dir_vector.y != 0 && fabs(center_rect.y - cell.center.y) < tolerance));
-    if (did_pass_cell_center) {
-        col_row += dir_vector;
-    }
-
-    return game_map_.AreColRowWalkable(col_row);
+        (dir_vector.x != 0 && fabs(center_rect.x - center_cell.x) < tolerance) ||
+        (dir_vector.y != 0 && fabs(center_rect.y - center_cell.y) < tolerance));
+    const auto exits = did_pass_cell_center
+        ? game_map_.GetEntityExits(col_row)
+        : game_map_.GetEntityMoves(col_row);
+    return (exits & GetExit(direction));
 }
 
 void EntityMovable::CenterAxisX() {
@@ -125,6 +120,16 @@ Vec2<int> EntityMovable::GetDirectionVector(EDirection direction) const {
     }
 }
 
+std::uint8_t EntityMovable::GetExit(EDirection direction) const {
+    switch(direction) {
+        case EDirection::DOWN:  return GameMap::kExitSouth;
+        case EDirection::UP:    return GameMap::kExitNorth;
+        case EDirection::LEFT:  return GameMap::kExitWest;
+        case EDirection::RIGHT: return GameMap::kExitEast;
+    }
+    return 0;
+}
+
 void EntityMovable::ReverseDirection() {
     direction_ = GetOppositeDirection();
 }
@@ -144,8 +149,5 @@ void EntityMovable::SetVelocity(float velocity) {
 }
 
 bool EntityMovable::IsAtHousesDoorCell() const {
-    static const Vec2<int> kHousesDoorColRow {8, 6};
-    const auto& center_position = GetCenterPosition();
-    const auto col_row = game_map_.FromCoordsToColRow(center_position);
-    return (kHousesDoorColRow == col_row);
-}
\ No newline at end of file
+    return game_map_.IsHouseDoor(game_map_.FromCoordsToColRow(GetCenterPosition()));
+}
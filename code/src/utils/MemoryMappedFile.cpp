@@ -0,0 +1,106 @@
+#include "utils/MemoryMappedFile.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile() {
+    Close();
+}
+
+#if defined(_WIN32)
+bool MemoryMappedFile::Open(const std::string& file_path) {
+    Close();
+
+    const auto file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    const auto mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    const auto* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    file_handle_ = file_handle;
+    mapping_handle_ = mapping_handle;
+    data_ = static_cast<const std::uint8_t*>(data);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void MemoryMappedFile::Close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_handle_) CloseHandle(mapping_handle_);
+    if (file_handle_) CloseHandle(file_handle_);
+    data_ = nullptr;
+    size_ = 0;
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+}
+#else
+bool MemoryMappedFile::Open(const std::string& file_path) {
+    Close();
+
+    const int file_descriptor = open(file_path.c_str(), O_RDONLY);
+    if (file_descriptor < 0) return false;
+
+    struct stat status;
+    if (fstat(file_descriptor, &status) != 0 || status.st_size == 0) {
+        close(file_descriptor);
+        return false;
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    if (data == MAP_FAILED) {
+        close(file_descriptor);
+        return false;
+    }
+
+    file_descriptor_ = file_descriptor;
+    data_ = static_cast<const std::uint8_t*>(data);
+    size_ = size;
+    return true;
+}
+
+void MemoryMappedFile::Close() {
+    if (data_) munmap(const_cast<std::uint8_t*>(data_), size_);
+    if (file_descriptor_ >= 0) close(file_descriptor_);
+    data_ = nullptr;
+    size_ = 0;
+    file_descriptor_ = -1;
+}
+#endif
+
+bool MemoryMappedFile::IsOpen() const {
+    return data_ != nullptr;
+}
+
+const std::uint8_t* MemoryMappedFile::GetData() const {
+    return data_;
+}
+
+std::size_t MemoryMappedFile::GetSize() const {
+    return size_;
+}
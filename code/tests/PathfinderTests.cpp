@@ -0,0 +1,784 @@
+#include <SDL2/SDL.h>
+
+#include "utils/Renderer.hpp"
+#include "utils/Vec2.hpp"
+
+#include "pathfinder/Pathfinder.hpp"
+#include "pathfinder/PathTable.hpp"
+#include "pathfinder/DistanceField.hpp"
+#include "pathfinder/CorridorGraph.hpp"
+#include "pathfinder/IncrementalPlanner.hpp"
+#include "pathfinder/PathfindingScheduler.hpp"
+#include "pathfinder/PathCache.hpp"
+#include "pathfinder/ReachabilityIndex.hpp"
+#include "pathfinder/BatchPathfinder.hpp"
+#include "pathfinder/BitboardFlood.hpp"
+#include "pathfinder/HierarchicalPathfinder.hpp"
+#include "pathfinder/CompressedPathDatabase.hpp"
+
+#include "BenchmarkMaps.hpp"
+
+#include "ChunkedMap.hpp"
+#include "CollectableSpawns.hpp"
+#include "Constants.hpp"
+#include "GameMap.hpp"
+#include "MapAsset.hpp"
+#include "MapFile.hpp"
+#include "MapGeometry.hpp"
+#include "MapLayout.hpp"
+#include "MazeGenerator.hpp"
+#include "StockMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Headless correctness checks of the pathfinders and the map storage, on maps
+// small enough to run in a few seconds. Each check counts its failures: paths or
+// distances that differ from a plain A* or BFS on the same map, paths through
+// walls, maps that don't load back the same. Exits with 1 when any check fails.
+//
+// Usage: PathfinderTests [check...]
+namespace {
+static const unsigned int kSeed = 1234;
+static const std::size_t kQueriesCount = 256;
+static const std::size_t kToggledCellsCount = 64;
+static const std::size_t kJournalSyncToggledCellsCount = 8;
+static const std::size_t kReplanningGhostsCount = 4;
+static const int kReplanningTicks = 200;
+static const std::size_t kSchedulerRequestsCount = 16;
+static const std::size_t kPathCacheQueriesPoolCount = 24;
+static const std::size_t kPathCacheQueriesCount = 2048;
+static const std::size_t kPathCacheQueriesPerToggle = 256;
+static const std::size_t kFloodsCount = 16;
+static const std::size_t kSharedMapInstancesCount = 4;
+// A single step per update, so a new target always lands mid-search.
+static const std::chrono::microseconds kSchedulerBudget {1};
+
+using Query = std::pair<Vec2<int>, Vec2<int>>;
+
+std::vector<Query> GenerateQueries(const GameMap& map) {
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<Query> queries;
+    queries.reserve(kQueriesCount);
+    for (std::size_t i = 0; i < kQueriesCount; ++i) {
+        queries.emplace_back(walkable_cells[distribution(rng)], walkable_cells[distribution(rng)]);
+    }
+    return queries;
+}
+
+// Inner cells, so the map keeps its border.
+void ToggleRandomCells(GameMap& map, std::size_t count, std::mt19937& rng) {
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(map.GetColumnsCount()) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(map.GetRowsCount()) - 2);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Vec2<int> col_row {cols(rng), rows(rng)};
+        map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+    }
+}
+
+// Both are shortest paths but ties may break differently, so only lengths are compared.
+std::size_t CountMismatchingLengths(Pathfinder& pathfinder, IPathfinder& shortest_paths, const std::vector<Query>& queries) {
+    std::size_t mismatches = 0;
+    for (const auto& [from, to] : queries) {
+        if (pathfinder.FindPath(from, to).size() != shortest_paths.FindPath(from, to).size()) ++mismatches;
+    }
+    return mismatches;
+}
+
+// Paths that don't step through adjacent walkable cells from the start, or stop
+// short of a target the grid search reaches. Queries whose ends became walls
+// since are left out.
+std::size_t CountBrokenPaths(const GameMap& map, Pathfinder& pathfinder, IPathfinder& solver, const std::vector<Query>& queries) {
+    std::size_t broken_paths = 0;
+    for (const auto& [from, to] : queries) {
+        if (!map.AreColRowWalkable(from) || !map.AreColRowWalkable(to)) continue;
+
+        const auto path = solver.FindPath(from, to);
+        const bool is_reachable = (pathfinder.FindPath(from, to).back() == to);
+        bool is_broken = (path.empty() || path.front() != from || (is_reachable && path.back() != to));
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            const auto step = path[i] - path[i - 1];
+            if (std::abs(step.x) + std::abs(step.y) != 1 || !map.AreColRowWalkable(path[i])) is_broken = true;
+        }
+        if (is_broken) ++broken_paths;
+    }
+    return broken_paths;
+}
+
+// Both open lists pop in the same order, so their paths are the same cells.
+std::size_t CheckOpenLists(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    Pathfinder heap(map, Pathfinder::EOpenList::BINARY_HEAP);
+    Pathfinder buckets(map, Pathfinder::EOpenList::BUCKET_QUEUE);
+    std::size_t mismatches = 0;
+    for (const auto& [from, to] : GenerateQueries(map)) {
+        if (heap.FindPath(from, to) != buckets.FindPath(from, to)) ++mismatches;
+    }
+    return mismatches;
+}
+
+// Writing into a caller's buffer must give the path a fresh one gets.
+std::size_t CheckReusedBuffers(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    Pathfinder pathfinder(map);
+    CorridorGraph corridor_graph(map, pathfinder);
+    HierarchicalPathfinder hierarchical(map, pathfinder);
+    IncrementalPlanner planner(map, pathfinder);
+
+    std::size_t mismatches = 0;
+    IPathfinder::Path path;
+    for (IPathfinder* solver : std::initializer_list<IPathfinder*>{&pathfinder, &corridor_graph, &hierarchical, &planner}) {
+        for (const auto& [from, to] : queries) {
+            const auto returned_path = solver->FindPath(from, to);
+            solver->FindPath(from, to, path);
+            if (path != returned_path) ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+// The corridor graph and the path table against A*, then again once toggled
+// cells made both repair themselves.
+std::size_t CheckCorridorGraph(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    Pathfinder pathfinder(map);
+    CorridorGraph corridor_graph(map, pathfinder);
+    PathTable path_table(map, pathfinder, kPathTableMaxCellsCount);
+    std::size_t mismatches = CountMismatchingLengths(pathfinder, corridor_graph, queries);
+    if (path_table.IsEnabled()) mismatches += CountMismatchingLengths(pathfinder, path_table, queries);
+
+    std::mt19937 rng(kSeed);
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        ToggleRandomCells(map, 1, rng);
+        corridor_graph.FindPath(queries.front().first, queries.front().first);
+    }
+    mismatches += CountMismatchingLengths(pathfinder, corridor_graph, queries);
+    mismatches += CountBrokenPaths(map, pathfinder, corridor_graph, queries);
+    if (path_table.IsEnabled()) mismatches += CountMismatchingLengths(pathfinder, path_table, queries);
+    return mismatches;
+}
+
+// Ghosts one step per tick after a target on a random walk, each with its own
+// incremental planner, against full replans.
+std::size_t CheckIncrementalPlanner(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    std::vector<Vec2<int>> ghosts(kReplanningGhostsCount);
+    for (auto& ghost : ghosts) ghost = walkable_cells[distribution(rng)];
+    auto target = walkable_cells[distribution(rng)];
+
+    Pathfinder pathfinder(map);
+    std::vector<IncrementalPlanner> planners;
+    for (std::size_t i = 0; i < ghosts.size(); ++i) planners.emplace_back(map, pathfinder);
+
+    static const std::array<Vec2<int>, 4> kOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    std::size_t mismatches = 0;
+    Vec2<int> target_direction {0, 0};
+    for (int tick = 0; tick < kReplanningTicks; ++tick) {
+        std::vector<Vec2<int>> moves;
+        for (const auto& offset : kOffsets) {
+            if (map.AreColRowWalkable(target + offset) && offset != target_direction * -1) moves.push_back(offset);
+        }
+        if (moves.empty()) moves.push_back(target_direction * -1);
+        target_direction = moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(rng)];
+        target += target_direction;
+
+        for (std::size_t i = 0; i < ghosts.size(); ++i) {
+            const auto path = pathfinder.FindPath(ghosts[i], target);
+            if (path.size() != planners[i].FindPath(ghosts[i], target).size()) ++mismatches;
+            if (path.size() > 1) ghosts[i] = path[1];
+        }
+    }
+    return mismatches;
+}
+
+// Random cells, walls included, snapped to a walkable cell at the brute-force
+// Manhattan distance, and targets resolved only when A* reaches them, before and
+// after toggled cells made the index rebuild.
+std::size_t CheckReachabilityIndex(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    Pathfinder pathfinder(map);
+    ReachabilityIndex reachability_index(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(0, static_cast<int>(map.GetColumnsCount()) - 1);
+    std::uniform_int_distribution<int> rows(0, static_cast<int>(map.GetRowsCount()) - 1);
+
+    std::size_t failures = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        const auto walkable_cells = GetWalkableCells(map);
+        std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+        for (std::size_t i = 0; i < kQueriesCount; ++i) {
+            const Vec2<int> col_row {cols(rng), rows(rng)};
+            int nearest_distance = std::numeric_limits<int>::max();
+            for (const auto& walkable_cell : walkable_cells) {
+                nearest_distance = std::min(nearest_distance, std::abs(walkable_cell.x - col_row.x) + std::abs(walkable_cell.y - col_row.y));
+            }
+            const auto nearest = reachability_index.GetNearestWalkable(col_row);
+            failures += (!map.AreColRowWalkable(nearest) ||
+                         std::abs(nearest.x - col_row.x) + std::abs(nearest.y - col_row.y) != nearest_distance);
+
+            const auto from = walkable_cells[distribution(rng)];
+            auto target = col_row;
+            const bool is_resolved = reachability_index.ResolveTarget(from, target);
+            failures += (target != nearest || is_resolved != (pathfinder.FindPath(from, target).back() == target));
+        }
+        ToggleRandomCells(map, kToggledCellsCount, rng);
+    }
+    return failures;
+}
+
+// Retargeting a requester mid-search, or changing the map under it, must start the
+// search over: the result has to be for the last target on the current map. Only
+// moving the start keeps the search, so the result still starts where the first
+// request did, and a ghost that moved off it has to drop it.
+std::size_t CheckScheduler(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+    auto random_cell = [&]() { return walkable_cells[distribution(rng)]; };
+
+    Pathfinder pathfinder(map);
+    PathfindingScheduler scheduler(map, kSchedulerBudget);
+    const auto requester = scheduler.AddRequester();
+    std::size_t stale_results = 0;
+    Pathfinder::Path path;
+    for (std::size_t i = 0; i < kSchedulerRequestsCount; ++i) {
+        const auto from = random_cell();
+        const auto to = random_cell();
+        scheduler.Request(requester, from, random_cell());
+        scheduler.Update();
+        scheduler.Request(requester, from, to);
+        if (i % 2 == 1) {
+            const auto col_row = random_cell();
+            map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+        }
+        while (scheduler.IsPending(requester)) scheduler.Update();
+        scheduler.TakeResult(requester, path);
+        if (scheduler.GetResultTarget(requester) != to || scheduler.GetResultMapVersion(requester) != map.GetVersion() ||
+            path != pathfinder.FindPath(from, to)) {
+            ++stale_results;
+        }
+    }
+
+    for (std::size_t i = 0; i < kSchedulerRequestsCount; ++i) {
+        const auto from = random_cell();
+        const auto to = random_cell();
+        scheduler.Request(requester, from, to);
+        scheduler.Update();
+        const bool is_searching = scheduler.IsPending(requester);
+        const auto moved_from = random_cell();
+        scheduler.Request(requester, moved_from, to);
+        while (scheduler.IsPending(requester)) scheduler.Update();
+        scheduler.TakeResult(requester, path);
+        if (scheduler.GetResultTarget(requester) != to || path != pathfinder.FindPath(is_searching ? from : moved_from, to)) {
+            ++stale_results;
+        }
+    }
+    return stale_results;
+}
+
+// Cached paths against A* while cells toggle, from a pool of queries a little
+// larger than the cache so entries get reused and evicted. Then the LRU order on
+// a cache of two.
+std::size_t CheckPathCache(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    auto queries = GenerateQueries(map);
+    queries.resize(kPathCacheQueriesPoolCount);
+    Pathfinder pathfinder(map);
+    Pathfinder cached_pathfinder(map);
+
+    std::size_t failures = 0;
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, queries.size() - 1);
+    for (const std::size_t capacity : {0, 4, 16}) {
+        PathCache path_cache(map, cached_pathfinder, capacity);
+        IPathfinder::Path path;
+        for (std::size_t i = 0; i < kPathCacheQueriesCount; ++i) {
+            if (i % kPathCacheQueriesPerToggle == kPathCacheQueriesPerToggle - 1) {
+                ToggleRandomCells(map, 1, rng);
+                const auto& [from, to] = queries[distribution(rng)];
+                path_cache.FindPath(from, to, path);
+                failures += (path_cache.GetSize() != std::min<std::size_t>(capacity, 1));
+            }
+
+            const auto& [from, to] = queries[distribution(rng)];
+            path_cache.FindPath(from, to, path);
+            failures += (path != pathfinder.FindPath(from, to));
+            failures += (path_cache.GetSize() > path_cache.GetCapacity());
+        }
+        failures += (capacity == 0) ? (path_cache.GetHitsCount() != 0) : (path_cache.GetHitsCount() == 0);
+        failures += (capacity == 0) ? (path_cache.GetEvictionsCount() != 0) : (path_cache.GetEvictionsCount() == 0);
+    }
+
+    // The least recently used of a full cache goes first, whatever order it was inserted in.
+    PathCache path_cache(map, cached_pathfinder, 2);
+    const auto& [a, b] = queries[0];
+    const auto& [c, d] = queries[1];
+    const auto& [e, f] = queries[2];
+    IPathfinder::Path path;
+    path_cache.FindPath(a, b, path);
+    path_cache.FindPath(c, d, path);
+    path_cache.FindPath(a, b, path);
+    path_cache.FindPath(e, f, path);
+    failures += !path_cache.Lookup(a, b, path);
+    failures += path_cache.Lookup(c, d, path);
+    failures += !path_cache.Lookup(e, f, path);
+    failures += (path_cache.GetEvictionsCount() != 1);
+    return failures;
+}
+
+// The paths have to match the sequential ones exactly, whatever the workers count.
+std::size_t CheckBatch(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    std::vector<BatchPathfinder::Query> queries;
+    for (const auto& [from, to] : GenerateQueries(map)) queries.push_back({from, to});
+
+    Pathfinder pathfinder(map);
+    std::vector<IPathfinder::Path> expected_paths;
+    for (const auto& [from, to] : queries) expected_paths.push_back(pathfinder.FindPath(from, to));
+
+    std::size_t mismatches = 0;
+    for (const std::size_t workers_count : {1, 2, 4}) {
+        BatchPathfinder batch_pathfinder(map, workers_count);
+        std::vector<IPathfinder::Path> paths;
+        batch_pathfinder.FindPaths(queries, paths);
+        mismatches += (paths.size() != expected_paths.size());
+        for (std::size_t i = 0; i < std::min(paths.size(), expected_paths.size()); ++i) {
+            if (paths[i] != expected_paths[i]) ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+// Bitboard floods, alone and behind a distance field, against the queue BFS.
+std::size_t CheckFlood(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto walkable_cells = GetWalkableCells(map);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<std::size_t> distribution(0, walkable_cells.size() - 1);
+
+    DistanceField scalar_field(map, DistanceField::EFlood::SCALAR);
+    DistanceField bitboard_field(map, DistanceField::EFlood::BITBOARD);
+    BitboardFlood bitboard_flood(map);
+    std::vector<std::uint32_t> distances;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < kFloodsCount; ++i) {
+        const auto target = walkable_cells[distribution(rng)];
+        scalar_field.Update(target);
+        bitboard_field.Update(target);
+        bitboard_flood.Flood(target, distances);
+        for (std::size_t cell = 0; cell < map.GetCellsCount(); ++cell) {
+            const auto [row, col] = map.FromIndexToColRow(cell);
+            const Vec2<int> col_row {col, row};
+            if (distances[cell] != scalar_field.GetDistance(col_row) ||
+                bitboard_field.GetDistance(col_row) != scalar_field.GetDistance(col_row)) {
+                ++mismatches;
+            }
+        }
+    }
+    return mismatches;
+}
+
+// Whole HPA* paths must step through walkable cells, before and after toggled
+// cells repaired its clusters, and the repairs must match a full build.
+std::size_t CheckHierarchical(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    Pathfinder pathfinder(map);
+    HierarchicalPathfinder hierarchical(map, pathfinder);
+    hierarchical.SetRefinedSegmentsCount(0);
+    std::size_t failures = CountBrokenPaths(map, pathfinder, hierarchical, queries);
+
+    std::mt19937 rng(kSeed);
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        ToggleRandomCells(map, 1, rng);
+        hierarchical.FindPath(queries.front().first, queries.front().first);
+    }
+
+    HierarchicalPathfinder rebuilt(map, pathfinder);
+    rebuilt.SetRefinedSegmentsCount(0);
+    for (const auto& [from, to] : queries) {
+        if (hierarchical.FindPath(from, to).size() != rebuilt.FindPath(from, to).size()) ++failures;
+    }
+    return failures + CountBrokenPaths(map, pathfinder, hierarchical, queries);
+}
+
+// The journal gives the cells a walkability snapshot diff finds, then refuses
+// versions it no longer covers.
+std::size_t CheckMapJournal(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    std::vector<std::uint8_t> walkable_snapshot(map.GetCellsCount());
+    for (std::size_t i = 0; i < walkable_snapshot.size(); ++i) walkable_snapshot[i] = map.IsWalkable(i);
+
+    std::mt19937 rng(kSeed);
+    std::vector<std::uint32_t> changed_cells;
+    std::vector<std::uint32_t> snapshot_cells;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        const auto version = map.GetVersion();
+        ToggleRandomCells(map, 1 + i % 3, rng);
+        mismatches += !map.GetChangesSince(version, changed_cells);
+
+        snapshot_cells.clear();
+        for (std::size_t cell = 0; cell < walkable_snapshot.size(); ++cell) {
+            const std::uint8_t is_walkable = map.IsWalkable(cell);
+            if (walkable_snapshot[cell] == is_walkable) continue;
+
+            walkable_snapshot[cell] = is_walkable;
+            snapshot_cells.push_back(static_cast<std::uint32_t>(cell));
+        }
+        mismatches += (changed_cells != snapshot_cells);
+    }
+
+    const auto version = map.GetVersion();
+    ToggleRandomCells(map, GameMap::kJournalCapacity + 1, rng);
+    mismatches += map.GetChangesSince(version, changed_cells);
+    mismatches += !map.GetChangesSince(map.GetVersion() - GameMap::kJournalCapacity, changed_cells);
+    return mismatches;
+}
+
+// Derived data repaired from the journal, several toggles per sync and half of
+// them on the HPA* cluster borders, must still step through walkable cells only.
+std::size_t CheckJournalRepairs(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    Pathfinder pathfinder(map);
+    CorridorGraph corridor_graph(map, pathfinder);
+    HierarchicalPathfinder hierarchical(map, pathfinder);
+    hierarchical.SetRefinedSegmentsCount(0);
+    corridor_graph.FindPath(queries.front().first, queries.front().first);
+    hierarchical.FindPath(queries.front().first, queries.front().first);
+
+    const auto cluster_size = static_cast<int>(HierarchicalPathfinder::kDefaultClusterSize);
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(0, static_cast<int>(map.GetColumnsCount()) - 1);
+    std::uniform_int_distribution<int> rows(0, static_cast<int>(map.GetRowsCount()) - 1);
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        for (std::size_t j = 0; j < kJournalSyncToggledCellsCount; ++j) {
+            Vec2<int> col_row {cols(rng), rows(rng)};
+            if (j % 4 == 1) col_row.x -= col_row.x % cluster_size;
+            if (j % 4 == 3) col_row.y -= col_row.y % cluster_size;
+            map.SetIsWalkable(col_row, !map.AreColRowWalkable(col_row));
+        }
+        corridor_graph.FindPath(queries.front().first, queries.front().first);
+        hierarchical.FindPath(queries.front().first, queries.front().first);
+    }
+    return CountBrokenPaths(map, pathfinder, corridor_graph, queries) + CountBrokenPaths(map, pathfinder, hierarchical, queries);
+}
+
+// Whole paths from the mapped database file have the A* lengths, and every first
+// move starts a shortest path.
+std::size_t CheckPathDatabase(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto queries = GenerateQueries(map);
+    const auto file_path = (std::filesystem::temp_directory_path() /
+        ("pathfinder-tests-" + std::to_string(map.GetColumnsCount()) + ".cpd")).string();
+
+    Pathfinder pathfinder(map);
+    CompressedPathDatabase database(map, pathfinder);
+    database.Build();
+    std::size_t failures = !database.Save(file_path);
+    failures += !database.Load(file_path);
+
+    static const std::array<Vec2<int>, 4> kMoveOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    for (const auto& [from, to] : queries) {
+        const auto path = pathfinder.FindPath(from, to);
+        if (database.FindPath(from, to).size() != path.size()) ++failures;
+        if (path.size() < 2) continue;
+
+        const auto move = database.GetFirstMove(from, to);
+        if (move == CompressedPathDatabase::EMove::NONE ||
+            pathfinder.FindPath(from + kMoveOffsets[static_cast<std::size_t>(move)], to).size() + 1 != path.size()) {
+            ++failures;
+        }
+    }
+
+    // A run past the last position, in a file of the right size, must not load.
+    {
+        std::fstream file(file_path, std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint32_t corrupt_run = 0xFFFFFFFF;
+        file.seekp(-static_cast<std::streamoff>(sizeof(corrupt_run)), std::ios::end);
+        file.write(reinterpret_cast<const char*>(&corrupt_run), sizeof(corrupt_run));
+    }
+    failures += database.Load(file_path);
+    std::filesystem::remove(file_path);
+    return failures;
+}
+
+// The text and the compiled map files load back the layout they were saved from.
+std::size_t CheckMapFile(Renderer& /*renderer*/, const MapLayout& layout) {
+    const auto text_file_path = (std::filesystem::temp_directory_path() /
+        ("pathfinder-tests-" + std::to_string(layout.cols_count) + ".map")).string();
+    const auto binary_file_path = MapFile::GetBinaryFilePath(text_file_path);
+    std::size_t failures = !MapFile::SaveText(layout, text_file_path);
+    failures += !MapFile::SaveBinary(layout, binary_file_path);
+
+    MapFile map_file;
+    for (const auto& file_path : {text_file_path, binary_file_path}) {
+        if (!map_file.Load(file_path)) {
+            ++failures;
+            continue;
+        }
+
+        const auto view = map_file.GetView();
+        failures += !(view.cols_count == layout.cols_count && view.rows_count == layout.rows_count &&
+                      std::equal(view.tiles.begin(), view.tiles.end(), layout.tiles.begin(), layout.tiles.end()) &&
+                      std::equal(view.collectables.begin(), view.collectables.end(), layout.collectables.begin(), layout.collectables.end()));
+    }
+    std::filesystem::remove(text_file_path);
+    std::filesystem::remove(binary_file_path);
+    return failures;
+}
+
+// The walkability bitset and the exits against the tiles, cell by cell.
+std::size_t CheckMapStorage(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    static const std::array<Vec2<int>, 4> kOffsets {
+        Vec2<int>{1, 0}, Vec2<int>{-1, 0}, Vec2<int>{0, -1}, Vec2<int>{0, 1}};
+    const auto is_floor = [&layout](Vec2<int> col_row) {
+        return col_row.x >= 0 && col_row.y >= 0 &&
+               static_cast<std::size_t>(col_row.x) < layout.cols_count && static_cast<std::size_t>(col_row.y) < layout.rows_count &&
+               layout.tiles[static_cast<std::size_t>(col_row.y) * layout.cols_count + static_cast<std::size_t>(col_row.x)] == 0;
+    };
+
+    std::size_t mismatches = 0;
+    for (std::size_t index = 0; index < map.GetCellsCount(); ++index) {
+        const auto [row, col] = map.FromIndexToColRow(index);
+        const Vec2<int> col_row {col, row};
+        mismatches += (map.AreColRowWalkable(col_row) != is_floor(col_row));
+
+        std::uint8_t exits = 0;
+        for (std::size_t i = 0; i < kOffsets.size(); ++i) {
+            if (is_floor(col_row) && is_floor(col_row + kOffsets[i])) exits |= static_cast<std::uint8_t>(1 << i);
+        }
+        mismatches += (map.GetExits(index) != exits);
+    }
+    return mismatches;
+}
+
+// The runtime geometry against division, and on the stock maze the compile-time
+// geometry and tables against the GameMap.
+std::size_t CheckMapGeometry(Renderer& renderer, const MapLayout& layout) {
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    const auto& geometry = map.GetGeometry();
+    const auto cols_count = map.GetColumnsCount();
+    const bool is_stock_map = (map.GetColumnsCount() == kColsCount && map.GetRowsCount() == kRowsCount);
+    std::size_t mismatches = 0;
+    for (std::size_t index = 0; index < map.GetCellsCount(); ++index) {
+        const Vec2<int> row_col {static_cast<int>(index / cols_count), static_cast<int>(index % cols_count)};
+        const Vec2<int> pixels {row_col.y * kCellSizeInt + kCellSizeInt / 2, row_col.x * kCellSizeInt + kCellSizeInt / 2};
+        mismatches += (geometry.FromIndexToColRow(index) != row_col);
+        mismatches += (geometry.FromPixelsToColRow(pixels) != Vec2{row_col.y, row_col.x});
+        if (!is_stock_map) continue;
+
+        mismatches += (StockMapGeometry::FromIndexToColRow(index) != row_col);
+        mismatches += (StockMapGeometry::FromPixelsToColRow(pixels) != Vec2{row_col.y, row_col.x});
+        mismatches += (map.GetExits(index) != kStockMapExits[index]);
+        mismatches += (map.GetCell(index).center != kStockMapCellCenters[index]);
+    }
+    if (!is_stock_map) return mismatches;
+
+    std::vector<CollectableSpawn> spawns;
+    ForEachCollectableSpawn(geometry, layout.collectables, [&spawns](const CollectableSpawn& spawn) { spawns.push_back(spawn); });
+    mismatches += !std::equal(spawns.begin(), spawns.end(), kStockMapCollectableSpawns.begin(), kStockMapCollectableSpawns.end(),
+        [](const CollectableSpawn& a, const CollectableSpawn& b) { return a.center == b.center && a.type == b.type; });
+    return mismatches;
+}
+
+// Generated mazes mirror around the middle of the map but for a spare column, and
+// every walkable cell is reachable from the house door.
+std::size_t CheckMazeGenerator(Renderer& renderer, const MapLayout& layout) {
+    const auto cols_count = layout.cols_count;
+    const auto rows_count = layout.rows_count;
+    const auto maze = MazeGenerator(cols_count, rows_count, kSeed).Generate();
+    GameMap map(renderer, Vec2{0.f, 0.f}, kCellSize, maze.layout);
+    map.SetHouseDoor(maze.house_door_col_row);
+
+    std::size_t failures = 0;
+    for (std::size_t row = 0; row < rows_count; ++row) {
+        const auto* tiles = &maze.layout.tiles[row * cols_count];
+        const auto last_col = (cols_count % 2 == 0) ? cols_count - 2 : cols_count - 1;
+        failures += !std::equal(tiles, tiles + last_col + 1, std::reverse_iterator(tiles + last_col + 1));
+    }
+
+    DistanceField distance_field(map);
+    distance_field.Update(maze.house_door_col_row);
+    const auto walkable_cells = GetWalkableCells(map);
+    failures += static_cast<std::size_t>(std::count_if(walkable_cells.begin(), walkable_cells.end(),
+        [&distance_field](Vec2<int> col_row) { return !distance_field.IsReachable(col_row); }));
+    return failures;
+}
+
+// A chunked map against the dense one of the same layout, cell by cell and with
+// A* over both, before and after toggling cells in and out of resident chunks.
+std::size_t CheckChunkedMap(Renderer& renderer, const MapLayout& layout) {
+    const auto file_path = (std::filesystem::temp_directory_path() /
+        ("pathfinder-tests-" + std::to_string(layout.cols_count) + ".pchunks")).string();
+    GameMap dense_map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    GameMap chunked_map(renderer, Vec2{0.f, 0.f}, kCellSize, layout);
+    if (!ChunkedMap::Save(layout, file_path) || !chunked_map.InitChunked(file_path)) return 1;
+
+    std::size_t mismatches = 0;
+    const auto compare = [&]() {
+        for (std::size_t index = 0; index < dense_map.GetCellsCount(); ++index) {
+            const auto [row, col] = dense_map.FromIndexToColRow(index);
+            mismatches += (dense_map.GetExits(index) != chunked_map.GetExits(index));
+            mismatches += (dense_map.GetEntityMoves(Vec2{col, row}) != chunked_map.GetEntityMoves(Vec2{col, row}));
+        }
+    };
+    compare();
+
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<int> cols(1, static_cast<int>(layout.cols_count) - 2);
+    std::uniform_int_distribution<int> rows(1, static_cast<int>(layout.rows_count) - 2);
+    for (std::size_t i = 0; i < kToggledCellsCount; ++i) {
+        const Vec2<int> entity {cols(rng), rows(rng)};
+        chunked_map.UpdateResidency(std::span(&entity, 1));
+        // Half of the cells next to the resident entity, half anywhere.
+        const auto col_row = (i % 2 == 0) ? entity : Vec2{cols(rng), rows(rng)};
+        const bool is_walkable = !dense_map.AreColRowWalkable(col_row);
+        dense_map.SetIsWalkable(col_row, is_walkable);
+        chunked_map.SetIsWalkable(col_row, is_walkable);
+    }
+    chunked_map.UpdateResidency({});
+    compare();
+
+    Pathfinder dense_pathfinder(dense_map);
+    Pathfinder chunked_pathfinder(chunked_map);
+    for (const auto& [from, to] : GenerateQueries(dense_map)) {
+        if (dense_pathfinder.FindPath(from, to) != chunked_pathfinder.FindPath(from, to)) ++mismatches;
+    }
+    std::filesystem::remove(file_path);
+    return mismatches;
+}
+
+// Game instances sharing one asset and one path table: toggles on one of them
+// must leave the others alone, and its own table must follow them.
+std::size_t CheckSharedMap(Renderer& renderer, const MapLayout& layout) {
+    struct MapInstance {
+        GameMap map;
+        Pathfinder pathfinder;
+        CorridorGraph corridor_graph;
+        PathTable path_table;
+
+        MapInstance(Renderer& renderer, std::shared_ptr<const MapAsset> asset, std::shared_ptr<const PathTable::Rows> rows)
+            : map(renderer, Vec2{0.f, 0.f}, std::move(asset))
+            , pathfinder(map)
+            , corridor_graph(map, pathfinder)
+            , path_table(map, corridor_graph, kPathTableMaxCellsCount, std::move(rows)) {}
+    };
+
+    const auto asset = MapAsset::Create(layout, kCellSize);
+    std::vector<std::unique_ptr<MapInstance>> instances;
+    std::shared_ptr<const PathTable::Rows> rows;
+    for (std::size_t i = 0; i < kSharedMapInstancesCount; ++i) {
+        instances.push_back(std::make_unique<MapInstance>(renderer, asset, rows));
+        if (!rows) rows = instances.back()->path_table.ShareRows();
+    }
+
+    auto& changed = *instances.front();
+    const auto queries = GenerateQueries(changed.map);
+    std::mt19937 rng(kSeed);
+    ToggleRandomCells(changed.map, kToggledCellsCount, rng);
+    std::size_t mismatches = CountMismatchingLengths(changed.pathfinder, changed.path_table, queries);
+
+    const auto exits = asset->GetExitsAndMoves();
+    for (std::size_t i = 1; i < instances.size(); ++i) {
+        auto& untouched = *instances[i];
+        for (std::size_t index = 0; index < exits.size(); ++index) {
+            mismatches += (untouched.map.GetExits(index) != (exits[index] & GameMap::kExitsAll));
+        }
+        mismatches += CountMismatchingLengths(untouched.pathfinder, untouched.path_table, queries);
+    }
+    return mismatches;
+}
+
+struct Check {
+    const char* name;
+    std::size_t (*run)(Renderer& renderer, const MapLayout& layout);
+};
+
+static const std::array<Check, 19> kChecks {{
+    {"open-lists", CheckOpenLists},
+    {"reused-buffers", CheckReusedBuffers},
+    {"corridor-graph", CheckCorridorGraph},
+    {"incremental-planner", CheckIncrementalPlanner},
+    {"reachability-index", CheckReachabilityIndex},
+    {"scheduler", CheckScheduler},
+    {"path-cache", CheckPathCache},
+    {"batch", CheckBatch},
+    {"flood", CheckFlood},
+    {"hierarchical", CheckHierarchical},
+    {"map-journal", CheckMapJournal},
+    {"journal-repairs", CheckJournalRepairs},
+    {"path-database", CheckPathDatabase},
+    {"map-file", CheckMapFile},
+    {"map-storage", CheckMapStorage},
+    {"map-geometry", CheckMapGeometry},
+    {"maze-generator", CheckMazeGenerator},
+    {"chunked-map", CheckChunkedMap},
+    {"shared-map", CheckSharedMap}}};
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const bool is_check = std::any_of(kChecks.begin(), kChecks.end(),
+            [name = argv[i]](const Check& check) { return std::strcmp(check.name, name) == 0; });
+        if (!is_check) {
+            std::fprintf(stderr, "Usage: %s [check...]\nChecks:", argv[0]);
+            for (const auto& check : kChecks) std::fprintf(stderr, " %s", check.name);
+            std::fprintf(stderr, "\n");
+            return 1;
+        }
+    }
+
+    HeadlessRenderer headless_renderer;
+    if (!headless_renderer.IsValid()) {
+        std::fprintf(stderr, "Error creating the software renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // The stock maze, a generated maze with loops and an open field, which has
+    // the most HPA* entrances and corridor graph junctions.
+    const std::array<MapLayout, 3> layouts {
+        MapLayout::CreateDefault(), GenerateMaze(128, kSeed), GenerateRandomWalls(64, kSeed, 0.0f)};
+    std::size_t failed_checks_count = 0;
+    for (const auto& check : kChecks) {
+        const bool is_selected = (argc == 1) || std::any_of(argv + 1, argv + argc,
+            [&check](const char* name) { return std::strcmp(check.name, name) == 0; });
+        if (!is_selected) continue;
+
+        for (const auto& layout : layouts) {
+            const auto failures = check.run(headless_renderer.Get(), layout);
+            std::printf("%-20s %5zux%-5zu %s\n", check.name, layout.cols_count, layout.rows_count,
+                failures ? "FAILED" : "ok");
+            if (failures) {
+                std::printf("  %zu failures\n", failures);
+                ++failed_checks_count;
+            }
+        }
+    }
+    return failed_checks_count ? 1 : 0;
+}